@@ -0,0 +1,107 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file ContentCache.cpp
+ * Contains the implementation of a cache of the signatures matched by file
+ * content, kept in an SQLite database of its own and shared across cases.
+ */
+
+#include "ContentCache.h"
+
+// TSK Framework includes, including the SQLite API.
+#include "TskModuleDev.h"
+#include "framework.h"
+
+namespace
+{
+    const char *CREATE_TABLE_STATEMENT = "CREATE TABLE IF NOT EXISTS content_matches "
+        "(content_hash TEXT, signature_table_key TEXT, matches BLOB, PRIMARY KEY (content_hash, signature_table_key))";
+    const char *SELECT_STATEMENT = "SELECT matches FROM content_matches WHERE content_hash = ? AND signature_table_key = ?";
+    const char *INSERT_STATEMENT = "INSERT OR REPLACE INTO content_matches (content_hash, signature_table_key, matches) VALUES (?, ?, ?)";
+
+    void bindText(SqliteStatement &statement, int parameter, const std::string &text)
+    {
+        sqlite3_bind_text(statement.get(), parameter, text.c_str(), static_cast<int>(text.size()), SQLITE_TRANSIENT);
+    }
+}
+
+ContentCache::ContentCache(const std::string &path, const std::string &signatureTableKey) : 
+    m_connection(path, false, true), m_signatureTableKey(signatureTableKey), m_foundCount(0), m_addedCount(0)
+{
+    m_connection.execute(CREATE_TABLE_STATEMENT);
+    m_selectStatement.reset(new SqliteStatement(m_connection, SELECT_STATEMENT));
+}
+
+bool ContentCache::find(const std::string &contentHash, size_t signatureCount, std::vector<bool> &signatureMatches)
+{
+    // The matches are stored as a bitmap of the signatures, a byte for each eight signatures.
+    bindText(*m_selectStatement, 1, contentHash);
+    bindText(*m_selectStatement, 2, m_signatureTableKey);
+    bool isFound = false;
+    if (m_selectStatement->step())
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(sqlite3_column_blob(m_selectStatement->get(), 0));
+        const size_t length = static_cast<size_t>(sqlite3_column_bytes(m_selectStatement->get(), 0));
+        isFound = length == (signatureCount + 7) / 8;
+        signatureMatches.assign(signatureCount, false);
+        for (size_t i = 0; i < signatureCount && isFound; ++i)
+        {
+            signatureMatches[i] = (bytes[i / 8] & (1 << (i % 8))) != 0;
+        }
+    }
+    sqlite3_reset(m_selectStatement->get());
+
+    m_foundCount += isFound ? 1 : 0;
+    return isFound;
+}
+
+void ContentCache::add(const std::string &contentHash, const std::vector<bool> &signatureMatches)
+{
+    std::string bytes((signatureMatches.size() + 7) / 8, '\0');
+    for (size_t i = 0; i < signatureMatches.size(); ++i)
+    {
+        if (signatureMatches[i])
+        {
+            bytes[i / 8] = static_cast<char>(bytes[i / 8] | (1 << (i % 8)));
+        }
+    }
+    m_addedMatches.push_back(std::make_pair(contentHash, bytes));
+}
+
+void ContentCache::flush()
+{
+    if (m_addedMatches.empty())
+    {
+        return;
+    }
+
+    m_connection.execute("BEGIN IMMEDIATE");
+    try
+    {
+        SqliteStatement insertStatement(m_connection, INSERT_STATEMENT);
+        for (std::vector<std::pair<std::string, std::string> >::const_iterator matches = m_addedMatches.begin(); matches != m_addedMatches.end(); ++matches)
+        {
+            bindText(insertStatement, 1, matches->first);
+            bindText(insertStatement, 2, m_signatureTableKey);
+            sqlite3_bind_blob(insertStatement.get(), 3, matches->second.data(), static_cast<int>(matches->second.size()), SQLITE_TRANSIENT);
+            insertStatement.execute();
+        }
+        m_connection.execute("COMMIT");
+    }
+    catch (...)
+    {
+        sqlite3_exec(m_connection.get(), "ROLLBACK", NULL, NULL, NULL);
+        m_addedMatches.clear();
+        throw;
+    }
+
+    m_addedCount += m_addedMatches.size();
+    m_addedMatches.clear();
+}
@@ -0,0 +1,93 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file ContentCache.h
+ * Contains the interface of a cache of the signatures matched by file
+ * content, kept in an SQLite database of its own and shared across cases.
+ */
+
+#ifndef _CONTENT_CACHE_H
+#define _CONTENT_CACHE_H
+
+#include "SqliteDatabase.h"
+
+// System includes
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdint.h>
+
+/**
+ * A content cache remembers which signatures of a signature table the 
+ * header of a file's content matched, keyed by the hash of the content, so
+ * that a file with the same content in a later search, or a later case, 
+ * need not be read again. The same system files appear in many images, so
+ * a cache kept across cases spares most of their reads.
+ *
+ * Matches are also keyed by the signature table they were found with, so 
+ * matches found with one configuration are never reused with another. New
+ * matches are held in memory until they are written in a single 
+ * transaction by flush().
+ */
+class ContentCache
+{
+public:
+    /**
+     * Opens the cache database, creating it and its table if they do not 
+     * exist.
+     *
+     * @param path The path of the cache database.
+     * @param signatureTableKey The key of the signature table whose 
+     * matches are looked up and added.
+     * @throws TskException If the database cannot be opened or created.
+     */
+    ContentCache(const std::string &path, const std::string &signatureTableKey);
+
+    /**
+     * Finds the signatures matched by a file's content.
+     *
+     * @param contentHash The hash of the content, prefixed by the name of 
+     * the hash algorithm.
+     * @param signatureCount The number of signatures in the table.
+     * @param signatureMatches Receives whether each signature matched.
+     * @return False if the content is not in the cache.
+     * @throws TskException If the cache cannot be read.
+     */
+    bool find(const std::string &contentHash, size_t signatureCount, std::vector<bool> &signatureMatches);
+
+    /**
+     * Adds the signatures matched by a file's content to the cache. 
+     */
+    void add(const std::string &contentHash, const std::vector<bool> &signatureMatches);
+
+    /**
+     * Writes the added matches to the cache database.
+     *
+     * @throws TskException If the matches cannot be written, in which case
+     * none of them are.
+     */
+    void flush();
+
+    uint64_t getFoundCount() const { return m_foundCount; }
+    uint64_t getAddedCount() const { return m_addedCount; }
+
+private:
+    ContentCache(const ContentCache &);
+    ContentCache &operator=(const ContentCache &);
+
+    SqliteConnection m_connection;
+    std::auto_ptr<SqliteStatement> m_selectStatement;
+    std::string m_signatureTableKey;
+    std::vector<std::pair<std::string, std::string> > m_addedMatches;
+    uint64_t m_foundCount;
+    uint64_t m_addedCount;
+};
+
+#endif
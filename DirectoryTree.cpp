@@ -0,0 +1,97 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file DirectoryTree.cpp
+ * Contains the implementation of an in-memory index of the directories of an
+ * image.
+ */
+
+#include "DirectoryTree.h"
+
+// System includes
+#include <algorithm>
+
+const size_t DirectoryTree::NO_DIRECTORY = static_cast<size_t>(-1);
+const size_t DirectoryTree::NO_NAME = static_cast<size_t>(-1);
+
+DirectoryTree::DirectoryTree() : m_lastFileId(0), m_lastIndex(NO_DIRECTORY)
+{
+}
+
+void DirectoryTree::add(uint64_t fileId, uint64_t parentFileId, const std::string &name)
+{
+    Directory directory;
+    directory.fileId = fileId;
+    directory.parentFileId = parentFileId;
+    directory.parent = NO_DIRECTORY;
+
+    std::map<std::string, size_t>::const_iterator nameId = m_nameIds.find(name);
+    if (nameId != m_nameIds.end())
+    {
+        directory.nameId = nameId->second;
+    }
+    else
+    {
+        directory.nameId = m_names.size();
+        m_nameIds[name] = directory.nameId;
+        m_names.push_back(name);
+    }
+
+    m_directories.push_back(directory);
+}
+
+void DirectoryTree::build()
+{
+    std::sort(m_directories.begin(), m_directories.end());
+    m_lastIndex = NO_DIRECTORY;
+    for (size_t i = 0; i < m_directories.size(); ++i)
+    {
+        // Root directories are their own parents in some file systems.
+        const size_t parent = search(m_directories[i].parentFileId);
+        m_directories[i].parent = parent != i ? parent : NO_DIRECTORY;
+    }
+}
+
+void DirectoryTree::clear()
+{
+    m_directories.clear();
+    m_names.clear();
+    m_nameIds.clear();
+    m_lastFileId = 0;
+    m_lastIndex = NO_DIRECTORY;
+}
+
+size_t DirectoryTree::search(uint64_t fileId) const
+{
+    Directory key;
+    key.fileId = fileId;
+    std::vector<Directory>::const_iterator directory = std::lower_bound(m_directories.begin(), m_directories.end(), key);
+    if (directory != m_directories.end() && directory->fileId == fileId)
+    {
+        return directory - m_directories.begin();
+    }
+    return NO_DIRECTORY;
+}
+
+size_t DirectoryTree::find(uint64_t fileId) const
+{
+    if (m_lastIndex == NO_DIRECTORY || fileId != m_lastFileId)
+    {
+        m_lastFileId = fileId;
+        m_lastIndex = search(fileId);
+    }
+    return m_lastIndex;
+}
+
+size_t DirectoryTree::findName(const std::string &name) const
+{
+    std::map<std::string, size_t>::const_iterator nameId = m_nameIds.find(name);
+    return nameId != m_nameIds.end() ? nameId->second : NO_NAME;
+}
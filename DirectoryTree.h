@@ -0,0 +1,122 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file DirectoryTree.h
+ * Contains the interface of an in-memory index of the directories of an
+ * image and their parent directories.
+ */
+
+#ifndef _DIRECTORY_TREE_H
+#define _DIRECTORY_TREE_H
+
+// System includes
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+/**
+ * A directory tree holds the file id, parent file id and name of every
+ * directory in an image, so that questions about the ancestors of files can
+ * be answered by walking parent links in memory rather than by querying the
+ * image database. Directories are identified by a dense index assigned by
+ * build(), which callers can use to index their own per-directory data.
+ *
+ * Directory names are interned: each distinct name is stored once and given
+ * a name id, so that directory names can be compared by id.
+ */
+class DirectoryTree
+{
+public:
+    /** The index returned for file ids that are not directories in the tree. */
+    static const size_t NO_DIRECTORY;
+
+    /** The name id returned for names that no directory in the tree has. */
+    static const size_t NO_NAME;
+
+    DirectoryTree();
+
+    /**
+     * Adds a directory to the tree. Directories may be added in any order.
+     *
+     * @param fileId The file id of the directory.
+     * @param parentFileId The file id of the directory's parent directory.
+     * @param name The name of the directory.
+     */
+    void add(uint64_t fileId, uint64_t parentFileId, const std::string &name);
+
+    /**
+     * Assigns indexes to the directories added to the tree and resolves their
+     * parent directories. Must be called after the directories are added.
+     */
+    void build();
+
+    /**
+     * Removes all of the directories from the tree.
+     */
+    void clear();
+
+    size_t size() const { return m_directories.size(); }
+
+    /**
+     * Finds a directory by file id. Lookups of the same directory in a row,
+     * as when the files of a directory are looked up in file id order, take
+     * constant time.
+     *
+     * @param fileId The file id of a directory.
+     * @return The index of the directory, or NO_DIRECTORY.
+     */
+    size_t find(uint64_t fileId) const;
+
+    /**
+     * Gets the parent directory of a directory.
+     *
+     * @param index The index of a directory.
+     * @return The index of the parent directory, or NO_DIRECTORY for root 
+     * directories and directories whose parent is not in the tree.
+     */
+    size_t getParent(size_t index) const { return m_directories[index].parent; }
+
+    /**
+     * Finds the name id of a directory name.
+     *
+     * @param name A directory name.
+     * @return The name id, or NO_NAME if no directory in the tree has the name.
+     */
+    size_t findName(const std::string &name) const;
+
+    uint64_t getFileId(size_t index) const { return m_directories[index].fileId; }
+    size_t getNameId(size_t index) const { return m_directories[index].nameId; }
+    const std::string &getName(size_t index) const { return m_names[m_directories[index].nameId]; }
+
+private:
+    struct Directory
+    {
+        bool operator<(const Directory &other) const
+        {
+            return fileId < other.fileId;
+        }
+
+        uint64_t fileId;
+        uint64_t parentFileId;
+        size_t parent;
+        size_t nameId;
+    };
+
+    size_t search(uint64_t fileId) const;
+
+    std::vector<Directory> m_directories;
+    std::vector<std::string> m_names;
+    std::map<std::string, size_t> m_nameIds;
+    mutable uint64_t m_lastFileId;
+    mutable size_t m_lastIndex;
+};
+
+#endif
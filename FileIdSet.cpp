@@ -0,0 +1,430 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file FileIdSet.cpp
+ * Contains the implementation of a compressed set of file ids.
+ */
+
+#include "FileIdSet.h"
+
+// System includes
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+    const unsigned int CHUNK_BITS = 16;
+    const uint64_t CHUNK_MASK = (1 << CHUNK_BITS) - 1;
+    const size_t BITMAP_WORDS = (1 << CHUNK_BITS) / 64;
+
+    // A chunk with more values than this is stored as a bitmap, which then takes less memory than the array.
+    const uint32_t MAX_ARRAY_SIZE = 4096;
+
+    uint32_t countBits(uint64_t word)
+    {
+        uint32_t count = 0;
+        while (word != 0)
+        {
+            word &= word - 1;
+            ++count;
+        }
+        return count;
+    }
+
+    uint32_t findFirstBit(uint64_t word)
+    {
+        uint32_t position = 0;
+        while ((word & 1) == 0)
+        {
+            word >>= 1;
+            ++position;
+        }
+        return position;
+    }
+}
+
+bool FileIdSet::Chunk::contains(uint16_t value) const
+{
+    if (isBitmap())
+    {
+        return (bits[value / 64] & (static_cast<uint64_t>(1) << (value % 64))) != 0;
+    }
+    return std::binary_search(values.begin(), values.end(), value);
+}
+
+void FileIdSet::Chunk::add(uint16_t value)
+{
+    if (isBitmap())
+    {
+        const uint64_t bit = static_cast<uint64_t>(1) << (value % 64);
+        if ((bits[value / 64] & bit) == 0)
+        {
+            bits[value / 64] |= bit;
+            ++count;
+        }
+        return;
+    }
+
+    if (values.empty() || values.back() < value)
+    {
+        values.push_back(value);
+    }
+    else
+    {
+        std::vector<uint16_t>::iterator position = std::lower_bound(values.begin(), values.end(), value);
+        if (*position == value)
+        {
+            return;
+        }
+        values.insert(position, value);
+    }
+    ++count;
+
+    if (count > MAX_ARRAY_SIZE)
+    {
+        toBitmap();
+    }
+}
+
+void FileIdSet::Chunk::toBitmap()
+{
+    bits.assign(BITMAP_WORDS, 0);
+    for (std::vector<uint16_t>::const_iterator value = values.begin(); value != values.end(); ++value)
+    {
+        bits[*value / 64] |= static_cast<uint64_t>(1) << (*value % 64);
+    }
+    std::vector<uint16_t>().swap(values);
+}
+
+void FileIdSet::Chunk::toArray()
+{
+    std::vector<uint16_t> arrayValues;
+    arrayValues.reserve(count);
+    for (size_t word = 0; word < bits.size(); ++word)
+    {
+        for (uint64_t remaining = bits[word]; remaining != 0; remaining &= remaining - 1)
+        {
+            arrayValues.push_back(static_cast<uint16_t>(word * 64 + findFirstBit(remaining)));
+        }
+    }
+    values.swap(arrayValues);
+    std::vector<uint64_t>().swap(bits);
+}
+
+FileIdSet::FileIdSet()
+{
+}
+
+void FileIdSet::clear()
+{
+    std::vector<Chunk>().swap(m_chunks);
+}
+
+uint64_t FileIdSet::size() const
+{
+    uint64_t size = 0;
+    for (std::vector<Chunk>::const_iterator chunk = m_chunks.begin(); chunk != m_chunks.end(); ++chunk)
+    {
+        size += chunk->count;
+    }
+    return size;
+}
+
+uint64_t FileIdSet::getBytes() const
+{
+    uint64_t bytes = sizeof(FileIdSet) + m_chunks.capacity() * sizeof(Chunk);
+    for (std::vector<Chunk>::const_iterator chunk = m_chunks.begin(); chunk != m_chunks.end(); ++chunk)
+    {
+        bytes += chunk->values.capacity() * sizeof(uint16_t) + chunk->bits.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+void FileIdSet::add(uint64_t fileId)
+{
+    const uint64_t key = fileId >> CHUNK_BITS;
+    if (m_chunks.empty() || m_chunks.back().key < key)
+    {
+        m_chunks.push_back(Chunk(key));
+    }
+
+    // File ids are usually added in ascending order, to the last chunk.
+    Chunk *chunk = m_chunks.back().key == key ? &m_chunks.back() : findChunk(key);
+    if (chunk == NULL)
+    {
+        chunk = &*m_chunks.insert(m_chunks.begin() + findChunkIndex(key), Chunk(key));
+    }
+    chunk->add(static_cast<uint16_t>(fileId & CHUNK_MASK));
+}
+
+bool FileIdSet::contains(uint64_t fileId) const
+{
+    const Chunk *chunk = findChunk(fileId >> CHUNK_BITS);
+    return chunk != NULL && chunk->contains(static_cast<uint16_t>(fileId & CHUNK_MASK));
+}
+
+void FileIdSet::unite(const FileIdSet &other)
+{
+    std::vector<Chunk> chunks;
+    chunks.reserve(m_chunks.size() + other.m_chunks.size());
+    std::vector<Chunk>::const_iterator chunk = m_chunks.begin();
+    std::vector<Chunk>::const_iterator otherChunk = other.m_chunks.begin();
+    while (chunk != m_chunks.end() || otherChunk != other.m_chunks.end())
+    {
+        if (otherChunk == other.m_chunks.end() || (chunk != m_chunks.end() && chunk->key < otherChunk->key))
+        {
+            chunks.push_back(*chunk++);
+        }
+        else if (chunk == m_chunks.end() || otherChunk->key < chunk->key)
+        {
+            chunks.push_back(*otherChunk++);
+        }
+        else
+        {
+            Chunk united(chunk->key);
+            if (chunk->isBitmap() || otherChunk->isBitmap() || chunk->count + otherChunk->count > MAX_ARRAY_SIZE)
+            {
+                Chunk left(*chunk);
+                Chunk right(*otherChunk);
+                if (!left.isBitmap())
+                {
+                    left.toBitmap();
+                }
+                if (!right.isBitmap())
+                {
+                    right.toBitmap();
+                }
+                united.bits.swap(left.bits);
+                for (size_t word = 0; word < BITMAP_WORDS; ++word)
+                {
+                    united.bits[word] |= right.bits[word];
+                    united.count += countBits(united.bits[word]);
+                }
+                if (united.count <= MAX_ARRAY_SIZE)
+                {
+                    united.toArray();
+                }
+            }
+            else
+            {
+                std::set_union(chunk->values.begin(), chunk->values.end(), otherChunk->values.begin(), otherChunk->values.end(),
+                    std::back_inserter(united.values));
+                united.count = static_cast<uint32_t>(united.values.size());
+            }
+            chunks.push_back(united);
+            ++chunk;
+            ++otherChunk;
+        }
+    }
+    m_chunks.swap(chunks);
+}
+
+void FileIdSet::subtract(const FileIdSet &other)
+{
+    size_t keptChunk = 0;
+    for (size_t i = 0; i < m_chunks.size(); ++i)
+    {
+        Chunk &chunk = m_chunks[i];
+        const Chunk *otherChunk = other.findChunk(chunk.key);
+        if (otherChunk != NULL)
+        {
+            if (chunk.isBitmap())
+            {
+                chunk.count = 0;
+                for (size_t word = 0; word < BITMAP_WORDS; ++word)
+                {
+                    if (otherChunk->isBitmap())
+                    {
+                        chunk.bits[word] &= ~otherChunk->bits[word];
+                    }
+                    chunk.count += countBits(chunk.bits[word]);
+                }
+                if (!otherChunk->isBitmap())
+                {
+                    for (std::vector<uint16_t>::const_iterator value = otherChunk->values.begin(); value != otherChunk->values.end(); ++value)
+                    {
+                        const uint64_t bit = static_cast<uint64_t>(1) << (*value % 64);
+                        if ((chunk.bits[*value / 64] & bit) != 0)
+                        {
+                            chunk.bits[*value / 64] &= ~bit;
+                            --chunk.count;
+                        }
+                    }
+                }
+                if (chunk.count <= MAX_ARRAY_SIZE)
+                {
+                    chunk.toArray();
+                }
+            }
+            else
+            {
+                size_t keptValue = 0;
+                for (size_t j = 0; j < chunk.values.size(); ++j)
+                {
+                    if (!otherChunk->contains(chunk.values[j]))
+                    {
+                        chunk.values[keptValue++] = chunk.values[j];
+                    }
+                }
+                chunk.values.resize(keptValue);
+                chunk.count = static_cast<uint32_t>(keptValue);
+            }
+        }
+
+        if (chunk.count != 0)
+        {
+            if (keptChunk != i)
+            {
+                m_chunks[keptChunk] = chunk;
+            }
+            ++keptChunk;
+        }
+    }
+    m_chunks.erase(m_chunks.begin() + keptChunk, m_chunks.end());
+}
+
+void FileIdSet::intersect(const FileIdSet &other)
+{
+    size_t keptChunk = 0;
+    for (size_t i = 0; i < m_chunks.size(); ++i)
+    {
+        Chunk &chunk = m_chunks[i];
+        const Chunk *otherChunk = other.findChunk(chunk.key);
+        if (otherChunk == NULL)
+        {
+            continue;
+        }
+
+        if (chunk.isBitmap() && otherChunk->isBitmap())
+        {
+            chunk.count = 0;
+            for (size_t word = 0; word < BITMAP_WORDS; ++word)
+            {
+                chunk.bits[word] &= otherChunk->bits[word];
+                chunk.count += countBits(chunk.bits[word]);
+            }
+            if (chunk.count <= MAX_ARRAY_SIZE)
+            {
+                chunk.toArray();
+            }
+        }
+        else
+        {
+            // The result has no more values than the chunk that is an array, so it is an array too.
+            if (chunk.isBitmap())
+            {
+                std::vector<uint16_t> values;
+                for (std::vector<uint16_t>::const_iterator value = otherChunk->values.begin(); value != otherChunk->values.end(); ++value)
+                {
+                    if (chunk.contains(*value))
+                    {
+                        values.push_back(*value);
+                    }
+                }
+                chunk.values.swap(values);
+                std::vector<uint64_t>().swap(chunk.bits);
+            }
+            else
+            {
+                size_t keptValue = 0;
+                for (size_t j = 0; j < chunk.values.size(); ++j)
+                {
+                    if (otherChunk->contains(chunk.values[j]))
+                    {
+                        chunk.values[keptValue++] = chunk.values[j];
+                    }
+                }
+                chunk.values.resize(keptValue);
+            }
+            chunk.count = static_cast<uint32_t>(chunk.values.size());
+        }
+
+        if (chunk.count != 0)
+        {
+            if (keptChunk != i)
+            {
+                m_chunks[keptChunk] = chunk;
+            }
+            ++keptChunk;
+        }
+    }
+    m_chunks.erase(m_chunks.begin() + keptChunk, m_chunks.end());
+}
+
+FileIdSet::Chunk *FileIdSet::findChunk(uint64_t key)
+{
+    return const_cast<Chunk *>(static_cast<const FileIdSet *>(this)->findChunk(key));
+}
+
+const FileIdSet::Chunk *FileIdSet::findChunk(uint64_t key) const
+{
+    const size_t index = findChunkIndex(key);
+    return index < m_chunks.size() && m_chunks[index].key == key ? &m_chunks[index] : NULL;
+}
+
+size_t FileIdSet::findChunkIndex(uint64_t key) const
+{
+    size_t low = 0;
+    size_t high = m_chunks.size();
+    while (low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+        if (m_chunks[middle].key < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+FileIdSet::Iterator::Iterator(const FileIdSet &set) : m_set(set), m_chunk(0), m_position(0), m_fileId(0)
+{
+    seek();
+}
+
+void FileIdSet::Iterator::next()
+{
+    ++m_position;
+    seek();
+}
+
+void FileIdSet::Iterator::seek()
+{
+    // Moves to the first file id at or after the current position, which for a bitmap chunk is a bit position.
+    for (; m_chunk < m_set.m_chunks.size(); ++m_chunk, m_position = 0)
+    {
+        const Chunk &chunk = m_set.m_chunks[m_chunk];
+        if (!chunk.isBitmap())
+        {
+            if (m_position < chunk.values.size())
+            {
+                m_fileId = (chunk.key << CHUNK_BITS) | chunk.values[m_position];
+                return;
+            }
+            continue;
+        }
+
+        while (m_position < BITMAP_WORDS * 64)
+        {
+            const uint64_t word = chunk.bits[m_position / 64] >> (m_position % 64);
+            if (word != 0)
+            {
+                m_position += findFirstBit(word);
+                m_fileId = (chunk.key << CHUNK_BITS) | m_position;
+                return;
+            }
+            m_position = (m_position / 64 + 1) * 64;
+        }
+    }
+}
@@ -0,0 +1,118 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file FileIdSet.h
+ * Contains the interface of a compressed set of file ids.
+ */
+
+#ifndef _FILE_ID_SET_H
+#define _FILE_ID_SET_H
+
+// System includes
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A file id set holds file ids in compressed form, in the manner of a
+ * roaring bitmap. The file ids are split into chunks of 65536 consecutive
+ * ids that share their high bits. A chunk with few ids stores the low 16
+ * bits of each in a sorted array; a chunk with more ids stores a bitmap of
+ * all 65536 ids, so a dense range of file ids takes a bit per id rather
+ * than eight bytes. Unions and differences of sets work a chunk at a time,
+ * and a bitmap chunk a word at a time.
+ *
+ * Adding file ids in ascending order is fastest, but they may be added in
+ * any order.
+ */
+class FileIdSet
+{
+public:
+    FileIdSet();
+
+    void clear();
+    bool empty() const { return m_chunks.empty(); }
+
+    /** Gets the number of file ids in the set. */
+    uint64_t size() const;
+
+    /** Gets the number of bytes of memory held by the set. */
+    uint64_t getBytes() const;
+
+    void add(uint64_t fileId);
+    bool contains(uint64_t fileId) const;
+
+    /** Adds the file ids of another set to the set. */
+    void unite(const FileIdSet &other);
+
+    /** Removes the file ids of another set from the set. */
+    void subtract(const FileIdSet &other);
+
+    /** Removes the file ids that are not in another set from the set. */
+    void intersect(const FileIdSet &other);
+
+    /**
+     * Visits the file ids of a set in ascending order, for example:
+     *
+     *     for (FileIdSet::Iterator fileId(set); !fileId.atEnd(); fileId.next())
+     *     {
+     *         use(fileId.get());
+     *     }
+     *
+     * The set must not change while it is being visited.
+     */
+    class Iterator
+    {
+    public:
+        explicit Iterator(const FileIdSet &set);
+        bool atEnd() const { return m_chunk == m_set.m_chunks.size(); }
+        uint64_t get() const { return m_fileId; }
+        void next();
+
+    private:
+        void seek();
+
+        const FileIdSet &m_set;
+        size_t m_chunk;
+        uint32_t m_position;
+        uint64_t m_fileId;
+    };
+
+private:
+    /**
+     * The file ids with the same high bits, stored either as an array of
+     * their sorted low bits or as a bitmap of the low bits.
+     */
+    struct Chunk
+    {
+        explicit Chunk(uint64_t key) : key(key), count(0) {}
+
+        bool isBitmap() const { return !bits.empty(); }
+        bool contains(uint16_t value) const;
+        void add(uint16_t value);
+        void toBitmap();
+        void toArray();
+
+        uint64_t key;
+        uint32_t count;
+        std::vector<uint16_t> values;
+        std::vector<uint64_t> bits;
+    };
+
+    Chunk *findChunk(uint64_t key);
+    const Chunk *findChunk(uint64_t key) const;
+
+    /** Gets the index of the first chunk whose key is not less than a key. */
+    size_t findChunkIndex(uint64_t key) const;
+
+    std::vector<Chunk> m_chunks;
+};
+
+#endif
@@ -0,0 +1,369 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file FileNameIndex.cpp
+ * Contains the implementation of an index of case folded file names and
+ * extensions kept in an SQLite image database.
+ */
+
+#include "FileNameIndex.h"
+#include "Glob.h"
+#include "SqliteDatabase.h"
+
+// TSK Framework includes, including the SQLite API used by the SQLite image database.
+#include "TskModuleDev.h"
+#include "framework.h"
+
+// Poco includes
+#include "Poco/String.h"
+
+// System includes
+#include <sstream>
+#include <algorithm>
+
+namespace
+{
+    const char *CREATE_TABLE_STATEMENT = "CREATE TABLE IF NOT EXISTS ifm_file_names "
+        "(file_id INTEGER PRIMARY KEY, folded_name TEXT, folded_extension TEXT, meta_type INTEGER)";
+    const char *CREATE_NAME_INDEX_STATEMENT = "CREATE INDEX IF NOT EXISTS ifm_file_names_folded_name ON ifm_file_names (folded_name)";
+    const char *CREATE_EXTENSION_INDEX_STATEMENT = "CREATE INDEX IF NOT EXISTS ifm_file_names_folded_extension ON ifm_file_names (folded_extension)";
+    const char *LAST_FILE_ID_QUERY = "SELECT IFNULL(MAX(file_id), 0) FROM ifm_file_names";
+    const char *NEW_FILES_QUERY = "SELECT file_id, name, meta_type FROM files WHERE file_id > ? ORDER BY file_id";
+    const char *INSERT_STATEMENT = "INSERT INTO ifm_file_names (file_id, folded_name, folded_extension, meta_type) VALUES (?, ?, ?, ?)";
+
+    const char *CREATE_TRIGRAMS_TABLE_STATEMENT = "CREATE TABLE IF NOT EXISTS ifm_name_trigrams (trigram INTEGER, file_id INTEGER)";
+    const char *CREATE_TRIGRAMS_INDEX_STATEMENT = "CREATE INDEX IF NOT EXISTS ifm_name_trigrams_trigram ON ifm_name_trigrams (trigram, file_id)";
+    const char *CREATE_TRIGRAM_COUNTS_TABLE_STATEMENT = "CREATE TABLE IF NOT EXISTS ifm_trigram_counts (trigram INTEGER PRIMARY KEY, file_count INTEGER)";
+    const char *CREATE_TRIGRAMS_STATE_TABLE_STATEMENT = "CREATE TABLE IF NOT EXISTS ifm_trigrams_state (last_file_id INTEGER)";
+    const char *TRIGRAMS_LAST_FILE_ID_QUERY = "SELECT IFNULL(MAX(last_file_id), 0) FROM ifm_trigrams_state";
+    const char *NEW_NAMES_QUERY = "SELECT file_id, folded_name FROM ifm_file_names WHERE file_id > ? ORDER BY file_id";
+    const char *INSERT_TRIGRAM_STATEMENT = "INSERT INTO ifm_name_trigrams (trigram, file_id) VALUES (?, ?)";
+    const char *INSERT_TRIGRAM_COUNT_STATEMENT = "INSERT OR IGNORE INTO ifm_trigram_counts (trigram, file_count) VALUES (?, 0)";
+    const char *UPDATE_TRIGRAM_COUNT_STATEMENT = "UPDATE ifm_trigram_counts SET file_count = file_count + ? WHERE trigram = ?";
+    const char *DELETE_TRIGRAMS_STATE_STATEMENT = "DELETE FROM ifm_trigrams_state";
+    const char *INSERT_TRIGRAMS_STATE_STATEMENT = "INSERT INTO ifm_trigrams_state (last_file_id) VALUES (?)";
+    const char *TRIGRAM_COUNTS_QUERY = "SELECT trigram, file_count FROM ifm_trigram_counts";
+
+    // The number of trigrams of a pattern, besides the rarest, that files are checked for before their names are 
+    // verified against the pattern. Checking more trigrams costs more lookups for each file with the rarest trigram.
+    const size_t MAX_CHECKED_TRIGRAMS = 3;
+
+    uint32_t makeTrigram(const std::string &text, size_t position)
+    {
+        return (static_cast<uint32_t>(static_cast<unsigned char>(text[position])) << 16) | 
+            (static_cast<uint32_t>(static_cast<unsigned char>(text[position + 1])) << 8) | 
+            static_cast<uint32_t>(static_cast<unsigned char>(text[position + 2]));
+    }
+
+    /**
+     * Gets the distinct trigrams of a string, in ascending order.
+     */
+    void getTrigrams(const std::string &text, std::vector<uint32_t> &trigrams)
+    {
+        for (size_t i = 0; i + 3 <= text.size(); ++i)
+        {
+            trigrams.push_back(makeTrigram(text, i));
+        }
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    }
+
+    /**
+     * Gets the literals of a glob pattern, the pieces between its wildcards.
+     */
+    void getLiterals(const std::string &pattern, std::vector<std::string> &literals)
+    {
+        size_t pieceStart = 0;
+        while (pieceStart <= pattern.size())
+        {
+            size_t pieceEnd = pattern.find('*', pieceStart);
+            if (pieceEnd == std::string::npos)
+            {
+                pieceEnd = pattern.size();
+            }
+            if (pieceEnd > pieceStart)
+            {
+                literals.push_back(pattern.substr(pieceStart, pieceEnd - pieceStart));
+            }
+            pieceStart = pieceEnd + 1;
+        }
+    }
+
+    std::string quote(const std::string &s)
+    {
+        std::string quoted("'");
+        for (std::string::const_iterator c = s.begin(); c != s.end(); ++c)
+        {
+            quoted += *c;
+            if (*c == '\'')
+            {
+                quoted += '\'';
+            }
+        }
+        return quoted + "'";
+    }
+
+    /**
+     * Adds the files added to the image database since the file name table 
+     * was last brought up to date to the table.
+     *
+     * @return The number of files added.
+     */
+    uint64_t addFileNames(SqliteConnection &connection)
+    {
+        connection.execute(CREATE_TABLE_STATEMENT);
+
+        // Files are only ever added to the image database, with increasing file ids, so the files that are
+        // not yet in the index are those after the last one that is.
+        SqliteStatement newFilesQuery(connection, NEW_FILES_QUERY);
+        SqliteStatement insertStatement(connection, INSERT_STATEMENT);
+        sqlite3_bind_int64(newFilesQuery.get(), 1, SqliteStatement(connection, LAST_FILE_ID_QUERY).queryInteger());
+        uint64_t addedFileCount = 0;
+        while (newFilesQuery.step())
+        {
+            const unsigned char *name = sqlite3_column_text(newFilesQuery.get(), 1);
+            const std::string foldedName = Poco::toUpper(std::string(name != NULL ? reinterpret_cast<const char *>(name) : ""));
+            const std::string foldedExtension = FileNameIndex::getExtension(foldedName);
+
+            sqlite3_bind_int64(insertStatement.get(), 1, sqlite3_column_int64(newFilesQuery.get(), 0));
+            sqlite3_bind_text(insertStatement.get(), 2, foldedName.c_str(), static_cast<int>(foldedName.size()), SQLITE_TRANSIENT);
+            sqlite3_bind_text(insertStatement.get(), 3, foldedExtension.c_str(), static_cast<int>(foldedExtension.size()), SQLITE_TRANSIENT);
+            sqlite3_bind_int(insertStatement.get(), 4, sqlite3_column_int(newFilesQuery.get(), 2));
+            insertStatement.execute();
+            ++addedFileCount;
+        }
+
+        // The indexes are created after the first files are added, which is faster than adding the files to them.
+        connection.execute(CREATE_NAME_INDEX_STATEMENT);
+        connection.execute(CREATE_EXTENSION_INDEX_STATEMENT);
+        return addedFileCount;
+    }
+
+    /**
+     * Adds the trigrams of the names added to the file name table since the 
+     * trigram index was last brought up to date to the trigram index.
+     */
+    void addNameTrigrams(SqliteConnection &connection)
+    {
+        connection.execute(CREATE_TRIGRAMS_TABLE_STATEMENT);
+        connection.execute(CREATE_TRIGRAM_COUNTS_TABLE_STATEMENT);
+        connection.execute(CREATE_TRIGRAMS_STATE_TABLE_STATEMENT);
+
+        // Names shorter than three characters have no trigrams, so the last file whose name was indexed is recorded
+        // separately.
+        sqlite3_int64 lastFileId = SqliteStatement(connection, TRIGRAMS_LAST_FILE_ID_QUERY).queryInteger();
+        SqliteStatement newNamesQuery(connection, NEW_NAMES_QUERY);
+        SqliteStatement insertStatement(connection, INSERT_TRIGRAM_STATEMENT);
+        sqlite3_bind_int64(newNamesQuery.get(), 1, lastFileId);
+        std::map<uint32_t, uint64_t> addedFileCounts;
+        std::vector<uint32_t> trigrams;
+        while (newNamesQuery.step())
+        {
+            lastFileId = sqlite3_column_int64(newNamesQuery.get(), 0);
+            const unsigned char *name = sqlite3_column_text(newNamesQuery.get(), 1);
+            trigrams.clear();
+            getTrigrams(std::string(name != NULL ? reinterpret_cast<const char *>(name) : ""), trigrams);
+            for (std::vector<uint32_t>::const_iterator trigram = trigrams.begin(); trigram != trigrams.end(); ++trigram)
+            {
+                sqlite3_bind_int64(insertStatement.get(), 1, *trigram);
+                sqlite3_bind_int64(insertStatement.get(), 2, lastFileId);
+                insertStatement.execute();
+                ++addedFileCounts[*trigram];
+            }
+        }
+
+        SqliteStatement insertCountStatement(connection, INSERT_TRIGRAM_COUNT_STATEMENT);
+        SqliteStatement updateCountStatement(connection, UPDATE_TRIGRAM_COUNT_STATEMENT);
+        for (std::map<uint32_t, uint64_t>::const_iterator count = addedFileCounts.begin(); count != addedFileCounts.end(); ++count)
+        {
+            sqlite3_bind_int64(insertCountStatement.get(), 1, count->first);
+            insertCountStatement.execute();
+            sqlite3_bind_int64(updateCountStatement.get(), 1, count->second);
+            sqlite3_bind_int64(updateCountStatement.get(), 2, count->first);
+            updateCountStatement.execute();
+        }
+
+        connection.execute(DELETE_TRIGRAMS_STATE_STATEMENT);
+        SqliteStatement insertStateStatement(connection, INSERT_TRIGRAMS_STATE_STATEMENT);
+        sqlite3_bind_int64(insertStateStatement.get(), 1, lastFileId);
+        insertStateStatement.execute();
+
+        connection.execute(CREATE_TRIGRAMS_INDEX_STATEMENT);
+    }
+}
+
+FileNameIndex::FileNameIndex() : m_isReady(false), m_hasTrigramIndex(false)
+{
+}
+
+uint64_t FileNameIndex::update(const std::string &imageDatabasePath, bool useTrigramIndex)
+{
+    clear();
+
+    SqliteConnection connection(imageDatabasePath, false);
+    uint64_t addedFileCount = 0;
+    connection.execute("BEGIN IMMEDIATE");
+    try
+    {
+        addedFileCount = addFileNames(connection);
+        if (useTrigramIndex)
+        {
+            addNameTrigrams(connection);
+        }
+        connection.execute("COMMIT");
+    }
+    catch (...)
+    {
+        sqlite3_exec(connection.get(), "ROLLBACK", NULL, NULL, NULL);
+        throw;
+    }
+
+    if (useTrigramIndex)
+    {
+        // The number of files with each trigram is kept in memory to choose the trigrams of patterns to look up.
+        SqliteStatement countsQuery(connection, TRIGRAM_COUNTS_QUERY);
+        while (countsQuery.step())
+        {
+            m_trigramFileCounts[static_cast<uint32_t>(sqlite3_column_int64(countsQuery.get(), 0))] = sqlite3_column_int64(countsQuery.get(), 1);
+        }
+        m_hasTrigramIndex = true;
+    }
+
+    m_isReady = true;
+    return addedFileCount;
+}
+
+void FileNameIndex::clear()
+{
+    m_isReady = false;
+    m_hasTrigramIndex = false;
+    m_trigramFileCounts.clear();
+}
+
+std::string FileNameIndex::getExtension(const std::string &name)
+{
+    const size_t lastDot = name.rfind('.');
+    return lastDot != std::string::npos ? name.substr(lastDot) : "";
+}
+
+std::string FileNameIndex::getNameLookup(const std::string &quotedFoldedName)
+{
+    return "SELECT file_id FROM ifm_file_names WHERE folded_name = " + quotedFoldedName;
+}
+
+std::string FileNameIndex::getExtensionLookup(const std::string &quotedFoldedExtension)
+{
+    return "SELECT file_id FROM ifm_file_names WHERE folded_extension = " + quotedFoldedExtension;
+}
+
+std::string FileNameIndex::getExtensionPatternLookup(const std::string &foldedExtensionPattern)
+{
+    // '*' is the only wildcard of the module's patterns, so the other GLOB wildcards are matched as literals.
+    std::string globPattern;
+    for (std::string::const_iterator c = foldedExtensionPattern.begin(); c != foldedExtensionPattern.end(); ++c)
+    {
+        if (*c == '?' || *c == '[')
+        {
+            globPattern += '[';
+            globPattern += *c;
+            globPattern += ']';
+        }
+        else
+        {
+            globPattern += *c;
+        }
+    }
+    return "SELECT file_id FROM ifm_file_names WHERE folded_extension GLOB " + quote(globPattern);
+}
+
+bool FileNameIndex::hasTrigrams(const std::string &foldedPattern)
+{
+    std::vector<std::string> literals;
+    getLiterals(foldedPattern, literals);
+    for (std::vector<std::string>::const_iterator literal = literals.begin(); literal != literals.end(); ++literal)
+    {
+        if (literal->size() >= 3)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string FileNameIndex::getPatternLookup(const std::string &foldedPattern) const
+{
+    std::vector<uint32_t> trigrams;
+    chooseTrigrams(foldedPattern, trigrams);
+    if (trigrams.empty())
+    {
+        return "";
+    }
+
+    // Walk the files with the rarest trigram, check that they have the other chosen trigrams, then verify their names.
+    std::string likePattern(foldedPattern);
+    convertGlobWildcardsToSQLWildcards(likePattern);
+    std::ostringstream lookup;
+    lookup << "SELECT n.file_id FROM ifm_name_trigrams t JOIN ifm_file_names n ON n.file_id = t.file_id WHERE t.trigram = " << trigrams[0];
+    for (size_t i = 1; i < trigrams.size(); ++i)
+    {
+        lookup << " AND EXISTS (SELECT 1 FROM ifm_name_trigrams c WHERE c.trigram = " << trigrams[i] << " AND c.file_id = t.file_id)";
+    }
+    lookup << " AND n.folded_name LIKE " << quote(likePattern) << " ESCAPE '#'";
+    return lookup.str();
+}
+
+double FileNameIndex::getPatternLookupRows(const std::string &foldedPattern) const
+{
+    std::vector<uint32_t> trigrams;
+    chooseTrigrams(foldedPattern, trigrams);
+    if (trigrams.empty())
+    {
+        return 0.0;
+    }
+
+    // Each file with the rarest trigram costs a lookup for each of the other trigrams and one for its name.
+    return static_cast<double>(getFileCount(trigrams[0])) * (trigrams.size() + 1);
+}
+
+void FileNameIndex::chooseTrigrams(const std::string &foldedPattern, std::vector<uint32_t> &trigrams) const
+{
+    if (!hasTrigramIndex())
+    {
+        return;
+    }
+
+    std::vector<std::string> literals;
+    getLiterals(foldedPattern, literals);
+    std::vector<uint32_t> patternTrigrams;
+    for (std::vector<std::string>::const_iterator literal = literals.begin(); literal != literals.end(); ++literal)
+    {
+        getTrigrams(*literal, patternTrigrams);
+    }
+    std::sort(patternTrigrams.begin(), patternTrigrams.end());
+    patternTrigrams.erase(std::unique(patternTrigrams.begin(), patternTrigrams.end()), patternTrigrams.end());
+
+    std::vector<std::pair<uint64_t, uint32_t> > rarestTrigrams;
+    for (std::vector<uint32_t>::const_iterator trigram = patternTrigrams.begin(); trigram != patternTrigrams.end(); ++trigram)
+    {
+        rarestTrigrams.push_back(std::make_pair(getFileCount(*trigram), *trigram));
+    }
+    std::sort(rarestTrigrams.begin(), rarestTrigrams.end());
+
+    for (size_t i = 0; i < rarestTrigrams.size() && i <= MAX_CHECKED_TRIGRAMS; ++i)
+    {
+        trigrams.push_back(rarestTrigrams[i].second);
+    }
+}
+
+uint64_t FileNameIndex::getFileCount(uint32_t trigram) const
+{
+    std::map<uint32_t, uint64_t>::const_iterator count = m_trigramFileCounts.find(trigram);
+    return count != m_trigramFileCounts.end() ? count->second : 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file FileNameIndex.h
+ * Contains the interface of an index of case folded file names and
+ * extensions kept in an SQLite image database.
+ */
+
+#ifndef _FILE_NAME_INDEX_H
+#define _FILE_NAME_INDEX_H
+
+// System includes
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+/**
+ * A file name index is a table in an SQLite image database that holds the
+ * file name of every file folded to upper case, along with its extension
+ * (the folded name from its last '.') and its meta type, with indexes on the
+ * folded names and extensions. Conditions on literal file names and
+ * extensions can then be answered by index lookups, rather than by queries
+ * that fold every file name in the files table.
+ *
+ * Optionally, the index also holds a trigram index of the folded names: a
+ * table of the three character substrings (trigrams) of each name, indexed
+ * by trigram, and the number of files with each trigram. A glob pattern 
+ * with a literal of at least three characters, such as "*PASSWORD*", is 
+ * then answered by walking the files with the pattern's rarest trigram, 
+ * checking that they have some of its other trigrams, and verifying the 
+ * names of those that do against the pattern.
+ *
+ * The tables are created the first time the index is used and are kept in
+ * the image database, so later runs reuse them and only add the files that
+ * were added to the image database since they were last brought up to date.
+ */
+class FileNameIndex
+{
+public:
+    FileNameIndex();
+
+    /**
+     * Creates the index in an SQLite image database, if it does not already
+     * exist, and adds to it the files added to the image database since it
+     * was last brought up to date.
+     *
+     * @param imageDatabasePath The path of the SQLite image database.
+     * @param useTrigramIndex Whether to create and update the trigram index
+     * as well.
+     * @return The number of files added to the index.
+     * @throws TskException If the index cannot be created or updated, in
+     * which case the index is not ready.
+     */
+    uint64_t update(const std::string &imageDatabasePath, bool useTrigramIndex);
+
+    /** Determines whether the index is up to date and may be used by queries. */
+    bool isReady() const { return m_isReady; }
+
+    /** Determines whether the trigram index is up to date and may be used by queries. */
+    bool hasTrigramIndex() const { return m_isReady && m_hasTrigramIndex; }
+
+    /** Stops queries from using the index. */
+    void clear();
+
+    /**
+     * Gets the extension of a file name as stored in the index: the name
+     * from its last '.', or the empty string if it has none.
+     */
+    static std::string getExtension(const std::string &name);
+
+    /**
+     * Gets a query that selects the file ids of the files with a file name.
+     *
+     * @param quotedFoldedName The file name folded to upper case, quoted as
+     * an SQL string literal.
+     */
+    static std::string getNameLookup(const std::string &quotedFoldedName);
+
+    /**
+     * Gets a query that selects the file ids of the files with an extension.
+     *
+     * @param quotedFoldedExtension The extension, including its '.', folded
+     * to upper case and quoted as an SQL string literal.
+     */
+    static std::string getExtensionLookup(const std::string &quotedFoldedExtension);
+
+    /**
+     * Gets a query that selects the file ids of the files whose extensions
+     * match a glob pattern. The literal prefix of the pattern is looked up
+     * in the index of the extensions.
+     *
+     * @param foldedExtensionPattern A glob pattern for the extension, 
+     * including its '.', folded to upper case.
+     */
+    static std::string getExtensionPatternLookup(const std::string &foldedExtensionPattern);
+
+    /**
+     * Determines whether a glob pattern has a literal long enough to be 
+     * looked up in the trigram index.
+     *
+     * @param foldedPattern A glob pattern folded to upper case.
+     */
+    static bool hasTrigrams(const std::string &foldedPattern);
+
+    /**
+     * Gets a query that selects the file ids of the files whose names match
+     * a glob pattern, using the trigram index.
+     *
+     * @param foldedPattern A glob pattern folded to upper case.
+     * @return The query, or the empty string if the trigram index is not 
+     * ready or the pattern has no literal long enough to look up.
+     */
+    std::string getPatternLookup(const std::string &foldedPattern) const;
+
+    /**
+     * Gets the number of index entries visited by the query returned by
+     * getPatternLookup().
+     */
+    double getPatternLookupRows(const std::string &foldedPattern) const;
+
+private:
+    /**
+     * Chooses the trigrams of a pattern to look up, rarest first.
+     */
+    void chooseTrigrams(const std::string &foldedPattern, std::vector<uint32_t> &trigrams) const;
+
+    uint64_t getFileCount(uint32_t trigram) const;
+
+    bool m_isReady;
+    bool m_hasTrigramIndex;
+    std::map<uint32_t, uint64_t> m_trigramFileCounts;
+};
+
+#endif
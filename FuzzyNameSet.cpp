@@ -0,0 +1,135 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file FuzzyNameSet.cpp
+ * Contains the implementation of a matcher that finds the file names within
+ * a small edit distance of any of a set of target names, using bit-parallel
+ * edit distance.
+ */
+
+#include "FuzzyNameSet.h"
+
+// TSK Framework includes
+#include "TskModuleDev.h"
+
+// System includes
+#include <sstream>
+#include <algorithm>
+
+const size_t FuzzyNameSet::MAX_TARGET_LENGTH;
+
+FuzzyNameSet::FuzzyNameSet() : m_targetsByLength(MAX_TARGET_LENGTH + 1), m_maxDistance(0)
+{
+}
+
+size_t FuzzyNameSet::add(const std::string &foldedTarget, size_t maxDistance)
+{
+    if (foldedTarget.empty() || foldedTarget.size() > MAX_TARGET_LENGTH || maxDistance >= foldedTarget.size())
+    {
+        std::ostringstream msg;
+        msg << "FuzzyNameSet::add : target name '" << foldedTarget << "' must be 1 to " << MAX_TARGET_LENGTH 
+            << " bytes long and longer than its maximum distance " << maxDistance;
+        throw TskException(msg.str());
+    }
+
+    Target target;
+    target.length = foldedTarget.size();
+    target.maxDistance = maxDistance;
+    target.positions.assign(256, 0);
+    for (size_t i = 0; i < foldedTarget.size(); ++i)
+    {
+        target.positions[static_cast<unsigned char>(foldedTarget[i])] |= static_cast<uint64_t>(1) << i;
+    }
+
+    m_targets.push_back(target);
+    m_targetsByLength[target.length].push_back(m_targets.size() - 1);
+    m_maxDistance = std::max(m_maxDistance, maxDistance);
+    return m_targets.size() - 1;
+}
+
+void FuzzyNameSet::clear()
+{
+    m_targets.clear();
+    m_targetsByLength.assign(MAX_TARGET_LENGTH + 1, std::vector<size_t>());
+    m_maxDistance = 0;
+}
+
+bool FuzzyNameSet::match(const std::string &foldedName, std::vector<bool> &matches) const
+{
+    matches.assign(m_targets.size(), false);
+
+    // Only the targets whose lengths are within the largest maximum distance of the name's length can match it.
+    const size_t nameLength = foldedName.size();
+    const size_t minLength = nameLength > m_maxDistance ? nameLength - m_maxDistance : 1;
+    const size_t maxLength = std::min(nameLength + m_maxDistance, MAX_TARGET_LENGTH);
+    bool isMatched = false;
+    for (size_t length = minLength; length <= maxLength; ++length)
+    {
+        const std::vector<size_t> &targetIds = m_targetsByLength[length];
+        for (std::vector<size_t>::const_iterator targetId = targetIds.begin(); targetId != targetIds.end(); ++targetId)
+        {
+            const size_t distance = getDistance(*targetId, foldedName);
+            if (distance != 0 && distance <= m_targets[*targetId].maxDistance)
+            {
+                matches[*targetId] = true;
+                isMatched = true;
+            }
+        }
+    }
+    return isMatched;
+}
+
+size_t FuzzyNameSet::getDistance(size_t targetId, const std::string &foldedName) const
+{
+    const Target &target = m_targets[targetId];
+    const size_t nameLength = foldedName.size();
+    const size_t lengthDifference = nameLength > target.length ? nameLength - target.length : target.length - nameLength;
+    if (lengthDifference > target.maxDistance)
+    {
+        return target.maxDistance + 1;
+    }
+
+    // The columns of the dynamic programming matrix of the distance are kept as bit vectors of their vertical differences,
+    // positive (pv) and negative (mv), and the distance so far is the value in the last row.
+    const uint64_t lastRow = static_cast<uint64_t>(1) << (target.length - 1);
+    uint64_t pv = ~static_cast<uint64_t>(0);
+    uint64_t mv = 0;
+    size_t distance = target.length;
+    for (size_t j = 0; j < nameLength; ++j)
+    {
+        const uint64_t eq = target.positions[static_cast<unsigned char>(foldedName[j])];
+        const uint64_t xv = eq | mv;
+        const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        if (ph & lastRow)
+        {
+            ++distance;
+        }
+        else if (mh & lastRow)
+        {
+            --distance;
+        }
+
+        // The first row of the matrix increases by one in every column.
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        // Each of the remaining bytes of the name lowers the distance by at most one.
+        const size_t remaining = nameLength - j - 1;
+        if (distance > target.maxDistance + remaining)
+        {
+            return target.maxDistance + 1;
+        }
+    }
+    return distance;
+}
@@ -0,0 +1,102 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file FuzzyNameSet.h
+ * Contains the interface of a matcher that finds the file names within a
+ * small edit distance of any of a set of target names.
+ */
+
+#ifndef _FUZZY_NAME_SET_H
+#define _FUZZY_NAME_SET_H
+
+// System includes
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A fuzzy name set finds, in one call per file name, which of its target 
+ * names are within their maximum edit distance (Levenshtein distance, in
+ * bytes) of the name, without being equal to it. Matching is case 
+ * insensitive (ASCII) and callers must pass names already folded to upper 
+ * case.
+ *
+ * The targets are kept in buckets by length. Since the edit distance of two
+ * names is at least the difference of their lengths, a name is only 
+ * compared with the targets in the buckets near its own length. Each 
+ * comparison uses the bit-parallel algorithm of Myers, as adapted by Hyyrö
+ * for the distance between whole strings, which handles a target of up to 
+ * 64 bytes a word at a time for each byte of the name, and stops as soon as
+ * the rest of the name cannot bring the distance back within the maximum.
+ */
+class FuzzyNameSet
+{
+public:
+    /** The maximum length of a target name, in bytes. */
+    static const size_t MAX_TARGET_LENGTH = 64;
+
+    FuzzyNameSet();
+
+    /**
+     * Adds a target name to the set.
+     *
+     * @param foldedTarget The target name, folded to upper case.
+     * @param maxDistance The maximum edit distance of the names that match
+     * the target.
+     * @return The id of the target, used to report matches.
+     * @throws TskException If the target is empty or too long, or the 
+     * maximum distance is not less than its length.
+     */
+    size_t add(const std::string &foldedTarget, size_t maxDistance);
+
+    /**
+     * Removes all of the targets from the set.
+     */
+    void clear();
+
+    size_t size() const { return m_targets.size(); }
+
+    /**
+     * Finds the targets that a name matches.
+     *
+     * @param foldedName The name, folded to upper case.
+     * @param matches Resized to size() and set to true for each target that
+     * is within its maximum distance of the name, but not equal to it.
+     * @return True if the name matches any target.
+     */
+    bool match(const std::string &foldedName, std::vector<bool> &matches) const;
+
+    /**
+     * Gets the edit distance between a target and a name, if it is within 
+     * the target's maximum distance.
+     *
+     * @return The distance, or a value greater than the maximum distance.
+     */
+    size_t getDistance(size_t targetId, const std::string &foldedName) const;
+
+private:
+    struct Target
+    {
+        size_t length;
+        size_t maxDistance;
+
+        // For each byte, the positions of the target at which it occurs.
+        std::vector<uint64_t> positions;
+    };
+
+    std::vector<Target> m_targets;
+
+    // The ids of the targets of each length.
+    std::vector<std::vector<size_t> > m_targetsByLength;
+    size_t m_maxDistance;
+};
+
+#endif
@@ -0,0 +1,82 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file Glob.cpp
+ * Contains the implementation of glob pattern matching and conversion.
+ */
+
+#include "Glob.h"
+
+// Poco includes
+#include "Poco/String.h"
+
+bool hasGlobWildcards(const std::string &stringToCheck)
+{
+    return stringToCheck.find("*") != std::string::npos;
+}
+
+std::string EscapeWildcard(const std::string &s, char escChar) 
+{
+    std::string newS;
+    for (size_t i = 0; i < s.length(); i++) {
+        char c = s[i];
+        if (c == '_' || c == '%' || c == escChar) {
+            newS += escChar;
+        }
+        newS += c;
+    }
+    return newS;
+}
+
+void convertGlobWildcardsToSQLWildcards(std::string &stringToChange)
+{
+    // Escape all SQL wildcards chars and escape chars that happen to be in the input string.
+    stringToChange = EscapeWildcard(stringToChange, '#');
+
+    // Convert the glob wildcard chars to SQL wildcard chars.
+    Poco::replaceInPlace(stringToChange, "*", "%");
+}
+
+bool matchesGlob(const std::string &pattern, const std::string &text)
+{
+    // Greedy matching that backtracks only to the most recent '*', which
+    // is sufficient for patterns whose only wildcard is '*'.
+    size_t p = 0;
+    size_t t = 0;
+    size_t starP = std::string::npos;
+    size_t starT = 0;
+    while (t < text.size())
+    {
+        if (p < pattern.size() && pattern[p] == '*')
+        {
+            starP = p++;
+            starT = t;
+        }
+        else if (p < pattern.size() && pattern[p] == text[t])
+        {
+            ++p;
+            ++t;
+        }
+        else if (starP != std::string::npos)
+        {
+            p = starP + 1;
+            t = ++starT;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*')
+    {
+        ++p;
+    }
+    return p == pattern.size();
+}
@@ -0,0 +1,59 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file Glob.h
+ * Contains the functions that match file names against the glob patterns of
+ * search conditions and convert the patterns to SQL LIKE patterns. They are 
+ * shared by the module and the benchmarks that compare the two.
+ */
+
+#ifndef _GLOB_H
+#define _GLOB_H
+
+// System includes
+#include <string>
+
+/** 
+ * Looks for glob wildcards in a string.
+ *
+ * @param stringToCheck The string to be checked.
+ * @return True if any glob wildcards where found.
+ */
+bool hasGlobWildcards(const std::string &stringToCheck);
+
+/**
+ * Escapes the SQL LIKE wildcards ('_' and '%') and the escape character in a
+ * string.
+ *
+ * @param s The string to be escaped.
+ * @param escChar The escape character of the LIKE expression.
+ * @return The escaped string.
+ */
+std::string EscapeWildcard(const std::string &s, char escChar);
+
+/** 
+ * Converts glob wildcards in a string to SQL wildcards.
+ *
+ * @param stringToChange The string to be changed.
+ */
+void convertGlobWildcardsToSQLWildcards(std::string &stringToChange);
+
+/**
+ * Matches a string against a glob pattern in which '*' matches zero or
+ * more characters. The comparison is case sensitive, so callers fold both
+ * strings to upper case.
+ *
+ * @param pattern The glob pattern.
+ * @param text The string to be matched.
+ * @return True if the whole string matches the pattern.
+ */
+bool matchesGlob(const std::string &pattern, const std::string &text);
+
+#endif
@@ -0,0 +1,477 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file HashSetDatabase.cpp
+ * Contains the implementation of a read-only, memory mapped hash set
+ * database.
+ */
+
+#include "HashSetDatabase.h"
+
+// TSK Framework includes
+#include "TskModuleDev.h"
+
+// Poco includes
+#include "Poco/File.h"
+
+// System includes
+#include <algorithm>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <cstring>
+
+namespace
+{
+    /**
+     * Database file layout: a fixed size header, the sorted hash values,
+     * and an optional bloom filter bit array. All integers in the header
+     * are stored little-endian.
+     *
+     *   0  char[8]  magic
+     *   8  uint32   hash width in bytes
+     *  12  uint32   number of bloom filter hash functions (0 if no filter)
+     *  16  uint64   number of hash values
+     *  24  uint64   number of bloom filter bits (a power of two)
+     *  32  hash values, then bloom filter bits
+     */
+    const char DATABASE_MAGIC[8] = {'I', 'F', 'M', 'H', 'A', 'S', 'H', '1'};
+    const size_t HEADER_SIZE = 32;
+
+    // Bloom filter sizing, approximately a 1% false positive rate.
+    const uint64_t BLOOM_FILTER_BITS_PER_VALUE = 10;
+    const unsigned int BLOOM_FILTER_HASH_COUNT = 7;
+
+    // Search tuning. Hash values are uniformly distributed, so a few
+    // interpolation probes get close to the target before switching to a
+    // binary search of the remaining range.
+    const int MAX_INTERPOLATION_PROBES = 3;
+    const uint64_t BINARY_SEARCH_THRESHOLD = 64;
+
+    void putUInt32(unsigned char *buffer, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            buffer[i] = static_cast<unsigned char>(value >> (8 * i));
+        }
+    }
+
+    void putUInt64(unsigned char *buffer, uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            buffer[i] = static_cast<unsigned char>(value >> (8 * i));
+        }
+    }
+
+    uint32_t getUInt32(const unsigned char *buffer)
+    {
+        uint32_t value = 0;
+        for (int i = 3; i >= 0; --i)
+        {
+            value = (value << 8) | buffer[i];
+        }
+        return value;
+    }
+
+    uint64_t getUInt64(const unsigned char *buffer)
+    {
+        uint64_t value = 0;
+        for (int i = 7; i >= 0; --i)
+        {
+            value = (value << 8) | buffer[i];
+        }
+        return value;
+    }
+
+    /**
+     * Reads the first eight bytes of a hash value as a big-endian integer,
+     * which preserves the sort order of the hash values.
+     */
+    uint64_t getSortKey(const unsigned char *hash)
+    {
+        uint64_t key = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            key = (key << 8) | hash[i];
+        }
+        return key;
+    }
+
+    /**
+     * Computes the bit index of the i-th bloom filter hash function using
+     * double hashing. The hash values being stored are cryptographic hashes,
+     * so their bytes can be used directly as the two base hashes.
+     */
+    uint64_t getBloomFilterBit(const unsigned char *hash, unsigned int i, uint64_t bitMask)
+    {
+        const uint64_t h1 = getUInt64(hash);
+        const uint64_t h2 = getUInt64(hash + 8) | 1;
+        return (h1 + i * h2) & bitMask;
+    }
+
+    /**
+     * A fixed width binary hash value, used to sort and deduplicate a buffer
+     * of hash values in place.
+     */
+    template <size_t WIDTH>
+    struct HashValue
+    {
+        unsigned char bytes[WIDTH];
+
+        bool operator<(const HashValue &other) const
+        {
+            return memcmp(bytes, other.bytes, WIDTH) < 0;
+        }
+
+        bool operator==(const HashValue &other) const
+        {
+            return memcmp(bytes, other.bytes, WIDTH) == 0;
+        }
+    };
+
+    template <size_t WIDTH>
+    void sortAndRemoveDuplicates(std::vector<unsigned char> &hashes)
+    {
+        if (hashes.empty())
+        {
+            return;
+        }
+        HashValue<WIDTH> *begin = reinterpret_cast<HashValue<WIDTH> *>(&hashes[0]);
+        HashValue<WIDTH> *end = begin + hashes.size() / WIDTH;
+        std::sort(begin, end);
+        end = std::unique(begin, end);
+        hashes.resize((end - begin) * WIDTH);
+    }
+}
+
+bool HashSetDatabase::hexToBytes(const std::string &hex, size_t length, unsigned char *bytes)
+{
+    if (hex.size() != length * 2)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < hex.size(); ++i)
+    {
+        unsigned char nibble;
+        const char c = hex[i];
+        if (c >= '0' && c <= '9')
+        {
+            nibble = static_cast<unsigned char>(c - '0');
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            nibble = static_cast<unsigned char>(c - 'a' + 10);
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            nibble = static_cast<unsigned char>(c - 'A' + 10);
+        }
+        else
+        {
+            return false;
+        }
+
+        if (i % 2 == 0)
+        {
+            bytes[i / 2] = static_cast<unsigned char>(nibble << 4);
+        }
+        else
+        {
+            bytes[i / 2] |= nibble;
+        }
+    }
+
+    return true;
+}
+
+bool HashSetDatabase::build(const std::string &hashListPath, const std::string &databasePath, HashType hashType, bool useBloomFilter)
+{
+    const std::string MSG_PREFIX = "HashSetDatabase::build : ";
+
+    Poco::File hashListFile(hashListPath);
+    if (!hashListFile.exists())
+    {
+        std::ostringstream msg;
+        msg << MSG_PREFIX << "hash list '" << hashListPath << "' does not exist";
+        throw TskException(msg.str());
+    }
+
+    Poco::File databaseFile(databasePath);
+    if (databaseFile.exists() && !(databaseFile.getLastModified() < hashListFile.getLastModified()))
+    {
+        // The database is up to date, but it must also have been built with
+        // the requested options to be reused.
+        std::ifstream databaseStream(databasePath.c_str(), std::ios::binary);
+        unsigned char header[HEADER_SIZE];
+        if (databaseStream.read(reinterpret_cast<char *>(header), HEADER_SIZE) &&
+            memcmp(header, DATABASE_MAGIC, sizeof(DATABASE_MAGIC)) == 0 &&
+            getUInt32(header + 8) == static_cast<uint32_t>(hashType) &&
+            (getUInt32(header + 12) != 0) == useBloomFilter)
+        {
+            return false;
+        }
+    }
+
+    // Read the hash values into a buffer of fixed width binary values. This
+    // is a one time preprocessing step, lookups do not use the heap.
+    std::ifstream hashListStream(hashListPath.c_str());
+    if (!hashListStream)
+    {
+        std::ostringstream msg;
+        msg << MSG_PREFIX << "failed to open hash list '" << hashListPath << "'";
+        throw TskException(msg.str());
+    }
+
+    const size_t width = static_cast<size_t>(hashType);
+    std::vector<unsigned char> hashes;
+    unsigned char hash[SHA2_256];
+    uint64_t invalidLineCount = 0;
+    std::string line;
+    while (std::getline(hashListStream, line))
+    {
+        std::istringstream lineStream(line);
+        std::string hexHash;
+        if (!(lineStream >> hexHash) || hexHash[0] == '#')
+        {
+            continue;
+        }
+
+        if (hexToBytes(hexHash, width, hash))
+        {
+            hashes.insert(hashes.end(), hash, hash + width);
+        }
+        else
+        {
+            ++invalidLineCount;
+        }
+    }
+
+    if (invalidLineCount != 0)
+    {
+        std::ostringstream msg;
+        msg << MSG_PREFIX << "ignored " << invalidLineCount << " invalid hash values in '" << hashListPath << "'";
+        LOGWARN(msg.str());
+    }
+
+    switch (hashType)
+    {
+    case MD5:
+        sortAndRemoveDuplicates<MD5>(hashes);
+        break;
+    case SHA1:
+        sortAndRemoveDuplicates<SHA1>(hashes);
+        break;
+    case SHA2_256:
+        sortAndRemoveDuplicates<SHA2_256>(hashes);
+        break;
+    }
+    const uint64_t count = hashes.size() / width;
+
+    // Size the bloom filter to a power of two number of bits so that bit
+    // indexes can be computed with a mask.
+    std::vector<unsigned char> bloomFilter;
+    uint64_t bloomFilterBits = 0;
+    if (useBloomFilter)
+    {
+        bloomFilterBits = 64;
+        while (bloomFilterBits < count * BLOOM_FILTER_BITS_PER_VALUE)
+        {
+            bloomFilterBits <<= 1;
+        }
+        bloomFilter.resize(static_cast<size_t>(bloomFilterBits / 8), 0);
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            const unsigned char *value = &hashes[static_cast<size_t>(i * width)];
+            for (unsigned int j = 0; j < BLOOM_FILTER_HASH_COUNT; ++j)
+            {
+                const uint64_t bit = getBloomFilterBit(value, j, bloomFilterBits - 1);
+                bloomFilter[static_cast<size_t>(bit / 8)] |= static_cast<unsigned char>(1 << (bit % 8));
+            }
+        }
+    }
+
+    unsigned char header[HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header, DATABASE_MAGIC, sizeof(DATABASE_MAGIC));
+    putUInt32(header + 8, static_cast<uint32_t>(hashType));
+    putUInt32(header + 12, useBloomFilter ? BLOOM_FILTER_HASH_COUNT : 0);
+    putUInt64(header + 16, count);
+    putUInt64(header + 24, bloomFilterBits);
+
+    // Write to a temporary file and rename it so that a failed build never
+    // leaves a truncated database that looks up to date.
+    const std::string tempPath = databasePath + ".tmp";
+    {
+        std::ofstream databaseStream(tempPath.c_str(), std::ios::binary | std::ios::trunc);
+        databaseStream.write(reinterpret_cast<const char *>(header), HEADER_SIZE);
+        if (!hashes.empty())
+        {
+            databaseStream.write(reinterpret_cast<const char *>(&hashes[0]), hashes.size());
+        }
+        if (!bloomFilter.empty())
+        {
+            databaseStream.write(reinterpret_cast<const char *>(&bloomFilter[0]), bloomFilter.size());
+        }
+        if (!databaseStream)
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "failed to write hash set database '" << tempPath << "'";
+            throw TskException(msg.str());
+        }
+    }
+    if (databaseFile.exists())
+    {
+        databaseFile.remove();
+    }
+    Poco::File(tempPath).renameTo(databasePath);
+
+    std::ostringstream msg;
+    msg << MSG_PREFIX << "built hash set database '" << databasePath << "' with " << count << " hash values";
+    LOGINFO(msg.str());
+
+    return true;
+}
+
+HashSetDatabase::HashSetDatabase(const std::string &databasePath) :
+    m_hashType(MD5), m_count(0), m_entries(NULL), m_bloomFilter(NULL), m_bloomFilterBitMask(0), m_bloomFilterHashCount(0)
+{
+    const std::string MSG_PREFIX = "HashSetDatabase::HashSetDatabase : ";
+
+    Poco::File databaseFile(databasePath);
+    if (!databaseFile.exists() || databaseFile.getSize() < HEADER_SIZE)
+    {
+        std::ostringstream msg;
+        msg << MSG_PREFIX << "'" << databasePath << "' is not a hash set database";
+        throw TskException(msg.str());
+    }
+
+    m_mapping = new Poco::SharedMemory(databaseFile, Poco::SharedMemory::AM_READ);
+    const unsigned char *begin = reinterpret_cast<const unsigned char *>(m_mapping->begin());
+    const uint64_t fileSize = static_cast<uint64_t>(m_mapping->end() - m_mapping->begin());
+
+    if (memcmp(begin, DATABASE_MAGIC, sizeof(DATABASE_MAGIC)) != 0)
+    {
+        std::ostringstream msg;
+        msg << MSG_PREFIX << "'" << databasePath << "' is not a hash set database";
+        throw TskException(msg.str());
+    }
+
+    const uint32_t width = getUInt32(begin + 8);
+    if (width != MD5 && width != SHA1 && width != SHA2_256)
+    {
+        std::ostringstream msg;
+        msg << MSG_PREFIX << "'" << databasePath << "' has unsupported hash width " << width;
+        throw TskException(msg.str());
+    }
+    m_hashType = static_cast<HashType>(width);
+    m_bloomFilterHashCount = getUInt32(begin + 12);
+    m_count = getUInt64(begin + 16);
+    const uint64_t bloomFilterBits = getUInt64(begin + 24);
+
+    if (fileSize != HEADER_SIZE + m_count * width + bloomFilterBits / 8)
+    {
+        std::ostringstream msg;
+        msg << MSG_PREFIX << "'" << databasePath << "' is truncated or corrupt";
+        throw TskException(msg.str());
+    }
+
+    m_entries = begin + HEADER_SIZE;
+    if (m_bloomFilterHashCount != 0 && bloomFilterBits != 0)
+    {
+        m_bloomFilter = m_entries + m_count * width;
+        m_bloomFilterBitMask = bloomFilterBits - 1;
+    }
+}
+
+bool HashSetDatabase::bloomFilterMayContain(const unsigned char *hash) const
+{
+    for (unsigned int i = 0; i < m_bloomFilterHashCount; ++i)
+    {
+        const uint64_t bit = getBloomFilterBit(hash, i, m_bloomFilterBitMask);
+        if ((m_bloomFilter[bit / 8] & (1 << (bit % 8))) == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HashSetDatabase::contains(const unsigned char *hash) const
+{
+    if (m_count == 0 || (m_bloomFilter != NULL && !bloomFilterMayContain(hash)))
+    {
+        return false;
+    }
+
+    const size_t width = static_cast<size_t>(m_hashType);
+    const uint64_t key = getSortKey(hash);
+
+    // Narrow the range [low, high) with interpolation probes.
+    uint64_t low = 0;
+    uint64_t high = m_count;
+    for (int probe = 0; probe < MAX_INTERPOLATION_PROBES && high - low > BINARY_SEARCH_THRESHOLD; ++probe)
+    {
+        const uint64_t lowKey = getSortKey(m_entries + low * width);
+        const uint64_t highKey = getSortKey(m_entries + (high - 1) * width);
+        if (key < lowKey || key > highKey)
+        {
+            return false;
+        }
+        if (lowKey == highKey)
+        {
+            break;
+        }
+
+        const uint64_t position = low + static_cast<uint64_t>(static_cast<double>(key - lowKey) / static_cast<double>(highKey - lowKey) * static_cast<double>(high - 1 - low));
+        const int comparison = memcmp(m_entries + position * width, hash, width);
+        if (comparison == 0)
+        {
+            return true;
+        }
+        else if (comparison < 0)
+        {
+            low = position + 1;
+        }
+        else
+        {
+            high = position;
+        }
+    }
+
+    if (low >= high)
+    {
+        return false;
+    }
+
+    // Finish with a branchless lower bound search; the loop body compiles to
+    // a conditional move rather than an unpredictable branch.
+    const unsigned char *base = m_entries + low * width;
+    uint64_t length = high - low;
+    while (length > 1)
+    {
+        const uint64_t half = length / 2;
+        base = (memcmp(base + half * width, hash, width) < 0) ? base + half * width : base;
+        length -= half;
+    }
+    if (memcmp(base, hash, width) < 0)
+    {
+        base += width;
+    }
+
+    return base < m_entries + high * width && memcmp(base, hash, width) == 0;
+}
+
+bool HashSetDatabase::contains(const std::string &hexHash) const
+{
+    unsigned char hash[SHA2_256];
+    return hexToBytes(hexHash, static_cast<size_t>(m_hashType), hash) && contains(hash);
+}
@@ -0,0 +1,116 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file HashSetDatabase.h
+ * Contains the interface of a read-only hash set database used by the
+ * interesting files module to look up file hashes in very large hash lists.
+ */
+
+#ifndef _HASH_SET_DATABASE_H
+#define _HASH_SET_DATABASE_H
+
+// Poco includes
+#include "Poco/SharedMemory.h"
+#include "Poco/SharedPtr.h"
+
+// System includes
+#include <string>
+#include <stdint.h>
+
+/**
+ * A hash set database is a sorted array of fixed width binary hash values,
+ * optionally followed by a bloom filter, stored in a file that is memory
+ * mapped rather than loaded into the heap. Databases are built from text
+ * hash lists (one hexadecimal hash per line) by the build() function and
+ * are only rebuilt when the text hash list changes.
+ */
+class HashSetDatabase
+{
+public:
+    /**
+     * The hash algorithms supported by hash set databases. The values are the
+     * widths of the binary hash values in bytes.
+     */
+    enum HashType
+    {
+        MD5 = 16,
+        SHA1 = 20,
+        SHA2_256 = 32
+    };
+
+    /**
+     * Builds a hash set database from a text hash list if the database does
+     * not exist or is older than the hash list.
+     *
+     * @param hashListPath Path of a text file with one hexadecimal hash value
+     * per line. Blank lines and lines beginning with '#' are ignored, as is
+     * anything that follows the hash value on a line.
+     * @param databasePath Path of the database file to create.
+     * @param hashType The hash algorithm of the values in the hash list.
+     * @param useBloomFilter Whether or not to append a bloom filter to the
+     * database.
+     * @return True if the database was (re)built, false if it was up to date.
+     */
+    static bool build(const std::string &hashListPath, const std::string &databasePath, HashType hashType, bool useBloomFilter);
+
+    /**
+     * Memory maps an existing hash set database.
+     *
+     * @param databasePath Path of a database file created by build().
+     */
+    explicit HashSetDatabase(const std::string &databasePath);
+
+    /**
+     * Looks up a binary hash value.
+     *
+     * @param hash A binary hash value of width hashType() bytes.
+     * @return True if the hash value is in the database.
+     */
+    bool contains(const unsigned char *hash) const;
+
+    /**
+     * Looks up a hexadecimal hash value as stored in the image database.
+     *
+     * @param hexHash A hexadecimal hash value, upper or lower case.
+     * @return True if the hash value is in the database. Values that are not
+     * valid hashes of the database's type are never found.
+     */
+    bool contains(const std::string &hexHash) const;
+
+    HashType hashType() const { return m_hashType; }
+    uint64_t size() const { return m_count; }
+    bool hasBloomFilter() const { return m_bloomFilter != NULL; }
+
+    /**
+     * Converts a hexadecimal string to binary.
+     *
+     * @param hex The hexadecimal string.
+     * @param length The number of bytes expected.
+     * @param bytes Receives the binary value, must hold length bytes.
+     * @return False if the string is not exactly length bytes of hex digits.
+     */
+    static bool hexToBytes(const std::string &hex, size_t length, unsigned char *bytes);
+
+private:
+    HashSetDatabase(const HashSetDatabase &);
+    HashSetDatabase &operator=(const HashSetDatabase &);
+
+    bool bloomFilterMayContain(const unsigned char *hash) const;
+
+    Poco::SharedPtr<Poco::SharedMemory> m_mapping;
+    HashType m_hashType;
+    uint64_t m_count;
+    const unsigned char *m_entries;
+    const unsigned char *m_bloomFilter;
+    uint64_t m_bloomFilterBitMask;
+    unsigned int m_bloomFilterHashCount;
+};
+
+#endif
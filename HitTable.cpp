@@ -0,0 +1,154 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file HitTable.cpp
+ * Contains the implementation of a temporary table of interesting file hits
+ * in an SQLite image database, from which the hits are posted to the
+ * blackboard in bulk.
+ */
+
+#include "HitTable.h"
+
+// TSK Framework includes, including the SQLite API used by the SQLite image database.
+#include "TskModuleDev.h"
+#include "framework.h"
+
+// System includes
+#include <sstream>
+
+namespace
+{
+    const char *ARTIFACT_SOURCE = "InterestingFiles";
+
+    const char *CREATE_HITS_TABLE_STATEMENT = "CREATE TEMP TABLE ifm_hits "
+        "(hit_id INTEGER PRIMARY KEY, file_set INTEGER, condition_index INTEGER, file_id INTEGER)";
+    const char *CREATE_FILE_SETS_TABLE_STATEMENT = "CREATE TEMP TABLE ifm_file_sets (file_set INTEGER PRIMARY KEY, name TEXT, description TEXT)";
+    const char *CREATE_POSTED_HITS_TABLE_STATEMENT = "CREATE TEMP TABLE ifm_posted_hits "
+        "(posted_id INTEGER PRIMARY KEY, file_set INTEGER, condition_index INTEGER, file_id INTEGER)";
+    const char *INSERT_FILE_SET_STATEMENT = "INSERT INTO temp.ifm_file_sets (file_set, name, description) VALUES (?, ?, ?)";
+    const char *INSERT_HIT_STATEMENT = "INSERT INTO temp.ifm_hits (file_set, condition_index, file_id) VALUES (?, ?, ?)";
+    const char *CONDITION_HITS_QUERY = "SELECT file_id FROM temp.ifm_hits WHERE file_set = ? AND condition_index = ? ORDER BY file_id";
+
+    // The first hit of each file in each set is the one posted.
+    const char *INSERT_POSTED_HITS_STATEMENT = "INSERT INTO temp.ifm_posted_hits (file_set, condition_index, file_id) "
+        "SELECT file_set, condition_index, file_id FROM temp.ifm_hits "
+        "WHERE hit_id IN (SELECT MIN(hit_id) FROM temp.ifm_hits GROUP BY file_set, file_id) ORDER BY file_set, file_id";
+    const char *LAST_ARTIFACT_ID_QUERY = "SELECT IFNULL(MAX(artifact_id), 0) FROM blackboard_artifacts";
+    const char *INSERT_ARTIFACTS_STATEMENT = "INSERT INTO blackboard_artifacts (artifact_id, obj_id, artifact_type_id) "
+        "SELECT ? + posted_id, file_id, ? FROM temp.ifm_posted_hits";
+    const char *INSERT_ATTRIBUTES_STATEMENT = "INSERT INTO blackboard_attributes (artifact_id, source, context, attribute_type_id, value_type, "
+        "value_byte, value_text, value_int32, value_int64, value_double, obj_id) "
+        "SELECT ? + p.posted_id, ?, s.description, ?, ?, NULL, s.name, 0, 0, 0.0, p.file_id "
+        "FROM temp.ifm_posted_hits p JOIN temp.ifm_file_sets s ON s.file_set = p.file_set";
+    const char *ARTIFACT_COUNTS_QUERY = "SELECT file_set, condition_index, COUNT(*) FROM temp.ifm_posted_hits GROUP BY file_set, condition_index";
+    const char *DELETE_HITS_STATEMENT = "DELETE FROM temp.ifm_hits; DELETE FROM temp.ifm_posted_hits";
+
+    void bindText(SqliteStatement &statement, int parameter, const std::string &text)
+    {
+        sqlite3_bind_text(statement.get(), parameter, text.c_str(), static_cast<int>(text.size()), SQLITE_TRANSIENT);
+    }
+}
+
+HitTable::HitTable(const std::string &imageDatabasePath, const std::vector<FileSet> &fileSets) :
+    m_connection(imageDatabasePath, false), m_fileSetCount(fileSets.size())
+{
+    m_connection.execute(CREATE_HITS_TABLE_STATEMENT);
+    m_connection.execute(CREATE_FILE_SETS_TABLE_STATEMENT);
+    m_connection.execute(CREATE_POSTED_HITS_TABLE_STATEMENT);
+
+    SqliteStatement insertFileSetStatement(m_connection, INSERT_FILE_SET_STATEMENT);
+    for (size_t i = 0; i < fileSets.size(); ++i)
+    {
+        sqlite3_bind_int64(insertFileSetStatement.get(), 1, i);
+        bindText(insertFileSetStatement, 2, fileSets[i].name);
+        bindText(insertFileSetStatement, 3, fileSets[i].description);
+        insertFileSetStatement.execute();
+    }
+
+    m_insertStatement.reset(new SqliteStatement(m_connection, INSERT_HIT_STATEMENT));
+}
+
+uint64_t HitTable::addQueryHits(size_t fileSetIndex, size_t conditionIndex, const std::string &searchCondition, FileIdSet &fileIds)
+{
+    std::ostringstream statement;
+    statement << "INSERT INTO temp.ifm_hits (file_set, condition_index, file_id) SELECT " << fileSetIndex << ", " << conditionIndex
+        << ", file_id FROM files WHERE " << searchCondition << " ORDER BY file_id";
+    m_connection.execute(statement.str());
+    const uint64_t hitCount = sqlite3_changes(m_connection.get());
+
+    // The file ids are read back from the temporary table rather than evaluating the condition again.
+    SqliteStatement hitsQuery(m_connection, CONDITION_HITS_QUERY);
+    sqlite3_bind_int64(hitsQuery.get(), 1, fileSetIndex);
+    sqlite3_bind_int64(hitsQuery.get(), 2, conditionIndex);
+    while (hitsQuery.step())
+    {
+        fileIds.add(static_cast<uint64_t>(sqlite3_column_int64(hitsQuery.get(), 0)));
+    }
+    return hitCount;
+}
+
+void HitTable::addHit(size_t fileSetIndex, size_t conditionIndex, uint64_t fileId)
+{
+    sqlite3_bind_int64(m_insertStatement->get(), 1, fileSetIndex);
+    sqlite3_bind_int64(m_insertStatement->get(), 2, conditionIndex);
+    sqlite3_bind_int64(m_insertStatement->get(), 3, fileId);
+    m_insertStatement->execute();
+}
+
+void HitTable::post(std::vector<std::vector<uint64_t> > &artifactCounts)
+{
+    m_connection.execute(INSERT_POSTED_HITS_STATEMENT);
+
+    // The artifact ids are allocated after the last artifact in the blackboard, which no other connection can add to
+    // until the transaction ends.
+    m_connection.execute("BEGIN IMMEDIATE");
+    try
+    {
+        const int64_t lastArtifactId = SqliteStatement(m_connection, LAST_ARTIFACT_ID_QUERY).queryInteger();
+
+        SqliteStatement insertArtifactsStatement(m_connection, INSERT_ARTIFACTS_STATEMENT);
+        sqlite3_bind_int64(insertArtifactsStatement.get(), 1, lastArtifactId);
+        sqlite3_bind_int(insertArtifactsStatement.get(), 2, TSK_INTERESTING_FILE_HIT);
+        insertArtifactsStatement.execute();
+
+        SqliteStatement insertAttributesStatement(m_connection, INSERT_ATTRIBUTES_STATEMENT);
+        sqlite3_bind_int64(insertAttributesStatement.get(), 1, lastArtifactId);
+        bindText(insertAttributesStatement, 2, ARTIFACT_SOURCE);
+        sqlite3_bind_int(insertAttributesStatement.get(), 3, TSK_SET_NAME);
+        sqlite3_bind_int(insertAttributesStatement.get(), 4, TSK_STRING);
+        insertAttributesStatement.execute();
+
+        m_connection.execute("COMMIT");
+    }
+    catch (...)
+    {
+        sqlite3_exec(m_connection.get(), "ROLLBACK", NULL, NULL, NULL);
+        m_connection.execute(DELETE_HITS_STATEMENT);
+        throw;
+    }
+
+    artifactCounts.assign(m_fileSetCount, std::vector<uint64_t>());
+    SqliteStatement countsQuery(m_connection, ARTIFACT_COUNTS_QUERY);
+    while (countsQuery.step())
+    {
+        const size_t fileSetIndex = static_cast<size_t>(sqlite3_column_int64(countsQuery.get(), 0));
+        const size_t conditionIndex = static_cast<size_t>(sqlite3_column_int64(countsQuery.get(), 1));
+        if (fileSetIndex < artifactCounts.size())
+        {
+            if (artifactCounts[fileSetIndex].size() <= conditionIndex)
+            {
+                artifactCounts[fileSetIndex].resize(conditionIndex + 1, 0);
+            }
+            artifactCounts[fileSetIndex][conditionIndex] = sqlite3_column_int64(countsQuery.get(), 2);
+        }
+    }
+
+    m_connection.execute(DELETE_HITS_STATEMENT);
+}
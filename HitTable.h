@@ -0,0 +1,105 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file HitTable.h
+ * Contains the interface of a temporary table of interesting file hits in
+ * an SQLite image database, from which the hits are posted to the
+ * blackboard in bulk.
+ */
+
+#ifndef _HIT_TABLE_H
+#define _HIT_TABLE_H
+
+#include "SqliteDatabase.h"
+#include "FileIdSet.h"
+
+// System includes
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdint.h>
+
+/**
+ * A hit table collects the hits of a search in a temporary table of its
+ * own connection to an SQLite image database, and then posts them to the
+ * blackboard tables of the image database with a few set based statements
+ * in a single transaction. The hits of conditions that the image database
+ * evaluates are added to the table by the image database itself, and only
+ * their file ids are read back, so that the module can skip those files.
+ *
+ * A file is posted once per interesting files set, no matter how many hits
+ * it has in the set. The hit that is posted is the first one added, so the
+ * hits of each set are added in the order of the set's conditions.
+ */
+class HitTable
+{
+public:
+    /**
+     * An interesting files set as it is posted to the blackboard.
+     */
+    struct FileSet
+    {
+        FileSet(const std::string &name, const std::string &description) : name(name), description(description) {}
+        std::string name;
+        std::string description;
+    };
+
+    /**
+     * Opens a connection to an SQLite image database and creates the
+     * temporary tables.
+     *
+     * @param imageDatabasePath The path of the SQLite image database.
+     * @param fileSets The interesting files sets, in the order of the
+     * indexes the hits refer to.
+     * @throws TskException If the database cannot be opened.
+     */
+    HitTable(const std::string &imageDatabasePath, const std::vector<FileSet> &fileSets);
+
+    /**
+     * Adds the files selected by a condition as hits of an interesting files
+     * set.
+     *
+     * @param searchCondition An SQL expression over the files table,
+     * without an alias.
+     * @param fileIds The file ids of the hits added are added to this set,
+     * so that the rest of the search can skip the files.
+     * @return The number of hits added.
+     * @throws TskException If the condition cannot be evaluated.
+     */
+    uint64_t addQueryHits(size_t fileSetIndex, size_t conditionIndex, const std::string &searchCondition, FileIdSet &fileIds);
+
+    /**
+     * Adds a hit of an interesting files set.
+     *
+     * @throws TskException If the hit cannot be added.
+     */
+    void addHit(size_t fileSetIndex, size_t conditionIndex, uint64_t fileId);
+
+    /**
+     * Posts the hits to the blackboard as interesting file hit artifacts with
+     * the name and description of their set, and empties the table.
+     *
+     * @param artifactCounts Receives, for each set, the number of artifacts
+     * posted for each of its conditions.
+     * @throws TskException If the hits cannot be posted, in which case none
+     * of them are.
+     */
+    void post(std::vector<std::vector<uint64_t> > &artifactCounts);
+
+private:
+    HitTable(const HitTable &);
+    HitTable &operator=(const HitTable &);
+
+    SqliteConnection m_connection;
+    std::auto_ptr<SqliteStatement> m_insertStatement;
+    size_t m_fileSetCount;
+};
+
+#endif
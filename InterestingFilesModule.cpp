@@ -18,13 +18,35 @@
 #include "TskModuleDev.h"
 #include "framework.h"
 
+// Module includes
+#include "HashSetDatabase.h"
+#include "RegexSet.h"
+#include "SignatureTable.h"
+#include "DirectoryTree.h"
+#include "PathFilter.h"
+#include "Glob.h"
+#include "FileNameIndex.h"
+#include "SqliteDatabase.h"
+#include "HitTable.h"
+#include "FileIdSet.h"
+#include "FuzzyNameSet.h"
+#include "NameSkeleton.h"
+#include "NameRandomness.h"
+#include "TimestampIndex.h"
+#include "ResultCache.h"
+#include "ContentCache.h"
+
 // Poco includes
 #include "Poco/String.h"
 #include "Poco/AutoPtr.h"
 #include "Poco/Path.h"
 #include "Poco/File.h"
+#include "Poco/SharedPtr.h"
+#include "Poco/NumberParser.h"
+#include "Poco/Timestamp.h"
 #include "Poco/DOM/DOMParser.h"
 #include "Poco/DOM/Document.h"
+#include "Poco/DOM/Element.h"
 #include "Poco/DOM/NodeList.h"
 #include "Poco/DOM/NamedNodeMap.h"
 #include "Poco/SAX/InputSource.h"
@@ -34,367 +56,4422 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <map>
 #include <sstream>
 #include <fstream>
+#include <memory>
+#include <algorithm>
 
 namespace
 {
     const char *MODULE_NAME = "InterestingFilesModule";
     const char *MODULE_DESCRIPTION = "Looks for files matching criteria specified in a module configuration file";
-    const char *MODULE_VERSION = "1.0.0";
+    const char *MODULE_VERSION = "1.1.0";
     const std::string DEFAULT_CONFIG_FILE_NAME = "interesting_files.xml";
+
+    // The paths of the configuration files of several rule packs are separated by this character in the arguments, 
+    // and the name of each set of a pack is prefixed by the pack name and this separator. Pack names may not contain 
+    // the separator, so the pack of a set is always the part of its name before the first separator.
+    const char CONFIG_FILE_PATH_SEPARATOR = ';';
+    const std::string PACK_NAME_SEPARATOR = ".";
     const std::string INTERESTING_FILE_SET_ELEMENT_TAG = "INTERESTING_FILE_SET"; 
     const std::string NAME_ATTRIBUTE = "name";
     const std::string DESCRIPTION_ATTRIBUTE_TAG = "description";
     const std::string NAME_ELEMENT_TAG = "NAME";
     const std::string EXTENSION_ELEMENT_TAG = "EXTENSION";
+    const std::string HASHSET_ELEMENT_TAG = "HASHSET";
+    const std::string REGEX_ELEMENT_TAG = "REGEX";
+    const std::string SIGNATURE_ELEMENT_TAG = "SIGNATURE";
+    const std::string SUBTREE_ELEMENT_TAG = "SUBTREE";
+    const std::string DOUBLE_EXTENSION_ELEMENT_TAG = "DOUBLE_EXTENSION";
+    const std::string FUZZY_NAME_ELEMENT_TAG = "FUZZY_NAME";
+    const std::string RANDOM_NAME_ELEMENT_TAG = "RANDOM_NAME";
+    const std::string ALL_ELEMENT_TAG = "ALL";
+    const std::string ANY_ELEMENT_TAG = "ANY";
+    const std::string NOT_ELEMENT_TAG = "NOT";
+    const std::string EXCLUDE_ELEMENT_TAG = "EXCLUDE";
+    const std::string SIBLINGS_ELEMENT_TAG = "SIBLINGS";
+    const std::string CONTAINS_ELEMENT_TAG = "CONTAINS";
+    const std::string WITHIN_ELEMENT_TAG = "WITHIN";
     const std::string PATH_FILTER_ATTRIBUTE = "pathFilter";
     const std::string TYPE_FILTER_ATTRIBUTE = "typeFilter";
     const std::string FILE_TYPE_FILTER_VALUE = "file";
     const std::string DIR_TYPE_FILTER_VALUE = "dir";
+    const std::string HASH_TYPE_ATTRIBUTE = "type";
+    const std::string MD5_HASH_TYPE_VALUE = "md5";
+    const std::string SHA1_HASH_TYPE_VALUE = "sha1";
+    const std::string SHA256_HASH_TYPE_VALUE = "sha256";
+    const std::string BLOOM_FILTER_ATTRIBUTE = "bloomFilter";
+    const std::string TRUE_VALUE = "true";
+    const std::string FALSE_VALUE = "false";
+    const std::string HASH_SET_DATABASE_EXTENSION = ".hashdb";
+    const std::string TARGET_ATTRIBUTE = "target";
+    const std::string NAME_TARGET_VALUE = "name";
+    const std::string PATH_TARGET_VALUE = "path";
+    const std::string OFFSET_ATTRIBUTE = "offset";
+    const std::string INNER_ATTRIBUTE = "inner";
+    const std::string OUTER_ATTRIBUTE = "outer";
+    const std::string CHECK_CONTENT_ATTRIBUTE = "checkContent";
+    const std::string MAX_DISTANCE_ATTRIBUTE = "maxDistance";
+    const std::string CONFUSABLES_ATTRIBUTE = "confusables";
+    const std::string MIN_LENGTH_ATTRIBUTE = "minLength";
+    const std::string MIN_ENTROPY_ATTRIBUTE = "minEntropy";
+    const std::string MIN_BIGRAM_BITS_ATTRIBUTE = "minBigramBits";
+    const std::string SECONDS_ATTRIBUTE = "seconds";
+    const std::string TIMESTAMP_ATTRIBUTE = "timestamp";
+    const std::string FILE_NAME_INDEX_ATTRIBUTE = "fileNameIndex";
+    const std::string TRIGRAM_INDEX_ATTRIBUTE = "trigramIndex";
+    const std::string MATCH_FUNCTION_ATTRIBUTE = "matchFunction";
+    const std::string BULK_POSTING_ATTRIBUTE = "bulkPosting";
+    const std::string RESULT_CACHE_ATTRIBUTE = "resultCache";
+    const std::string CONTENT_CACHE_ATTRIBUTE = "contentCache";
+    const std::string PACK_ATTRIBUTE = "pack";
+
+    // The source of the set name attributes of the artifacts the module posts.
+    const std::string ARTIFACT_SOURCE = "InterestingFiles";
+
+    // The file name of the framework's SQLite image database in the output folder.
+    const std::string IMAGE_DATABASE_FILE_NAME = "image.db";
+
+    // The maximum number of bytes read from the start of a file to match content signatures.
+    const size_t MAX_SIGNATURE_HEADER_LENGTH = 65536;
+
+    // The extensions a double extension condition looks for when its element omits them: the extensions of documents 
+    // and media that an executable pretends to be, and the extensions of executables and scripts.
+    const char *DEFAULT_INNER_EXTENSIONS = "pdf,doc,docx,xls,xlsx,ppt,pptx,rtf,txt,csv,jpg,jpeg,png,gif,bmp,mp3,mp4,avi,zip";
+    const char *DEFAULT_OUTER_EXTENSIONS = "exe,scr,com,pif,bat,cmd,vbs,vbe,js,jse,wsf,hta,jar,msi,lnk";
+
+    // The thresholds of a random name condition when its element omits them. Ordinary words average about 3.5 bigram 
+    // bits and random letters about 7.
+    const unsigned int DEFAULT_RANDOM_NAME_MIN_LENGTH = 8;
+    const double DEFAULT_RANDOM_NAME_MIN_ENTROPY = 2.5;
+    const double DEFAULT_RANDOM_NAME_MIN_BIGRAM_BITS = 5.5;
+
+    // The file timestamps a WITHIN element can compare, named by the values of its timestamp attribute. Creation time
+    // is the default.
+    enum FileTimestamp { CREATED_TIME, MODIFIED_TIME, ACCESSED_TIME, CHANGED_TIME, FILE_TIMESTAMP_COUNT };
+    const char *FILE_TIMESTAMP_VALUES[FILE_TIMESTAMP_COUNT] = { "crtime", "mtime", "atime", "ctime" };
+
+    // The signatures at the start of executables: DOS and PE, ELF, and 32 and 64 bit Mach-O in both byte orders.
+    const char *EXECUTABLE_SIGNATURES[] = { "4D5A", "7F454C46", "FEEDFACE", "FEEDFACF", "CEFAEDFE", "CFFAEDFE" };
+
+    // The metrics collected by report() are written to these files in the module output folder.
+    const std::string METRICS_JSON_FILE_NAME = "metrics.json";
+    const std::string METRICS_PROMETHEUS_FILE_NAME = "metrics.prom";
+
+    // The number of conditions listed in the metrics summary in the log.
+    const size_t METRICS_SUMMARY_CONDITION_COUNT = 10;
+
+    // The number of file records retrieved from the image database at a time when scanning files.
+    const int FILE_RECORD_BATCH_SIZE = 10000;
+
+    // The number of file ids listed in each query that looks up the parent directories or the files of directories, or
+    // where the content of files starts in the image.
+    const size_t FILE_ID_BATCH_SIZE = 1000;
+
+    // The planner estimates how many files satisfy each condition from file records sampled at this many places 
+    // spread over the files table, this many records at each place.
+    const int PLANNER_SAMPLE_COUNT = 32;
+    const int PLANNER_SAMPLE_SIZE = 64;
+
+    // Rough relative costs of the work done by a search, used by the planner. The matcher microbenchmark in the 
+    // bench folder compares the costs of conditions evaluated by the image database and in the scan.
+    const double QUERY_COST = 1000.0;           // Preparing and running a query.
+    const double TABLE_ROW_COST = 1.0;          // Visiting a row of the files table in a query.
+    const double SQL_CONDITION_COST = 1.0;      // Evaluating a name condition for a row in a query.
+    const double FILE_ID_COST = 0.5;            // Returning a file id from a query.
+    const double INDEX_LOOKUP_COST = 2.0;       // Looking up a file in the file name index.
+    const double FILE_RECORD_COST = 10.0;       // Returning a file record from a query and holding it in the scan.
+    const double SCAN_CONDITION_COST = 0.25;    // Evaluating a name condition for a file record in the scan.
+    const double MATCH_FUNCTION_COST = 0.5;     // Calling the match function for a row of the files table in a query.
+
+    // The SQL function that evaluates the scan conditions inside the SQLite image database, and the query that runs the
+    // scan with it. The function is passed the columns of the file record that the scan conditions use, in the order
+    // that readFileRecord() expects, and returns a bitmask of the interesting file sets that have a scan condition that 
+    // the file satisfies, or NULL if there are none.
+    const char *MATCH_FUNCTION_NAME = "ifm_match";
+    const int MATCH_FUNCTION_ARGUMENT_COUNT = 16;
+    const char *MATCH_FUNCTION_QUERY = "SELECT f.file_id FROM files f LEFT OUTER JOIN file_hashes h ON f.file_id = h.file_id "
+        "WHERE ifm_match(f.file_id, f.type_id, f.name, f.par_file_id, f.dir_type, f.meta_type, f.size, f.ctime, f.crtime, "
+        "f.atime, f.mtime, f.full_path, h.md5, h.sha1, h.sha2_256, h.sha2_512) IS NOT NULL ORDER BY f.file_id";
 
+    // Finds where the content of each of a list of files starts in the image, from the first block run of the file.
+    const char *IMAGE_OFFSETS_QUERY_PREFIX = "SELECT b.file_id, MIN(b.seq), b.blk_start * i.block_size + i.img_byte_offset "
+        "FROM fs_blocks b JOIN fs_info i ON i.fs_id = b.fs_id WHERE b.file_id IN (";
+    const char *IMAGE_OFFSETS_QUERY_SUFFIX = ") GROUP BY b.file_id ORDER BY b.file_id";
+
+    // The initialization arguments, or the path of the default configuration file, cleared if initialization failed.
     std::string configFilePath;
 
-    /** 
-     * An interesting files set is defined by a set name, a set description, 
-     * and one or more SQL WHERE clauses that specify what files belong to the
-     * set.
+    // The path of the configuration file being compiled, which paths in the file are relative to.
+    std::string packFilePath;
+
+    // The names of the interesting files sets and rule packs compiled so far, which must be unique since a save 
+    // interesting files module may use them as folder names.
+    std::set<std::string> fileSetNames;
+    std::set<std::string> packNames;
+
+    /**
+     * The regular expressions of all of the regular expression conditions 
+     * are compiled into two regex sets, one for file names and one for file 
+     * paths, so that each file name and path is matched only once no matter 
+     * how many regular expression conditions there are.
      */
-    struct InterestingFilesSet
+    RegexSet nameRegexes;
+    RegexSet pathRegexes;
+
+    /**
+     * The target names of all of the fuzzy name conditions are stored in a 
+     * single fuzzy name set so that each file name is compared with only the
+     * targets of about its length, once no matter how many fuzzy name 
+     * conditions there are.
+     */
+    FuzzyNameSet fuzzyNames;
+
+    /**
+     * The content signatures of all of the signature conditions are stored in
+     * a single table so that each file header is read and matched only once.
+     */
+    SignatureTable signatures;
+
+    /**
+     * The directories of the image, loaded before the scan if any scan 
+     * condition needs to know the ancestors of files.
+     */
+    DirectoryTree directories;
+
+    /**
+     * The timestamps of the files of the image, loaded after the scan for 
+     * each kind of timestamp that some WITHIN element compares.
+     */
+    TimestampIndex timestampIndexes[FILE_TIMESTAMP_COUNT];
+
+    /**
+     * Path filters are shared by all of the conditions that use the same 
+     * path filter, so that each path filter is evaluated once per directory.
+     * The path filters are keyed by folded path filter.
+     */
+    std::map<std::string, Poco::SharedPtr<PathFilter> > pathFilters;
+
+    /**
+     * If the configuration file asks for it, literal file name and extension
+     * conditions are looked up in a file name index kept in the image 
+     * database, which is brought up to date before each search. The file 
+     * name index may also have a trigram index, in which file name patterns
+     * with literals of three or more characters are looked up.
+     */
+    bool useFileNameIndex = false;
+    bool useTrigramIndex = false;
+    FileNameIndex fileNameIndex;
+
+    /**
+     * If the configuration file asks for it, the scan is run inside the 
+     * SQLite image database, which calls the match function registered by 
+     * the module to evaluate the scan conditions for each file and only 
+     * returns the records of the files that satisfy some scan condition.
+     */
+    bool useMatchFunction = false;
+
+    /**
+     * If the configuration file asks for it, the hits are collected in a 
+     * temporary table of the SQLite image database and posted to the 
+     * blackboard in bulk, and the pushed down conditions add their hits to
+     * the table themselves.
+     */
+    bool useBulkPosting = false;
+
+    /**
+     * If the configuration file asks for it, the hits of each set are cached
+     * in the SQLite image database, and a later search of the unchanged 
+     * image replays the hits of the unchanged sets rather than searching 
+     * for them again.
+     */
+    bool useResultCache = false;
+
+    /**
+     * If the configuration file names one, the signatures matched by the 
+     * content of each file whose content hash is known are kept in a 
+     * content cache database at this path, which may be shared across 
+     * cases, so that files with content already matched are not read again.
+     */
+    std::string contentCachePath;
+
+    /**
+     * Optional file type (file, directory) and path substring filters that 
+     * qualify a file search condition.
+     */
+    struct FileFilter
     {
-        InterestingFilesSet() : name(""), description("") {}
-        std::string name;
-        std::string description;
-        vector<std::string> conditions;
+        FileFilter() : hasTypeFilter(false), metaType(TSK_FS_META_TYPE_UNDEF) {}
+
+        /** Determines whether the path filter is evaluated using the directory tree. */
+        bool usesDirectoryTree() const
+        {
+            return !pathMatcher.isNull() && pathMatcher->usesDirectoryTree();
+        }
+
+        std::string pathFilter;
+        Poco::SharedPtr<PathFilter> pathMatcher;
+        bool hasTypeFilter;
+        TSK_FS_META_TYPE_ENUM metaType;
     };
 
     /**
-     * Interesting file set definitions are read from a configuration file in 
-     * the initialize() module API and the file queries are executed in the 
-     * report() module API. The following vector stores the search objects 
-     * between calls to intitialize() and report(). 
+     * A file record that is being scanned, along with values derived from 
+     * the record that are computed at most once no matter how many scan 
+     * conditions use them.
      */
-    std::vector<InterestingFilesSet> fileSets;
+    class ScannedFile
+    {
+    public:
+        explicit ScannedFile(const TskFileRecord &fileRecord) : 
+            record(fileRecord), m_nameFolded(false), m_extensionFolded(false), m_pathFolded(false), m_nameRegexesMatched(false), m_pathRegexesMatched(false),
+            m_fuzzyNamesMatched(false), m_hasNameSkeleton(false), m_hasNameRandomness(false)
+        {
+        }
 
-    /** 
-     * Looks for glob wildcards in a string.
-     *
-     * @param stringToCheck The string to be checked.
-     * @return True if any glob wildcards where found.
+        const TskFileRecord &record;
+
+        /** Gets the file name folded to upper case. */
+        const std::string &foldedName() const
+        {
+            if (!m_nameFolded)
+            {
+                m_foldedName = Poco::toUpper(record.name);
+                m_nameFolded = true;
+            }
+            return m_foldedName;
+        }
+
+        /** Gets the extension of the file name, from its last '.', folded to upper case. */
+        const std::string &foldedExtension() const
+        {
+            if (!m_extensionFolded)
+            {
+                m_foldedExtension = FileNameIndex::getExtension(foldedName());
+                m_extensionFolded = true;
+            }
+            return m_foldedExtension;
+        }
+
+        /** Gets the skeleton of the file name, in which characters that look alike are the same. */
+        const std::string &nameSkeleton() const
+        {
+            if (!m_hasNameSkeleton)
+            {
+                m_nameSkeleton = getNameSkeleton(record.name);
+                m_hasNameSkeleton = true;
+            }
+            return m_nameSkeleton;
+        }
+
+        /** Gets the measures of how random the file name, without its extension, looks. */
+        const NameRandomness &nameRandomness() const
+        {
+            if (!m_hasNameRandomness)
+            {
+                const std::string &name = foldedName();
+                const size_t extensionLength = foldedExtension().size();
+                m_nameRandomness = NameRandomness(extensionLength < name.size() ? name.substr(0, name.size() - extensionLength) : name);
+                m_hasNameRandomness = true;
+            }
+            return m_nameRandomness;
+        }
+
+        /** Gets the full path of the file folded to upper case. */
+        const std::string &foldedPath() const
+        {
+            if (!m_pathFolded)
+            {
+                m_foldedPath = Poco::toUpper(record.fullPath);
+                m_pathFolded = true;
+            }
+            return m_foldedPath;
+        }
+
+        /** Determines whether the file name matches a regular expression in the name regex set. */
+        bool matchesNameRegex(size_t expressionId) const
+        {
+            if (!m_nameRegexesMatched)
+            {
+                nameRegexes.match(foldedName(), m_nameRegexMatches);
+                m_nameRegexesMatched = true;
+            }
+            return m_nameRegexMatches[expressionId];
+        }
+
+        /** Determines whether the file path matches a regular expression in the path regex set. */
+        bool matchesPathRegex(size_t expressionId) const
+        {
+            if (!m_pathRegexesMatched)
+            {
+                pathRegexes.match(foldedPath(), m_pathRegexMatches);
+                m_pathRegexesMatched = true;
+            }
+            return m_pathRegexMatches[expressionId];
+        }
+
+        /** Determines whether the file name matches a target name in the fuzzy name set. */
+        bool matchesFuzzyName(size_t targetId) const
+        {
+            if (!m_fuzzyNamesMatched)
+            {
+                fuzzyNames.match(foldedName(), m_fuzzyNameMatches);
+                m_fuzzyNamesMatched = true;
+            }
+            return m_fuzzyNameMatches[targetId];
+        }
+
+        /** Determines whether the file passes the type and path filters of a condition. */
+        bool passes(const FileFilter &filter) const
+        {
+            if (filter.hasTypeFilter && record.metaType != filter.metaType)
+            {
+                return false;
+            }
+            if (filter.pathMatcher.isNull())
+            {
+                return true;
+            }
+
+            // The path filter result of the parent directory applies to all of the files in it.
+            const size_t parent = filter.usesDirectoryTree() ? directories.find(record.parentFileId) : DirectoryTree::NO_DIRECTORY;
+            if (parent != DirectoryTree::NO_DIRECTORY)
+            {
+                return filter.pathMatcher->matches(directories, parent, foldedName());
+            }
+            return filter.pathMatcher->matchesPath(foldedPath());
+        }
+
+    private:
+        ScannedFile(const ScannedFile &);
+        ScannedFile &operator=(const ScannedFile &);
+
+        mutable bool m_nameFolded;
+        mutable std::string m_foldedName;
+        mutable bool m_extensionFolded;
+        mutable std::string m_foldedExtension;
+        mutable bool m_pathFolded;
+        mutable std::string m_foldedPath;
+        mutable bool m_nameRegexesMatched;
+        mutable std::vector<bool> m_nameRegexMatches;
+        mutable bool m_pathRegexesMatched;
+        mutable std::vector<bool> m_pathRegexMatches;
+        mutable bool m_fuzzyNamesMatched;
+        mutable std::vector<bool> m_fuzzyNameMatches;
+        mutable bool m_hasNameSkeleton;
+        mutable std::string m_nameSkeleton;
+        mutable bool m_hasNameRandomness;
+        mutable NameRandomness m_nameRandomness;
+    };
+
+    /**
+     * A scan condition is evaluated in memory against file records read from
+     * the image database, rather than being compiled into an image database
+     * query. All of the scan conditions of all of the interesting file sets 
+     * are evaluated in a single scan of the file records. Conditions that the
+     * image database can evaluate on its own may instead be pushed down to 
+     * the image database as queries of their own, if the planner expects that
+     * to be cheaper.
      */
-    bool hasGlobWildcards(const std::string &stringToCheck)
+    class ScanCondition
     {
-        return stringToCheck.find("*") != std::string::npos;
-    }
+    public:
+        virtual ~ScanCondition() {}
+
+        /**
+         * Gets an SQL expression that selects exactly the files that satisfy
+         * the condition, so that the condition can be pushed down to the image
+         * database. The files are selected from the files table, without an
+         * alias.
+         *
+         * @return The expression, or the empty string if the condition can 
+         * only be evaluated in the scan.
+         */
+        virtual std::string getSearchCondition() const
+        {
+            return "";
+        }
+
+        /**
+         * Gets an SQL expression that selects the files that could satisfy the
+         * condition, so that files that cannot are not scanned. The file records
+         * are selected from the files table (alias f) joined with the file_hashes 
+         * table (alias fh).
+         *
+         * @return The expression, or the empty string if any file could satisfy 
+         * the condition.
+         */
+        virtual std::string getCandidateFilesCondition() const
+        {
+            return "";
+        }
+
+        /**
+         * Evaluates the condition for a file.
+         *
+         * @param file The file being scanned.
+         * @return True if the file satisfies the condition.
+         */
+        virtual bool matches(const ScannedFile &file) const = 0;
+
+        /**
+         * Determines whether the condition examines file content. Content 
+         * conditions are evaluated in two steps: matches() is evaluated during 
+         * the scan using the file record only, and matchesContent() is evaluated
+         * after the scan for the files that satisfy matches(), with reads of file
+         * content ordered by the location of the content in the image.
+         */
+        virtual bool isContentCondition() const
+        {
+            return false;
+        }
+
+        /**
+         * Evaluates the content part of a content condition for a file.
+         *
+         * @param signatureMatches The signatures in the signature table that 
+         * match the header of the file.
+         * @return True if the file satisfies the condition.
+         */
+        virtual bool matchesContent(const std::vector<bool> & /*signatureMatches*/) const
+        {
+            return true;
+        }
+
+        /**
+         * Determines whether the condition uses the directory tree, which is 
+         * only loaded if some condition uses it.
+         */
+        virtual bool usesDirectoryTree() const
+        {
+            return false;
+        }
+
+        /**
+         * Determines whether the condition can be looked up in the file name 
+         * index, which is only brought up to date if some condition can.
+         */
+        virtual bool canUseFileNameIndex() const
+        {
+            return false;
+        }
+
+        /**
+         * Gets the number of index entries visited by the query of the 
+         * condition when it is pushed down, if the query is a lookup in the 
+         * file name index.
+         *
+         * @param estimatedFileCount The estimated number of files that 
+         * satisfy the condition.
+         * @return The number of index entries, or a negative number if the 
+         * query is not a lookup in the file name index.
+         */
+        virtual double getIndexLookupRows(double /*estimatedFileCount*/) const
+        {
+            return -1.0;
+        }
+
+        /**
+         * Gets a description of the version of the data outside the 
+         * configuration file that the condition depends on, such as a hash 
+         * list, so that cached hits of the condition are not replayed once
+         * the data changes.
+         *
+         * @return The description, or the empty string if the condition 
+         * depends only on its definition.
+         */
+        virtual std::string getDataVersion() const
+        {
+            return "";
+        }
+    };
+
+    /**
+     * A hash set condition specifies that files whose hash, as computed by a 
+     * hashing module, is in a hash set database belong to an interesting 
+     * files set.
+     */
+    class HashSetCondition : public ScanCondition
+    {
+    public:
+        HashSetCondition(HashSetDatabase::HashType hashType, Poco::SharedPtr<HashSetDatabase> database, const std::string &dataVersion) : 
+            m_hashType(hashType), m_database(database), m_dataVersion(dataVersion)
+        {
+        }
+
+        virtual std::string getCandidateFilesCondition() const
+        {
+            switch (m_hashType)
+            {
+            case HashSetDatabase::SHA1:
+                return "fh.sha1 <> ''";
+            case HashSetDatabase::SHA2_256:
+                return "fh.sha2_256 <> ''";
+            default:
+                return "fh.md5 <> ''";
+            }
+        }
+
+        virtual bool matches(const ScannedFile &file) const
+        {
+            const std::string &hash = getFileHash(file.record);
+            return !hash.empty() && m_database->contains(hash);
+        }
+
+        virtual std::string getDataVersion() const
+        {
+            return m_dataVersion;
+        }
+
+    private:
+        const std::string &getFileHash(const TskFileRecord &fileRecord) const
+        {
+            switch (m_hashType)
+            {
+            case HashSetDatabase::SHA1:
+                return fileRecord.sha1;
+            case HashSetDatabase::SHA2_256:
+                return fileRecord.sha2_256;
+            default:
+                return fileRecord.md5;
+            }
+        }
+
+        HashSetDatabase::HashType m_hashType;
+        Poco::SharedPtr<HashSetDatabase> m_database;
+        std::string m_dataVersion;
+    };
 
-    std::string EscapeWildcard(const std::string &s, char escChar) 
+    /**
+     * Gets the extension of a file name that has as many '.'s as an extension
+     * pattern: the name from the '.' that many '.'s before its last one, or 
+     * the empty string if it has too few.
+     *
+     * @param name The file name.
+     * @param dotCount The number of '.'s in the extension.
+     */
+    std::string getExtension(const std::string &name, size_t dotCount)
     {
-        std::string newS;
-        for (size_t i = 0; i < s.length(); i++) {
-            char c = s[i];
-            if (c == '_' || c == '%' || c == escChar) {
-                newS += escChar;
+        size_t dot = name.size();
+        for (size_t i = 0; i < dotCount; ++i)
+        {
+            dot = dot != 0 ? name.rfind('.', dot - 1) : std::string::npos;
+            if (dot == std::string::npos)
+            {
+                return "";
             }
-            newS += c;
         }
-        return newS;
+        return name.substr(dot);
     }
 
-    /** 
-     * Converts glob wildcards in a string to SQL wildcards.
+    /**
+     * A file name or extension condition. The image database selects the 
+     * files with matching names and types, so a condition without a path 
+     * filter can be pushed down to the image database. Path filters are 
+     * evaluated once per directory using the directory tree, so when a 
+     * condition has a path filter the rest of the condition is always 
+     * evaluated in the scan. Conditions on literal names and extensions are
+     * looked up in the file name index when it is ready, and name patterns 
+     * in the trigram index when it is ready.
+     *
+     * An extension pattern is matched against the extension of the file 
+     * name, which starts at its last '.', rather than against the whole 
+     * name, so that ".htm*" does not match "file.htm.txt". A pattern with 
+     * more '.'s, such as ".tar.gz", is matched against as many of the last
+     * parts of the name. The image database cannot work out such extensions
+     * for patterns with wildcards, so those are always evaluated in the scan.
      *
-     * @param stringToChange The string to be changed.
+     * A condition may instead match the skeleton of its pattern against the 
+     * skeletons of file names, so that names spelled with characters that 
+     * look like those of the pattern match it. The image database cannot 
+     * work out skeletons, so such a condition is always evaluated in the 
+     * scan.
+     */
+    class FileNameCondition : public ScanCondition
+    {
+    public:
+        /**
+         * @param nameCondition An SQL expression that selects files by name,
+         * or the empty string if the image database cannot select them.
+         * @param indexLookup A file name index query equivalent to the SQL 
+         * expression, or the empty string if there is none, without the type 
+         * filter.
+         * @param namePattern A glob pattern for the name, or for the 
+         * extension if the condition is an extension condition.
+         * @param filter The path and type filters of the condition.
+         * @param isExtensionCondition Whether the pattern is an extension 
+         * pattern.
+         * @param matchesSkeleton Whether the skeleton of the pattern is 
+         * matched against the skeletons of file names.
+         */
+        FileNameCondition(const std::string &nameCondition, const std::string &indexLookup, const std::string &namePattern, const FileFilter &filter, 
+            bool isExtensionCondition, bool matchesSkeleton) : 
+            m_nameCondition(nameCondition), m_indexLookup(indexLookup), m_namePattern(matchesSkeleton ? getNameSkeleton(namePattern) : Poco::toUpper(namePattern)), 
+            m_filter(filter), m_isExtensionCondition(isExtensionCondition), m_extensionDotCount(std::count(m_namePattern.begin(), m_namePattern.end(), '.')), 
+            m_matchesSkeleton(matchesSkeleton)
+        {
+        }
+
+        virtual std::string getSearchCondition() const
+        {
+            if (!m_filter.pathMatcher.isNull())
+            {
+                return "";
+            }
+            const std::string indexLookup = getIndexLookup();
+            return !indexLookup.empty() ? "file_id IN (" + indexLookup + ")" : m_nameCondition;
+        }
+
+        virtual std::string getCandidateFilesCondition() const
+        {
+            const std::string indexLookup = getIndexLookup();
+            if (!indexLookup.empty())
+            {
+                return "f.file_id IN (" + indexLookup + ")";
+            }
+            return !m_nameCondition.empty() ? "(" + m_nameCondition + ")" : "";
+        }
+
+        virtual bool matches(const ScannedFile &file) const
+        {
+            const std::string &name = m_matchesSkeleton ? file.nameSkeleton() : file.foldedName();
+            if (!m_isExtensionCondition)
+            {
+                return matchesGlob(m_namePattern, name) && file.passes(m_filter);
+            }
+            const std::string &extension = m_extensionDotCount == 1 && !m_matchesSkeleton ? file.foldedExtension() : getExtension(name, m_extensionDotCount);
+            return matchesGlob(m_namePattern, extension) && file.passes(m_filter);
+        }
+
+        virtual bool usesDirectoryTree() const
+        {
+            return m_filter.usesDirectoryTree();
+        }
+
+        virtual bool canUseFileNameIndex() const
+        {
+            return !m_indexLookup.empty() || (useTrigramIndex && !m_isExtensionCondition && !m_matchesSkeleton && FileNameIndex::hasTrigrams(m_namePattern));
+        }
+
+        virtual double getIndexLookupRows(double estimatedFileCount) const
+        {
+            if (getIndexLookup().empty())
+            {
+                return -1.0;
+            }
+            return !m_indexLookup.empty() ? estimatedFileCount : fileNameIndex.getPatternLookupRows(m_namePattern);
+        }
+
+    private:
+        /**
+         * Gets a file name index query that selects the files that satisfy the
+         * condition, or the empty string if the index cannot be used.
+         */
+        std::string getIndexLookup() const
+        {
+            if (!fileNameIndex.isReady())
+            {
+                return "";
+            }
+
+            std::stringstream indexLookup;
+            indexLookup << (!m_indexLookup.empty() ? m_indexLookup : !m_isExtensionCondition && !m_matchesSkeleton ? fileNameIndex.getPatternLookup(m_namePattern) : "");
+            if (indexLookup.str().empty())
+            {
+                return "";
+            }
+            if (m_filter.hasTypeFilter)
+            {
+                indexLookup << " AND meta_type = " << m_filter.metaType;
+            }
+            return indexLookup.str();
+        }
+
+        std::string m_nameCondition;
+        std::string m_indexLookup;
+        std::string m_namePattern;
+        FileFilter m_filter;
+        bool m_isExtensionCondition;
+        size_t m_extensionDotCount;
+        bool m_matchesSkeleton;
+    };
+
+    /**
+     * A regular expression condition specifies that files whose name or path
+     * matches a regular expression belong to an interesting files set.
+     */
+    class RegexCondition : public ScanCondition
+    {
+    public:
+        RegexCondition(bool matchPath, size_t expressionId, const FileFilter &filter) : 
+            m_matchPath(matchPath), m_expressionId(expressionId), m_filter(filter)
+        {
+        }
+
+        virtual bool matches(const ScannedFile &file) const
+        {
+            return (m_matchPath ? file.matchesPathRegex(m_expressionId) : file.matchesNameRegex(m_expressionId)) && file.passes(m_filter);
+        }
+
+        virtual bool usesDirectoryTree() const
+        {
+            return m_filter.usesDirectoryTree();
+        }
+
+    private:
+        bool m_matchPath;
+        size_t m_expressionId;
+        FileFilter m_filter;
+    };
+
+    /**
+     * A signature condition specifies that files with a content signature 
+     * (magic bytes) at a given offset belong to an interesting files set.
      */
-    void convertGlobWildcardsToSQLWildcards(std::string &stringToChange)
+    class SignatureCondition : public ScanCondition
     {
-        // Escape all SQL wildcards chars and escape chars that happen to be in the input string.
-        stringToChange = EscapeWildcard(stringToChange, '#');
+    public:
+        SignatureCondition(size_t signatureId, size_t signatureEnd, const FileFilter &filter) : 
+            m_signatureId(signatureId), m_signatureEnd(signatureEnd), m_filter(filter)
+        {
+        }
 
-        // Convert the glob wildcard chars to SQL wildcard chars.
-        Poco::replaceInPlace(stringToChange, "*", "%");
+        virtual std::string getCandidateFilesCondition() const
+        {
+            // Only regular files large enough to contain the signature need to be considered.
+            std::stringstream condition;
+            condition << "(f.meta_type = " << TSK_FS_META_TYPE_REG << " AND f.size >= " << m_signatureEnd << ")";
+            return condition.str();
+        }
+
+        virtual bool matches(const ScannedFile &file) const
+        {
+            return file.record.metaType == TSK_FS_META_TYPE_REG && file.record.size >= static_cast<TSK_OFF_T>(m_signatureEnd) && file.passes(m_filter);
+        }
+
+        virtual bool isContentCondition() const
+        {
+            return true;
+        }
+
+        virtual bool matchesContent(const std::vector<bool> &signatureMatches) const
+        {
+            return signatureMatches[m_signatureId];
+        }
+
+        virtual bool usesDirectoryTree() const
+        {
+            return m_filter.usesDirectoryTree();
+        }
+
+    private:
+        size_t m_signatureId;
+        size_t m_signatureEnd;
+        FileFilter m_filter;
+    };
+
+    /**
+     * Gets an SQL expression that selects the files whose names end with any
+     * of a set of extensions. The files are selected from the files table 
+     * (alias f).
+     *
+     * @param foldedExtensions The extensions, including their '.', folded to
+     * upper case.
+     */
+    std::string getExtensionsCondition(const std::set<std::string> &foldedExtensions)
+    {
+        std::ostringstream condition;
+        if (fileNameIndex.isReady())
+        {
+            condition << "f.file_id IN (SELECT file_id FROM ifm_file_names WHERE folded_extension IN (";
+            for (std::set<std::string>::const_iterator extension = foldedExtensions.begin(); extension != foldedExtensions.end(); ++extension)
+            {
+                condition << (extension != foldedExtensions.begin() ? ", " : "") << TskServices::Instance().getImgDB().quote(*extension);
+            }
+            condition << "))";
+            return condition.str();
+        }
+
+        condition << "(";
+        for (std::set<std::string>::const_iterator extension = foldedExtensions.begin(); extension != foldedExtensions.end(); ++extension)
+        {
+            std::string pattern("%" + *extension);
+            convertGlobWildcardsToSQLWildcards(pattern);
+            condition << (extension != foldedExtensions.begin() ? " OR " : "") << "UPPER(f.name) LIKE " << TskServices::Instance().getImgDB().quote(pattern) << " ESCAPE '#'";
+        }
+        condition << ")";
+        return condition.str();
+    }
+
+    /**
+     * A double extension condition specifies that files whose names end with
+     * an executable (outer) extension preceded by a document (inner) 
+     * extension, such as "invoice.pdf.exe", belong to an interesting files 
+     * set. Spaces padding the inner extension, as in "invoice.pdf    .exe", 
+     * are ignored. The last two extensions of each name are found once, and
+     * each is looked up in its own set of extensions, so a condition costs 
+     * the same no matter how many extensions it lists.
+     */
+    class DoubleExtensionCondition : public ScanCondition
+    {
+    public:
+        DoubleExtensionCondition(const std::set<std::string> &innerExtensions, const std::set<std::string> &outerExtensions, const FileFilter &filter) : 
+            m_innerExtensions(innerExtensions), m_outerExtensions(outerExtensions), m_filter(filter)
+        {
+        }
+
+        virtual std::string getCandidateFilesCondition() const
+        {
+            return getExtensionsCondition(m_outerExtensions);
+        }
+
+        virtual bool matches(const ScannedFile &file) const
+        {
+            const std::string &name = file.foldedName();
+            const std::string &outerExtension = file.foldedExtension();
+            if (outerExtension.empty() || outerExtension.size() == name.size() || m_outerExtensions.count(outerExtension) == 0)
+            {
+                return false;
+            }
+
+            // The inner extension must follow a non-empty stem.
+            const size_t outerDot = name.size() - outerExtension.size();
+            const size_t innerDot = name.rfind('.', outerDot - 1);
+            if (innerDot == std::string::npos || innerDot == 0)
+            {
+                return false;
+            }
+            const size_t innerEnd = name.find_last_not_of(' ', outerDot - 1) + 1;
+            return m_innerExtensions.count(name.substr(innerDot, innerEnd - innerDot)) != 0 && file.passes(m_filter);
+        }
+
+        virtual bool usesDirectoryTree() const
+        {
+            return m_filter.usesDirectoryTree();
+        }
+
+    private:
+        std::set<std::string> m_innerExtensions;
+        std::set<std::string> m_outerExtensions;
+        FileFilter m_filter;
+    };
+
+    /**
+     * An extension mismatch condition specifies that regular files whose 
+     * names end with a document extension but whose content starts with the
+     * signature of an executable belong to an interesting files set. The 
+     * signatures are matched with those of the signature conditions.
+     */
+    class ExtensionMismatchCondition : public ScanCondition
+    {
+    public:
+        ExtensionMismatchCondition(const std::set<std::string> &documentExtensions, const std::vector<size_t> &signatureIds, size_t signatureEnd, const FileFilter &filter) : 
+            m_documentExtensions(documentExtensions), m_signatureIds(signatureIds), m_signatureEnd(signatureEnd), m_filter(filter)
+        {
+        }
+
+        virtual std::string getCandidateFilesCondition() const
+        {
+            std::stringstream condition;
+            condition << "(f.meta_type = " << TSK_FS_META_TYPE_REG << " AND f.size >= " << m_signatureEnd << " AND " << getExtensionsCondition(m_documentExtensions) << ")";
+            return condition.str();
+        }
+
+        virtual bool matches(const ScannedFile &file) const
+        {
+            return file.record.metaType == TSK_FS_META_TYPE_REG && file.record.size >= static_cast<TSK_OFF_T>(m_signatureEnd) && 
+                m_documentExtensions.count(file.foldedExtension()) != 0 && file.passes(m_filter);
+        }
+
+        virtual bool isContentCondition() const
+        {
+            return true;
+        }
+
+        virtual bool matchesContent(const std::vector<bool> &signatureMatches) const
+        {
+            for (std::vector<size_t>::const_iterator signatureId = m_signatureIds.begin(); signatureId != m_signatureIds.end(); ++signatureId)
+            {
+                if (signatureMatches[*signatureId])
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        virtual bool usesDirectoryTree() const
+        {
+            return m_filter.usesDirectoryTree();
+        }
+
+    private:
+        std::set<std::string> m_documentExtensions;
+        std::vector<size_t> m_signatureIds;
+        size_t m_signatureEnd;
+        FileFilter m_filter;
+    };
+
+    /**
+     * A fuzzy name condition specifies that files whose names are within a 
+     * small edit distance of a target name, but not equal to it, belong to 
+     * an interesting files set. Only the names whose lengths are within the
+     * distance of the target's length are read from the image database.
+     */
+    class FuzzyNameCondition : public ScanCondition
+    {
+    public:
+        FuzzyNameCondition(size_t targetId, size_t targetLength, size_t maxDistance, const FileFilter &filter) : 
+            m_targetId(targetId), m_targetLength(targetLength), m_maxDistance(maxDistance), m_filter(filter)
+        {
+        }
+
+        virtual std::string getCandidateFilesCondition() const
+        {
+            // The target length is in bytes, as the image database stores names.
+            std::stringstream condition;
+            condition << "(LENGTH(CAST(f.name AS BLOB)) BETWEEN " << m_targetLength - m_maxDistance << " AND " << m_targetLength + m_maxDistance << ")";
+            return condition.str();
+        }
+
+        virtual bool matches(const ScannedFile &file) const
+        {
+            return file.matchesFuzzyName(m_targetId) && file.passes(m_filter);
+        }
+
+        virtual bool usesDirectoryTree() const
+        {
+            return m_filter.usesDirectoryTree();
+        }
+
+    private:
+        size_t m_targetId;
+        size_t m_targetLength;
+        size_t m_maxDistance;
+        FileFilter m_filter;
+    };
+
+    /**
+     * A random name condition specifies that files whose names, without 
+     * their extensions, look random, such as "a8f3kq2z.dll", belong to an 
+     * interesting files set. A name looks random if it is long enough, the 
+     * entropy of its characters is high enough, and its pairs of letters 
+     * and digits are unlikely enough in ordinary words. The measures of each
+     * name are worked out once, no matter how many random name conditions 
+     * there are.
+     */
+    class RandomNameCondition : public ScanCondition
+    {
+    public:
+        RandomNameCondition(size_t minLength, double minEntropy, double minBigramBits, const FileFilter &filter) : 
+            m_minLength(minLength), m_minEntropy(minEntropy), m_minBigramBits(minBigramBits), m_filter(filter)
+        {
+        }
+
+        virtual std::string getCandidateFilesCondition() const
+        {
+            std::stringstream condition;
+            condition << "(LENGTH(CAST(f.name AS BLOB)) >= " << m_minLength << ")";
+            return condition.str();
+        }
+
+        virtual bool matches(const ScannedFile &file) const
+        {
+            if (file.record.name.size() < m_minLength)
+            {
+                return false;
+            }
+            const NameRandomness &randomness = file.nameRandomness();
+            return randomness.length >= m_minLength && randomness.entropy >= m_minEntropy && randomness.bigramBits >= m_minBigramBits && file.passes(m_filter);
+        }
+
+        virtual bool usesDirectoryTree() const
+        {
+            return m_filter.usesDirectoryTree();
+        }
+
+    private:
+        size_t m_minLength;
+        double m_minEntropy;
+        double m_minBigramBits;
+        FileFilter m_filter;
+    };
+
+    /**
+     * A subtree condition specifies that the files and directories anywhere 
+     * below a directory with a name that matches a glob pattern belong to an
+     * interesting files set. 
+     *
+     * Whether a directory is in a matching subtree is determined once, by 
+     * walking up its ancestors until a matching directory or a directory whose
+     * membership is already known is found, and is recorded for every 
+     * directory on the way. After that, checking a file is a lookup of its 
+     * parent directory.
+     */
+    class SubtreeCondition : public ScanCondition
+    {
+    public:
+        SubtreeCondition(const std::string &directoryNamePattern, const FileFilter &filter) : 
+            m_directoryNamePattern(Poco::toUpper(directoryNamePattern)), m_filter(filter)
+        {
+        }
+
+        virtual bool matches(const ScannedFile &file) const
+        {
+            const size_t parent = directories.find(file.record.parentFileId);
+            return parent != DirectoryTree::NO_DIRECTORY && isInSubtree(parent) && file.passes(m_filter);
+        }
+
+        virtual bool usesDirectoryTree() const
+        {
+            return true;
+        }
+
+    private:
+        enum Membership { UNKNOWN = -1, NOT_IN_SUBTREE = 0, IN_SUBTREE = 1 };
+
+        /**
+         * Determines whether a directory matches the pattern or is below a 
+         * directory that does.
+         */
+        bool isInSubtree(size_t directory) const
+        {
+            if (m_membership.size() != directories.size())
+            {
+                m_membership.assign(directories.size(), static_cast<signed char>(UNKNOWN));
+            }
+
+            signed char membership = NOT_IN_SUBTREE;
+            m_path.clear();
+            for (size_t ancestor = directory; ancestor != DirectoryTree::NO_DIRECTORY; ancestor = directories.getParent(ancestor))
+            {
+                if (m_membership[ancestor] != UNKNOWN)
+                {
+                    membership = m_membership[ancestor];
+                    break;
+                }
+
+                m_path.push_back(ancestor);
+                if (matchesGlob(m_directoryNamePattern, directories.getName(ancestor)))
+                {
+                    membership = IN_SUBTREE;
+                    break;
+                }
+
+                if (m_path.size() > directories.size())
+                {
+                    // The parent links of a damaged file system can form a cycle.
+                    break;
+                }
+            }
+
+            for (std::vector<size_t>::const_iterator pathDirectory = m_path.begin(); pathDirectory != m_path.end(); ++pathDirectory)
+            {
+                m_membership[*pathDirectory] = membership;
+            }
+            return membership == IN_SUBTREE;
+        }
+
+        std::string m_directoryNamePattern;
+        FileFilter m_filter;
+        mutable std::vector<signed char> m_membership;
+        mutable std::vector<size_t> m_path;
+    };
+
+    /**
+     * Performance measurements of a search condition, collected by report().
+     * Rows are the rows returned by the image database for an SQL condition,
+     * or the file records evaluated for a scan condition. Bytes allocated are
+     * the bytes of query results and queued content reads held for the 
+     * condition.
+     */
+    struct ConditionMetrics
+    {
+        explicit ConditionMetrics(const std::string &definition = "") : 
+            definition(definition), seconds(0.0), rows(0), hits(0), artifacts(0), bytesAllocated(0)
+        {
+        }
+
+        std::string definition;
+        double seconds;
+        uint64_t rows;
+        uint64_t hits;
+        uint64_t artifacts;
+        uint64_t bytesAllocated;
+    };
+
+    /**
+     * A node of the rule of an interesting files set that combines its 
+     * conditions with ALL, ANY, NOT and EXCLUDE elements. The nodes of a rule
+     * refer to their children by their indexes in the set's rule nodes. A 
+     * NOT node is always the child of an ALL node, which removes the files 
+     * that satisfy any of the NOT node's children from the files that 
+     * satisfy all of its other children.
+     *
+     * A SIBLINGS node selects the files in the directories of the files that
+     * satisfy any of its children, and a CONTAINS node selects the 
+     * directories that directly contain a file that satisfies each of its 
+     * children. A WITHIN node selects the files whose timestamp is within a
+     * number of seconds of the timestamp of a file that satisfies any of its
+     * children. The files these nodes select are posted as hits of the first
+     * condition below the node, which is its condition index.
+     */
+    struct RuleNode
+    {
+        enum Type { CONDITION, ALL, ANY, NOT, SIBLINGS, CONTAINS, WITHIN };
+
+        explicit RuleNode(Type type, size_t conditionIndex = 0) : 
+            type(type), conditionIndex(conditionIndex), timestamp(CREATED_TIME), seconds(0)
+        {
+        }
+
+        Type type;
+        size_t conditionIndex;
+        FileTimestamp timestamp;
+        int64_t seconds;
+        std::vector<size_t> children;
+    };
+
+    // The root of a rule is an ALL node. Its first child is an ANY node of the conditions and ALL, ANY and NOT elements 
+    // of the set, and its second child, if the set has EXCLUDE elements, is a NOT node of their contents.
+    const size_t RULE_ROOT_NODE = 0;
+    const size_t RULE_CONDITIONS_NODE = 1;
+
+    /** 
+     * An interesting files set is defined by a set name, a set description, 
+     * and one or more search conditions that specify what files belong to the
+     * set. The planner decides, before each search, which of the conditions 
+     * are pushed down to the image database.
+     *
+     * A file belongs to a set if it satisfies any of the set's conditions, 
+     * unless the set has a rule that combines the conditions differently.
+     * Every condition of a set is evaluated on its own, and the rule is then
+     * applied to the sets of files that satisfy each condition.
+     */
+    struct InterestingFilesSet
+    {
+        InterestingFilesSet() : name(""), description("") {}
+
+        bool hasRule() const { return !ruleNodes.empty(); }
+
+        std::string name;
+        std::string description;
+        std::string cacheKey;
+        vector<Poco::SharedPtr<ScanCondition> > scanConditions;
+        vector<ConditionMetrics> scanConditionMetrics;
+        vector<bool> isPushedDown;
+        vector<RuleNode> ruleNodes;
+    };
+
+    /**
+     * Interesting file set definitions are read from a configuration file in 
+     * the initialize() module API and the file queries are executed in the 
+     * report() module API. The following vector stores the search objects 
+     * between calls to intitialize() and report(). 
+     */
+    std::vector<InterestingFilesSet> fileSets;
+
+    /**
+     * Hash set databases are memory mapped once, no matter how many hash set
+     * conditions refer to them. The databases are keyed by database path.
+     */
+    std::map<std::string, Poco::SharedPtr<HashSetDatabase> > hashSetDatabases;
+
+    /**
+     * Parses an optional file type (file, directory) or path substring filter 
+     * attribute of a file search condition.
+     *
+     * @param conditionDefinition A file search condition XML element.
+     * @param attributeName The name of an attribute of the element.
+     * @param attributeValue The value of the attribute.
+     * @param filter The filter to which to add the option.
+     * @return False if the attribute is not a filter attribute.
+     */
+    bool parsePathOrTypeFilterOption(const Poco::XML::Node *conditionDefinition, const std::string &attributeName, const std::string &attributeValue, FileFilter &filter)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::parsePathOrTypeFilterOption : ";
+
+        if (attributeName == PATH_FILTER_ATTRIBUTE)
+        {        
+            if (!attributeValue.empty())
+            {
+                // File must include a specified substring somewhere in its path.
+                filter.pathFilter = attributeValue;
+                const std::string foldedPathFilter = Poco::toUpper(attributeValue);
+                std::map<std::string, Poco::SharedPtr<PathFilter> >::const_iterator pathMatcher = pathFilters.find(foldedPathFilter);
+                if (pathMatcher != pathFilters.end())
+                {
+                    filter.pathMatcher = pathMatcher->second;
+                }
+                else
+                {
+                    filter.pathMatcher = new PathFilter(foldedPathFilter);
+                    pathFilters[foldedPathFilter] = filter.pathMatcher;
+                }
+            }
+            else
+            {
+                std::ostringstream msg;
+                msg << MSG_PREFIX << Poco::XML::fromXMLString(conditionDefinition->nodeName()) << " element has empty " << PATH_FILTER_ATTRIBUTE << " attribute"; 
+                throw TskException(msg.str());
+            }
+        }
+        else if (attributeName == TYPE_FILTER_ATTRIBUTE)
+        {
+            if (!attributeValue.empty())
+            {
+                if (attributeValue == FILE_TYPE_FILTER_VALUE)
+                {
+                    // File must be a regular file.
+                    filter.hasTypeFilter = true;
+                    filter.metaType = TSK_FS_META_TYPE_REG;
+                }
+                else if (attributeValue == DIR_TYPE_FILTER_VALUE)
+                {
+                    // File must be a directory.
+                    filter.hasTypeFilter = true;
+                    filter.metaType = TSK_FS_META_TYPE_DIR;
+                }
+                else
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << Poco::XML::fromXMLString(conditionDefinition->nodeName()) << " element has unrecognized " << TYPE_FILTER_ATTRIBUTE << " attribute value: " << attributeValue; 
+                    throw TskException(msg.str());
+                }
+            }
+            else
+            {
+                std::ostringstream msg;
+                msg << MSG_PREFIX << Poco::XML::fromXMLString(conditionDefinition->nodeName()) << " element has empty " << TYPE_FILTER_ATTRIBUTE << " attribute"; 
+                throw TskException(msg.str());
+            }
+        }
+        else
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    /** 
+     * Parses the optional file type (file, directory) and path substring 
+     * filters and the optional confusables option of a file name or 
+     * extension condition.
+     *
+     * @param conditionDefinition A file name or extension condition XML 
+     * element.
+     * @param filter Receives the filters.
+     * @param matchesSkeleton Receives whether the condition matches the
+     * skeletons of file names.
+     */
+    void parseFileNameOptions(const Poco::XML::Node *conditionDefinition, FileFilter &filter, bool &matchesSkeleton)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::parseFileNameOptions : ";
+
+        matchesSkeleton = false;
+        if (conditionDefinition->hasAttributes())
+        {
+            // Look for pathFilter, typeFilter and confusables attributes.
+            Poco::AutoPtr<Poco::XML::NamedNodeMap> attributes = conditionDefinition->attributes(); 
+            for (unsigned long i = 0; i < attributes->length(); ++i)
+            {
+                Poco::XML::Node *attribute = attributes->item(i);
+                const std::string& attributeName = Poco::XML::fromXMLString(attribute->nodeName());
+                const std::string& attributeValue = Poco::XML::fromXMLString(attribute->nodeValue());
+                if (attributeName == CONFUSABLES_ATTRIBUTE)
+                {
+                    if (attributeValue == TRUE_VALUE || attributeValue == FALSE_VALUE)
+                    {
+                        matchesSkeleton = attributeValue == TRUE_VALUE;
+                    }
+                    else
+                    {
+                        std::stringstream msg;
+                        msg << MSG_PREFIX << Poco::XML::fromXMLString(conditionDefinition->nodeName()) << " element has unrecognized " << CONFUSABLES_ATTRIBUTE << " attribute value: " << attributeValue; 
+                        throw TskException(msg.str());
+                    }
+                }
+                else if (!parsePathOrTypeFilterOption(conditionDefinition, attributeName, attributeValue, filter))
+                {
+                    std::stringstream msg;
+                    msg << MSG_PREFIX << Poco::XML::fromXMLString(conditionDefinition->nodeName()) << " element has unrecognized " << attributeName << " attribute"; 
+                    throw TskException(msg.str());
+                }
+            }
+        }
+    }
+
+    /**
+     * Adds a file name or extension condition to an interesting files set. 
+     *
+     * @param nameCondition An SQL expression that selects files by name, or
+     * the empty string if the image database cannot select them.
+     * @param indexLookup A file name index query equivalent to the SQL 
+     * expression, or the empty string if there is none, without the type 
+     * filter.
+     * @param namePattern A glob pattern equivalent to the SQL expression.
+     * @param filter The path and type filters of the condition.
+     * @param isExtensionCondition Whether the pattern is an extension pattern.
+     * @param matchesSkeleton Whether the condition matches the skeletons of 
+     * file names, in which case the SQL expression and the index query are 
+     * not used.
+     * @param fileSet The interesting files set to which to add the condition.
+     */
+    void addFileNameSearchCondition(const std::string &nameCondition, const std::string &indexLookup, const std::string &namePattern, const FileFilter &filter, 
+        bool isExtensionCondition, bool matchesSkeleton, InterestingFilesSet &fileSet)
+    {
+        std::stringstream conditionBuilder;
+        if (!matchesSkeleton)
+        {
+            conditionBuilder << nameCondition;
+            if (filter.hasTypeFilter && !nameCondition.empty())
+            {
+                conditionBuilder << " AND meta_type = " << filter.metaType;
+            }
+        }
+
+        fileSet.scanConditions.push_back(new FileNameCondition(conditionBuilder.str(), !matchesSkeleton ? indexLookup : "", namePattern, filter, 
+            isExtensionCondition, matchesSkeleton));
+    }
+
+    /**
+      * Creates a file name search condition from a file name condition 
+      * definition.
+      *
+      * @param conditionDefinition A file name condition XML element.
+      * @param fileSet The condition is added to this interesting files set.
+      */
+    void compileFileNameSearchCondition(const Poco::XML::Node *conditionDefinition, InterestingFilesSet &fileSet)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::compileFileNameSearchCondition : ";
+
+        std::string name(Poco::XML::fromXMLString(conditionDefinition->innerText()));
+        if (name.empty())
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "empty " << NAME_ELEMENT_TAG << " element"; 
+            throw TskException(msg.str());
+        }
+
+        FileFilter filter;
+        bool matchesSkeleton;
+        parseFileNameOptions(conditionDefinition, filter, matchesSkeleton);
+
+        const std::string namePattern(name);
+        std::stringstream conditionBuilder;
+        std::string indexLookup;
+        if (hasGlobWildcards(name))
+        {
+            convertGlobWildcardsToSQLWildcards(name);
+            conditionBuilder << "UPPER(name) LIKE UPPER(" << TskServices::Instance().getImgDB().quote(name) << ") ESCAPE '#'";
+        }
+        else
+        {
+            conditionBuilder << "UPPER(name) = UPPER(" +  TskServices::Instance().getImgDB().quote(name) + ")";
+            indexLookup = FileNameIndex::getNameLookup(TskServices::Instance().getImgDB().quote(Poco::toUpper(name)));
+        }
+
+        addFileNameSearchCondition(conditionBuilder.str(), indexLookup, namePattern, filter, false, matchesSkeleton, fileSet);
+    }
+
+    /**
+      * Creates a file name search condition from a file extension condition 
+      * definition.
+      *
+      * @param conditionDefinition A file extension condition XML element.
+      * @param fileSet The condition is added to this interesting files set.
+      */
+    void compileExtensionSearchCondition(const Poco::XML::Node *conditionDefinition, InterestingFilesSet &fileSet)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::compileExtensionSearchCondition : ";
+
+        std::string extension(Poco::XML::fromXMLString(conditionDefinition->innerText()));
+        if (extension.empty())
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "empty " << EXTENSION_ELEMENT_TAG << " element"; 
+            throw TskException(msg.str());
+        }
+
+        FileFilter filter;
+        bool matchesSkeleton;
+        parseFileNameOptions(conditionDefinition, filter, matchesSkeleton);
+
+        // Supply the leading dot, if omitted.
+        if (extension[0] != '.')
+        {
+            extension.insert(0, ".");
+        }
+
+        const std::string extensionPattern(extension);
+        const bool isLiteral = !hasGlobWildcards(extension);
+        const bool hasOneDot = extension.find('.', 1) == std::string::npos;
+
+        // The file name index holds the extension from the last '.' of each name.
+        std::string indexLookup;
+        if (hasOneDot)
+        {
+            indexLookup = isLiteral ? FileNameIndex::getExtensionLookup(TskServices::Instance().getImgDB().quote(Poco::toUpper(extension))) :
+                FileNameIndex::getExtensionPatternLookup(Poco::toUpper(extension));
+        }
+
+        // A name that ends with a literal extension has that extension, but a pattern with wildcards must be matched against
+        // the extension itself, which for a single '.' is what follows the trailing characters that are not '.'s.
+        convertGlobWildcardsToSQLWildcards(extension);
+        std::stringstream conditionBuilder;
+        if (isLiteral)
+        {
+            conditionBuilder << "UPPER(name) LIKE UPPER('%" << extension << "') ESCAPE '#'";
+        }
+        else if (hasOneDot)
+        {
+            conditionBuilder << "UPPER(SUBSTR(name, LENGTH(RTRIM(name, REPLACE(name, '.', ''))))) LIKE UPPER('" << extension << "') ESCAPE '#'";
+        }
+
+        addFileNameSearchCondition(conditionBuilder.str(), indexLookup, extensionPattern, filter, true, matchesSkeleton, fileSet);
+    }
+
+    /**
+      * Creates a hash set condition from a hash set condition definition. The 
+      * text hash list named by the definition is preprocessed into a hash set
+      * database, if it has not been already, and the database is memory mapped.
+      *
+      * @param conditionDefinition A hash set condition XML element.
+      * @param conditions The hash set condition is added to this collection.
+      */
+    void compileHashSetSearchCondition(const Poco::XML::Node *conditionDefinition, std::vector<Poco::SharedPtr<ScanCondition> > &conditions)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::compileHashSetSearchCondition : ";
+
+        std::string hashListPath(Poco::XML::fromXMLString(conditionDefinition->innerText()));
+        if (hashListPath.empty())
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "empty " << HASHSET_ELEMENT_TAG << " element"; 
+            throw TskException(msg.str());
+        }
+
+        // Hash lists are located relative to the config file unless an absolute path is given.
+        Poco::Path hashListFilePath(hashListPath);
+        hashListFilePath.makeAbsolute(Poco::Path(packFilePath).parent());
+        hashListPath = hashListFilePath.toString();
+
+        HashSetDatabase::HashType hashType = HashSetDatabase::MD5;
+        bool useBloomFilter = false;
+        if (conditionDefinition->hasAttributes())
+        {
+            Poco::AutoPtr<Poco::XML::NamedNodeMap> attributes = conditionDefinition->attributes(); 
+            for (unsigned long i = 0; i < attributes->length(); ++i)
+            {
+                Poco::XML::Node *attribute = attributes->item(i);
+                const std::string& attributeName = Poco::XML::fromXMLString(attribute->nodeName());
+                const std::string& attributeValue = Poco::XML::fromXMLString(attribute->nodeValue());
+                if (attributeName == HASH_TYPE_ATTRIBUTE)
+                {
+                    if (attributeValue == MD5_HASH_TYPE_VALUE)
+                    {
+                        hashType = HashSetDatabase::MD5;
+                    }
+                    else if (attributeValue == SHA1_HASH_TYPE_VALUE)
+                    {
+                        hashType = HashSetDatabase::SHA1;
+                    }
+                    else if (attributeValue == SHA256_HASH_TYPE_VALUE)
+                    {
+                        hashType = HashSetDatabase::SHA2_256;
+                    }
+                    else
+                    {
+                        std::ostringstream msg;
+                        msg << MSG_PREFIX << HASHSET_ELEMENT_TAG << " element has unrecognized " << HASH_TYPE_ATTRIBUTE << " attribute value: " << attributeValue; 
+                        throw TskException(msg.str());
+                    }
+                }
+                else if (attributeName == BLOOM_FILTER_ATTRIBUTE)
+                {
+                    if (attributeValue == TRUE_VALUE)
+                    {
+                        useBloomFilter = true;
+                    }
+                    else if (attributeValue == FALSE_VALUE)
+                    {
+                        useBloomFilter = false;
+                    }
+                    else
+                    {
+                        std::ostringstream msg;
+                        msg << MSG_PREFIX << HASHSET_ELEMENT_TAG << " element has unrecognized " << BLOOM_FILTER_ATTRIBUTE << " attribute value: " << attributeValue; 
+                        throw TskException(msg.str());
+                    }
+                }
+                else
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << HASHSET_ELEMENT_TAG << " element has unrecognized " << attributeName << " attribute"; 
+                    throw TskException(msg.str());
+                }
+            }
+        }
+
+        // The database is stored next to the hash list and rebuilt only when the hash list changes. 
+        const std::string databasePath = hashListPath + HASH_SET_DATABASE_EXTENSION;
+        std::map<std::string, Poco::SharedPtr<HashSetDatabase> >::iterator database = hashSetDatabases.find(databasePath);
+        if (database == hashSetDatabases.end())
+        {
+            HashSetDatabase::build(hashListPath, databasePath, hashType, useBloomFilter);
+            database = hashSetDatabases.insert(std::make_pair(databasePath, Poco::SharedPtr<HashSetDatabase>(new HashSetDatabase(databasePath)))).first;
+        }
+
+        if (database->second->hashType() != hashType)
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << HASHSET_ELEMENT_TAG << " element for '" << hashListPath << "' has conflicting " << HASH_TYPE_ATTRIBUTE << " attribute values"; 
+            throw TskException(msg.str());
+        }
+
+        // The hits of the condition change when the hash list does.
+        const Poco::File hashListFile(hashListPath);
+        std::ostringstream dataVersion;
+        dataVersion << hashListPath << " " << hashListFile.getSize() << " " << hashListFile.getLastModified().epochMicroseconds();
+
+        conditions.push_back(new HashSetCondition(hashType, database->second, dataVersion.str()));
+    }
+
+    /**
+      * Creates a regular expression scan condition from a regular expression
+      * condition definition. The regular expression is added to the name or 
+      * path regex set.
+      *
+      * @param conditionDefinition A regular expression condition XML element.
+      * @param conditions The scan condition is added to this collection.
+      */
+    void compileRegexSearchCondition(const Poco::XML::Node *conditionDefinition, std::vector<Poco::SharedPtr<ScanCondition> > &conditions)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::compileRegexSearchCondition : ";
+
+        std::string expression(Poco::XML::fromXMLString(conditionDefinition->innerText()));
+        if (expression.empty())
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "empty " << REGEX_ELEMENT_TAG << " element"; 
+            throw TskException(msg.str());
+        }
+
+        bool matchPath = false;
+        FileFilter filter;
+        if (conditionDefinition->hasAttributes())
+        {
+            Poco::AutoPtr<Poco::XML::NamedNodeMap> attributes = conditionDefinition->attributes(); 
+            for (unsigned long i = 0; i < attributes->length(); ++i)
+            {
+                Poco::XML::Node *attribute = attributes->item(i);
+                const std::string& attributeName = Poco::XML::fromXMLString(attribute->nodeName());
+                const std::string& attributeValue = Poco::XML::fromXMLString(attribute->nodeValue());
+                if (attributeName == TARGET_ATTRIBUTE)
+                {
+                    if (attributeValue == NAME_TARGET_VALUE)
+                    {
+                        matchPath = false;
+                    }
+                    else if (attributeValue == PATH_TARGET_VALUE)
+                    {
+                        matchPath = true;
+                    }
+                    else
+                    {
+                        std::ostringstream msg;
+                        msg << MSG_PREFIX << REGEX_ELEMENT_TAG << " element has unrecognized " << TARGET_ATTRIBUTE << " attribute value: " << attributeValue; 
+                        throw TskException(msg.str());
+                    }
+                }
+                else if (!parsePathOrTypeFilterOption(conditionDefinition, attributeName, attributeValue, filter))
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << REGEX_ELEMENT_TAG << " element has unrecognized " << attributeName << " attribute"; 
+                    throw TskException(msg.str());
+                }
+            }
+        }
+
+        const size_t expressionId = matchPath ? pathRegexes.add(expression) : nameRegexes.add(expression);
+        conditions.push_back(new RegexCondition(matchPath, expressionId, filter));
+    }
+
+    /**
+      * Creates a content signature scan condition from a signature condition 
+      * definition. The signature is added to the signature table.
+      *
+      * @param conditionDefinition A signature condition XML element.
+      * @param conditions The scan condition is added to this collection.
+      */
+    void compileSignatureSearchCondition(const Poco::XML::Node *conditionDefinition, std::vector<Poco::SharedPtr<ScanCondition> > &conditions)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::compileSignatureSearchCondition : ";
+
+        // The signature is given as hex digits, optionally separated by white space.
+        std::string hexSignature;
+        const std::string text(Poco::XML::fromXMLString(conditionDefinition->innerText()));
+        for (std::string::const_iterator c = text.begin(); c != text.end(); ++c)
+        {
+            if (!isspace(static_cast<unsigned char>(*c)))
+            {
+                hexSignature += *c;
+            }
+        }
+        if (hexSignature.empty())
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "empty " << SIGNATURE_ELEMENT_TAG << " element"; 
+            throw TskException(msg.str());
+        }
+
+        std::vector<unsigned char> signature(hexSignature.size() / 2);
+        if (!HashSetDatabase::hexToBytes(hexSignature, signature.size(), &signature[0]))
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << SIGNATURE_ELEMENT_TAG << " element '" << text << "' is not a sequence of hexadecimal bytes"; 
+            throw TskException(msg.str());
+        }
+
+        unsigned int offset = 0;
+        FileFilter filter;
+        if (conditionDefinition->hasAttributes())
+        {
+            Poco::AutoPtr<Poco::XML::NamedNodeMap> attributes = conditionDefinition->attributes(); 
+            for (unsigned long i = 0; i < attributes->length(); ++i)
+            {
+                Poco::XML::Node *attribute = attributes->item(i);
+                const std::string& attributeName = Poco::XML::fromXMLString(attribute->nodeName());
+                const std::string& attributeValue = Poco::XML::fromXMLString(attribute->nodeValue());
+                if (attributeName == OFFSET_ATTRIBUTE)
+                {
+                    if (!Poco::NumberParser::tryParseUnsigned(attributeValue, offset))
+                    {
+                        std::ostringstream msg;
+                        msg << MSG_PREFIX << SIGNATURE_ELEMENT_TAG << " element has invalid " << OFFSET_ATTRIBUTE << " attribute value: " << attributeValue; 
+                        throw TskException(msg.str());
+                    }
+                }
+                else if (!parsePathOrTypeFilterOption(conditionDefinition, attributeName, attributeValue, filter))
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << SIGNATURE_ELEMENT_TAG << " element has unrecognized " << attributeName << " attribute"; 
+                    throw TskException(msg.str());
+                }
+            }
+        }
+
+        if (offset + signature.size() > MAX_SIGNATURE_HEADER_LENGTH)
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << SIGNATURE_ELEMENT_TAG << " element '" << text << "' ends beyond the first " << MAX_SIGNATURE_HEADER_LENGTH << " bytes of a file"; 
+            throw TskException(msg.str());
+        }
+
+        const size_t signatureId = signatures.add(signature, offset);
+        conditions.push_back(new SignatureCondition(signatureId, offset + signature.size(), filter));
+    }
+
+    /**
+      * Creates a subtree scan condition from a subtree condition definition.
+      *
+      * @param conditionDefinition A subtree condition XML element.
+      * @param conditions The scan condition is added to this collection.
+      */
+    void compileSubtreeSearchCondition(const Poco::XML::Node *conditionDefinition, std::vector<Poco::SharedPtr<ScanCondition> > &conditions)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::compileSubtreeSearchCondition : ";
+
+        std::string directoryName(Poco::XML::fromXMLString(conditionDefinition->innerText()));
+        if (directoryName.empty())
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "empty " << SUBTREE_ELEMENT_TAG << " element"; 
+            throw TskException(msg.str());
+        }
+
+        FileFilter filter;
+        if (conditionDefinition->hasAttributes())
+        {
+            Poco::AutoPtr<Poco::XML::NamedNodeMap> attributes = conditionDefinition->attributes(); 
+            for (unsigned long i = 0; i < attributes->length(); ++i)
+            {
+                Poco::XML::Node *attribute = attributes->item(i);
+                const std::string& attributeName = Poco::XML::fromXMLString(attribute->nodeName());
+                const std::string& attributeValue = Poco::XML::fromXMLString(attribute->nodeValue());
+                if (!parsePathOrTypeFilterOption(conditionDefinition, attributeName, attributeValue, filter))
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << SUBTREE_ELEMENT_TAG << " element has unrecognized " << attributeName << " attribute"; 
+                    throw TskException(msg.str());
+                }
+            }
+        }
+
+        conditions.push_back(new SubtreeCondition(directoryName, filter));
+    }
+
+    /**
+      * Creates a fuzzy name scan condition from a fuzzy name condition 
+      * definition. The target name is added to the fuzzy name set.
+      *
+      * @param conditionDefinition A fuzzy name condition XML element.
+      * @param conditions The scan condition is added to this collection.
+      */
+    void compileFuzzyNameSearchCondition(const Poco::XML::Node *conditionDefinition, std::vector<Poco::SharedPtr<ScanCondition> > &conditions)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::compileFuzzyNameSearchCondition : ";
+
+        const std::string name(Poco::XML::fromXMLString(conditionDefinition->innerText()));
+        if (name.empty())
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "empty " << FUZZY_NAME_ELEMENT_TAG << " element"; 
+            throw TskException(msg.str());
+        }
+
+        unsigned int maxDistance = 1;
+        FileFilter filter;
+        if (conditionDefinition->hasAttributes())
+        {
+            Poco::AutoPtr<Poco::XML::NamedNodeMap> attributes = conditionDefinition->attributes(); 
+            for (unsigned long i = 0; i < attributes->length(); ++i)
+            {
+                Poco::XML::Node *attribute = attributes->item(i);
+                const std::string& attributeName = Poco::XML::fromXMLString(attribute->nodeName());
+                const std::string& attributeValue = Poco::XML::fromXMLString(attribute->nodeValue());
+                if (attributeName == MAX_DISTANCE_ATTRIBUTE)
+                {
+                    if (!Poco::NumberParser::tryParseUnsigned(attributeValue, maxDistance) || maxDistance == 0)
+                    {
+                        std::ostringstream msg;
+                        msg << MSG_PREFIX << FUZZY_NAME_ELEMENT_TAG << " element has invalid " << MAX_DISTANCE_ATTRIBUTE << " attribute value: " << attributeValue; 
+                        throw TskException(msg.str());
+                    }
+                }
+                else if (!parsePathOrTypeFilterOption(conditionDefinition, attributeName, attributeValue, filter))
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << FUZZY_NAME_ELEMENT_TAG << " element has unrecognized " << attributeName << " attribute"; 
+                    throw TskException(msg.str());
+                }
+            }
+        }
+
+        const size_t targetId = fuzzyNames.add(Poco::toUpper(name), maxDistance);
+        conditions.push_back(new FuzzyNameCondition(targetId, name.size(), maxDistance, filter));
+    }
+
+    /**
+      * Creates a random name scan condition from a random name condition 
+      * definition.
+      *
+      * @param conditionDefinition A random name condition XML element.
+      * @param conditions The scan condition is added to this collection.
+      */
+    void compileRandomNameSearchCondition(const Poco::XML::Node *conditionDefinition, std::vector<Poco::SharedPtr<ScanCondition> > &conditions)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::compileRandomNameSearchCondition : ";
+
+        unsigned int minLength = DEFAULT_RANDOM_NAME_MIN_LENGTH;
+        double minEntropy = DEFAULT_RANDOM_NAME_MIN_ENTROPY;
+        double minBigramBits = DEFAULT_RANDOM_NAME_MIN_BIGRAM_BITS;
+        FileFilter filter;
+        if (conditionDefinition->hasAttributes())
+        {
+            Poco::AutoPtr<Poco::XML::NamedNodeMap> attributes = conditionDefinition->attributes(); 
+            for (unsigned long i = 0; i < attributes->length(); ++i)
+            {
+                Poco::XML::Node *attribute = attributes->item(i);
+                const std::string& attributeName = Poco::XML::fromXMLString(attribute->nodeName());
+                const std::string& attributeValue = Poco::XML::fromXMLString(attribute->nodeValue());
+                bool isValid = true;
+                if (attributeName == MIN_LENGTH_ATTRIBUTE)
+                {
+                    isValid = Poco::NumberParser::tryParseUnsigned(attributeValue, minLength) && minLength != 0;
+                }
+                else if (attributeName == MIN_ENTROPY_ATTRIBUTE)
+                {
+                    isValid = Poco::NumberParser::tryParseFloat(attributeValue, minEntropy) && minEntropy >= 0.0;
+                }
+                else if (attributeName == MIN_BIGRAM_BITS_ATTRIBUTE)
+                {
+                    isValid = Poco::NumberParser::tryParseFloat(attributeValue, minBigramBits) && minBigramBits >= 0.0;
+                }
+                else if (!parsePathOrTypeFilterOption(conditionDefinition, attributeName, attributeValue, filter))
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << RANDOM_NAME_ELEMENT_TAG << " element has unrecognized " << attributeName << " attribute"; 
+                    throw TskException(msg.str());
+                }
+
+                if (!isValid)
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << RANDOM_NAME_ELEMENT_TAG << " element has invalid " << attributeName << " attribute value: " << attributeValue; 
+                    throw TskException(msg.str());
+                }
+            }
+        }
+
+        conditions.push_back(new RandomNameCondition(minLength, minEntropy, minBigramBits, filter));
+    }
+
+    /**
+     * Parses a list of extensions separated by commas or white space, with 
+     * or without their leading '.'.
+     *
+     * @param list The list.
+     * @param foldedExtensions Receives the extensions, including their '.', 
+     * folded to upper case.
+     */
+    void parseExtensionList(const std::string &list, std::set<std::string> &foldedExtensions)
+    {
+        foldedExtensions.clear();
+        std::string extension;
+        for (std::string::const_iterator c = list.begin(); ; ++c)
+        {
+            if (c == list.end() || *c == ',' || isspace(static_cast<unsigned char>(*c)))
+            {
+                if (!extension.empty() && extension != ".")
+                {
+                    foldedExtensions.insert(Poco::toUpper(extension[0] == '.' ? extension : "." + extension));
+                }
+                extension.clear();
+                if (c == list.end())
+                {
+                    break;
+                }
+            }
+            else
+            {
+                extension += *c;
+            }
+        }
+    }
+
+    /**
+      * Creates a double extension scan condition, and optionally an extension
+      * mismatch scan condition, from a double extension condition definition.
+      *
+      * @param conditionDefinition A double extension condition XML element.
+      * @param conditions The scan conditions are added to this collection.
+      */
+    void compileDoubleExtensionSearchCondition(const Poco::XML::Node *conditionDefinition, std::vector<Poco::SharedPtr<ScanCondition> > &conditions)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::compileDoubleExtensionSearchCondition : ";
+
+        std::set<std::string> innerExtensions;
+        std::set<std::string> outerExtensions;
+        parseExtensionList(DEFAULT_INNER_EXTENSIONS, innerExtensions);
+        parseExtensionList(DEFAULT_OUTER_EXTENSIONS, outerExtensions);
+        bool checkContent = false;
+        FileFilter filter;
+        if (conditionDefinition->hasAttributes())
+        {
+            Poco::AutoPtr<Poco::XML::NamedNodeMap> attributes = conditionDefinition->attributes(); 
+            for (unsigned long i = 0; i < attributes->length(); ++i)
+            {
+                Poco::XML::Node *attribute = attributes->item(i);
+                const std::string& attributeName = Poco::XML::fromXMLString(attribute->nodeName());
+                const std::string& attributeValue = Poco::XML::fromXMLString(attribute->nodeValue());
+                if (attributeName == INNER_ATTRIBUTE || attributeName == OUTER_ATTRIBUTE)
+                {
+                    std::set<std::string> &extensions = attributeName == INNER_ATTRIBUTE ? innerExtensions : outerExtensions;
+                    parseExtensionList(attributeValue, extensions);
+                    if (extensions.empty())
+                    {
+                        std::ostringstream msg;
+                        msg << MSG_PREFIX << DOUBLE_EXTENSION_ELEMENT_TAG << " element has empty " << attributeName << " attribute"; 
+                        throw TskException(msg.str());
+                    }
+                }
+                else if (attributeName == CHECK_CONTENT_ATTRIBUTE)
+                {
+                    if (attributeValue == TRUE_VALUE)
+                    {
+                        checkContent = true;
+                    }
+                    else if (attributeValue == FALSE_VALUE)
+                    {
+                        checkContent = false;
+                    }
+                    else
+                    {
+                        std::ostringstream msg;
+                        msg << MSG_PREFIX << DOUBLE_EXTENSION_ELEMENT_TAG << " element has unrecognized " << CHECK_CONTENT_ATTRIBUTE << " attribute value: " << attributeValue; 
+                        throw TskException(msg.str());
+                    }
+                }
+                else if (!parsePathOrTypeFilterOption(conditionDefinition, attributeName, attributeValue, filter))
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << DOUBLE_EXTENSION_ELEMENT_TAG << " element has unrecognized " << attributeName << " attribute"; 
+                    throw TskException(msg.str());
+                }
+            }
+        }
+
+        conditions.push_back(new DoubleExtensionCondition(innerExtensions, outerExtensions, filter));
+
+        if (checkContent)
+        {
+            std::vector<size_t> signatureIds;
+            size_t signatureEnd = MAX_SIGNATURE_HEADER_LENGTH;
+            for (size_t i = 0; i < sizeof(EXECUTABLE_SIGNATURES) / sizeof(EXECUTABLE_SIGNATURES[0]); ++i)
+            {
+                const std::string hexSignature(EXECUTABLE_SIGNATURES[i]);
+                std::vector<unsigned char> signature(hexSignature.size() / 2);
+                HashSetDatabase::hexToBytes(hexSignature, signature.size(), &signature[0]);
+                signatureIds.push_back(signatures.add(signature, 0));
+                signatureEnd = std::min(signatureEnd, signature.size());
+            }
+            conditions.push_back(new ExtensionMismatchCondition(innerExtensions, signatureIds, signatureEnd, filter));
+        }
+    }
+
+    /**
+     * Writes the start tag of an element, with its attributes.
+     */
+    void describeStartTag(const Poco::XML::Node *definition, std::ostream &description)
+    {
+        description << "<" << Poco::XML::fromXMLString(definition->nodeName());
+        if (definition->hasAttributes())
+        {
+            Poco::AutoPtr<Poco::XML::NamedNodeMap> attributes = definition->attributes(); 
+            for (unsigned long i = 0; i < attributes->length(); ++i)
+            {
+                Poco::XML::Node *attribute = attributes->item(i);
+                description << " " << Poco::XML::fromXMLString(attribute->nodeName()) << "=\"" << Poco::XML::fromXMLString(attribute->nodeValue()) << "\"";
+            }
+        }
+        description << ">";
+    }
+
+    /**
+     * Describes a search condition definition for reporting, as the XML 
+     * element that defines it.
+     *
+     * @param conditionDefinition A search condition XML element.
+     * @return The description.
+     */
+    std::string describeConditionDefinition(const Poco::XML::Node *conditionDefinition)
+    {
+        const std::string conditionType = Poco::XML::fromXMLString(conditionDefinition->nodeName());
+        std::ostringstream description;
+        describeStartTag(conditionDefinition, description);
+        description << Poco::XML::fromXMLString(conditionDefinition->innerText()) << "</" << conditionType << ">";
+        return description.str();
+    }
+
+    /**
+     * Writes a compact description of an element and all of its 
+     * descendants, for the key of the cached hits of an interesting files 
+     * set.
+     */
+    void describeDefinitionTree(const Poco::XML::Node *definition, std::ostream &description)
+    {
+        describeStartTag(definition, description);
+        Poco::AutoPtr<Poco::XML::NodeList> children = definition->childNodes();
+        for (unsigned long i = 0; i < children->length(); ++i)
+        {
+            Poco::XML::Node *child = children->item(i);
+            if (child->nodeType() == Poco::XML::Node::ELEMENT_NODE)
+            {
+                describeDefinitionTree(child, description);
+            }
+            else if (child->nodeType() == Poco::XML::Node::TEXT_NODE)
+            {
+                description << Poco::trim(Poco::XML::fromXMLString(child->nodeValue()));
+            }
+        }
+        description << "</" << Poco::XML::fromXMLString(definition->nodeName()) << ">";
+    }
+
+    /**
+     * Parses an optional boolean attribute of the root element of the 
+     * configuration file.
+     *
+     * @param configuration The root element of the configuration file.
+     * @param attributeName The name of the attribute.
+     * @return The value of the attribute, or false if it is omitted.
+     */
+    bool parseBooleanOption(const Poco::XML::Element *configuration, const std::string &attributeName)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::parseBooleanOption : ";
+
+        if (!configuration->hasAttribute(attributeName))
+        {
+            return false;
+        }
+
+        const std::string attributeValue = Poco::XML::fromXMLString(configuration->getAttribute(attributeName));
+        if (attributeValue == TRUE_VALUE)
+        {
+            return true;
+        }
+        else if (attributeValue != FALSE_VALUE)
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << Poco::XML::fromXMLString(configuration->nodeName()) << " element has unrecognized " << attributeName << " attribute value: " << attributeValue; 
+            throw TskException(msg.str());
+        }
+        return false;
+    }
+
+    /**
+     * Parses the options given by the attributes of the root element of the
+     * configuration file.
+     *
+     * @param configuration The root element of the configuration file.
+     */
+    void parseConfigurationOptions(const Poco::XML::Element *configuration)
+    {
+        if (configuration != NULL)
+        {
+            // An option asked for by any rule pack applies to the search of all of them.
+            useFileNameIndex = parseBooleanOption(configuration, FILE_NAME_INDEX_ATTRIBUTE) || useFileNameIndex;
+            useTrigramIndex = parseBooleanOption(configuration, TRIGRAM_INDEX_ATTRIBUTE) || useTrigramIndex;
+            useMatchFunction = parseBooleanOption(configuration, MATCH_FUNCTION_ATTRIBUTE) || useMatchFunction;
+            useBulkPosting = parseBooleanOption(configuration, BULK_POSTING_ATTRIBUTE) || useBulkPosting;
+            useResultCache = parseBooleanOption(configuration, RESULT_CACHE_ATTRIBUTE) || useResultCache;
+
+            // The content cache is located relative to the config file unless an absolute path is given.
+            const std::string contentCacheValue = Poco::XML::fromXMLString(configuration->getAttribute(CONTENT_CACHE_ATTRIBUTE));
+            if (!contentCacheValue.empty())
+            {
+                Poco::Path contentCacheFilePath(contentCacheValue);
+                contentCacheFilePath.makeAbsolute(Poco::Path(packFilePath).parent());
+                contentCachePath = contentCacheFilePath.toString();
+            }
+        }
+    }
+
+    /**
+     * Creates a search condition from a condition definition.
+     *
+     * @param conditionDefinition A condition XML element.
+     * @param fileSet The condition is added to this interesting files set.
+     */
+    void compileSearchCondition(const Poco::XML::Node *conditionDefinition, InterestingFilesSet &fileSet)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::compileSearchCondition : ";
+
+        const std::string &conditionType = Poco::XML::fromXMLString(conditionDefinition->nodeName());
+        if (conditionType == NAME_ELEMENT_TAG)
+        {
+            compileFileNameSearchCondition(conditionDefinition, fileSet);
+        }
+        else if (conditionType == EXTENSION_ELEMENT_TAG)
+        {
+            compileExtensionSearchCondition(conditionDefinition, fileSet);
+        }
+        else if (conditionType == HASHSET_ELEMENT_TAG)
+        {
+            compileHashSetSearchCondition(conditionDefinition, fileSet.scanConditions);
+        }
+        else if (conditionType == REGEX_ELEMENT_TAG)
+        {
+            compileRegexSearchCondition(conditionDefinition, fileSet.scanConditions);
+        }
+        else if (conditionType == SIGNATURE_ELEMENT_TAG)
+        {
+            compileSignatureSearchCondition(conditionDefinition, fileSet.scanConditions);
+        }
+        else if (conditionType == SUBTREE_ELEMENT_TAG)
+        {
+            compileSubtreeSearchCondition(conditionDefinition, fileSet.scanConditions);
+        }
+        else if (conditionType == DOUBLE_EXTENSION_ELEMENT_TAG)
+        {
+            compileDoubleExtensionSearchCondition(conditionDefinition, fileSet.scanConditions);
+        }
+        else if (conditionType == FUZZY_NAME_ELEMENT_TAG)
+        {
+            compileFuzzyNameSearchCondition(conditionDefinition, fileSet.scanConditions);
+        }
+        else if (conditionType == RANDOM_NAME_ELEMENT_TAG)
+        {
+            compileRandomNameSearchCondition(conditionDefinition, fileSet.scanConditions);
+        }
+        else
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "unrecognized " << INTERESTING_FILE_SET_ELEMENT_TAG << " child element '" << conditionType << "'"; 
+            throw TskException(msg.str());
+        }
+
+        // The metrics of a condition are reported under its definition.
+        const ConditionMetrics metrics(describeConditionDefinition(conditionDefinition));
+        fileSet.scanConditionMetrics.resize(fileSet.scanConditions.size(), metrics);
+    }
+
+    /**
+     * Parses the attributes of a WITHIN element into its rule node.
+     *
+     * @param definition A WITHIN XML element.
+     * @param node The rule node of the element.
+     */
+    void parseTimeWindow(const Poco::XML::Node *definition, RuleNode &node)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::parseTimeWindow : ";
+
+        bool hasSeconds = false;
+        if (definition->hasAttributes())
+        {
+            Poco::AutoPtr<Poco::XML::NamedNodeMap> attributes = definition->attributes(); 
+            for (unsigned long i = 0; i < attributes->length(); ++i)
+            {
+                Poco::XML::Node *attribute = attributes->item(i);
+                const std::string& attributeName = Poco::XML::fromXMLString(attribute->nodeName());
+                const std::string& attributeValue = Poco::XML::fromXMLString(attribute->nodeValue());
+                bool isValid = true;
+                if (attributeName == SECONDS_ATTRIBUTE)
+                {
+                    unsigned int seconds = 0;
+                    isValid = Poco::NumberParser::tryParseUnsigned(attributeValue, seconds);
+                    node.seconds = seconds;
+                    hasSeconds = true;
+                }
+                else if (attributeName == TIMESTAMP_ATTRIBUTE)
+                {
+                    int timestamp = 0;
+                    while (timestamp < FILE_TIMESTAMP_COUNT && attributeValue != FILE_TIMESTAMP_VALUES[timestamp])
+                    {
+                        ++timestamp;
+                    }
+                    isValid = timestamp < FILE_TIMESTAMP_COUNT;
+                    node.timestamp = static_cast<FileTimestamp>(timestamp);
+                }
+                else
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << WITHIN_ELEMENT_TAG << " element has unrecognized " << attributeName << " attribute"; 
+                    throw TskException(msg.str());
+                }
+
+                if (!isValid)
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << WITHIN_ELEMENT_TAG << " element has invalid " << attributeName << " attribute value: " << attributeValue; 
+                    throw TskException(msg.str());
+                }
+            }
+        }
+
+        if (!hasSeconds)
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << WITHIN_ELEMENT_TAG << " element has no " << SECONDS_ATTRIBUTE << " attribute"; 
+            throw TskException(msg.str());
+        }
+    }
+
+    /**
+     * Adds a node to the rule of an interesting files set.
+     *
+     * @return The index of the node.
+     */
+    size_t addRuleNode(const RuleNode &node, size_t parentNode, InterestingFilesSet &fileSet)
+    {
+        fileSet.ruleNodes.push_back(node);
+        const size_t nodeIndex = fileSet.ruleNodes.size() - 1;
+        fileSet.ruleNodes[parentNode].children.push_back(nodeIndex);
+        return nodeIndex;
+    }
+
+    /**
+     * Creates the search conditions and the rule nodes defined by the child
+     * elements of an interesting files set definition or of an ALL, ANY, NOT
+     * or EXCLUDE element.
+     *
+     * @param parentDefinition The parent XML element.
+     * @param parentNode The index of the rule node of the parent element.
+     * @param fileSet The conditions and rule nodes are added to this 
+     * interesting files set.
+     * @return True if any of the child elements needs the set to have a rule.
+     */
+    bool compileRuleElements(const Poco::XML::Node *parentDefinition, size_t parentNode, InterestingFilesSet &fileSet)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::compileRuleElements : ";
+
+        bool needsRule = false;
+        Poco::AutoPtr<Poco::XML::NodeList> definitions = parentDefinition->childNodes();
+        for (unsigned long i = 0; i < definitions->length(); ++i)
+        {
+            Poco::XML::Node *definition = definitions->item(i);
+            if (definition->nodeType() != Poco::XML::Node::ELEMENT_NODE) 
+            {
+                continue;
+            }
+
+            const std::string &elementType = Poco::XML::fromXMLString(definition->nodeName());
+            if (elementType == ALL_ELEMENT_TAG || elementType == ANY_ELEMENT_TAG || elementType == NOT_ELEMENT_TAG)
+            {
+                const RuleNode::Type type = elementType == ALL_ELEMENT_TAG ? RuleNode::ALL : elementType == ANY_ELEMENT_TAG ? RuleNode::ANY : RuleNode::NOT;
+                if (type == RuleNode::NOT && fileSet.ruleNodes[parentNode].type != RuleNode::ALL)
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << NOT_ELEMENT_TAG << " element outside an " << ALL_ELEMENT_TAG << " element in " << INTERESTING_FILE_SET_ELEMENT_TAG 
+                        << " element '" << fileSet.name << "', use an " << EXCLUDE_ELEMENT_TAG << " element to exclude files from the whole set"; 
+                    throw TskException(msg.str());
+                }
+
+                const size_t node = addRuleNode(RuleNode(type), parentNode, fileSet);
+                compileRuleElements(definition, node, fileSet);
+
+                // An ALL element needs a condition to remove the files that satisfy its NOT elements from.
+                bool hasIncludedFiles = type != RuleNode::ALL;
+                for (std::vector<size_t>::const_iterator child = fileSet.ruleNodes[node].children.begin(); child != fileSet.ruleNodes[node].children.end(); ++child)
+                {
+                    hasIncludedFiles = hasIncludedFiles || fileSet.ruleNodes[*child].type != RuleNode::NOT;
+                }
+                if (fileSet.ruleNodes[node].children.empty() || !hasIncludedFiles)
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << (fileSet.ruleNodes[node].children.empty() ? "empty " : "only NOT elements in ") << elementType 
+                        << " element in " << INTERESTING_FILE_SET_ELEMENT_TAG << " element '" << fileSet.name << "'"; 
+                    throw TskException(msg.str());
+                }
+                needsRule = true;
+            }
+            else if (elementType == SIBLINGS_ELEMENT_TAG || elementType == CONTAINS_ELEMENT_TAG || elementType == WITHIN_ELEMENT_TAG)
+            {
+                const RuleNode::Type type = elementType == SIBLINGS_ELEMENT_TAG ? RuleNode::SIBLINGS : elementType == CONTAINS_ELEMENT_TAG ? RuleNode::CONTAINS : RuleNode::WITHIN;
+                RuleNode ruleNode(type, fileSet.scanConditions.size());
+                if (type == RuleNode::WITHIN)
+                {
+                    parseTimeWindow(definition, ruleNode);
+                }
+
+                const size_t node = addRuleNode(ruleNode, parentNode, fileSet);
+                compileRuleElements(definition, node, fileSet);
+                if (fileSet.ruleNodes[node].children.empty())
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << "empty " << elementType << " element in " << INTERESTING_FILE_SET_ELEMENT_TAG << " element '" << fileSet.name << "'"; 
+                    throw TskException(msg.str());
+                }
+                needsRule = true;
+            }
+            else if (elementType == EXCLUDE_ELEMENT_TAG)
+            {
+                if (parentNode != RULE_CONDITIONS_NODE)
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << EXCLUDE_ELEMENT_TAG << " element is not a child of " << INTERESTING_FILE_SET_ELEMENT_TAG << " element '" << fileSet.name << "'"; 
+                    throw TskException(msg.str());
+                }
+
+                // The contents of all of the EXCLUDE elements of a set share a NOT node.
+                const std::vector<size_t> &rootChildren = fileSet.ruleNodes[RULE_ROOT_NODE].children;
+                const size_t excludedNode = rootChildren.size() > 1 ? rootChildren[1] : addRuleNode(RuleNode(RuleNode::NOT), RULE_ROOT_NODE, fileSet);
+                const size_t excludedChildCount = fileSet.ruleNodes[excludedNode].children.size();
+                compileRuleElements(definition, excludedNode, fileSet);
+                if (fileSet.ruleNodes[excludedNode].children.size() == excludedChildCount)
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << "empty " << EXCLUDE_ELEMENT_TAG << " element in " << INTERESTING_FILE_SET_ELEMENT_TAG << " element '" << fileSet.name << "'"; 
+                    throw TskException(msg.str());
+                }
+                needsRule = true;
+            }
+            else
+            {
+                const size_t firstCondition = fileSet.scanConditions.size();
+                compileSearchCondition(definition, fileSet);
+
+                // A condition element that compiles to more than one condition is satisfied by any of them.
+                const size_t conditionParent = fileSet.scanConditions.size() - firstCondition > 1 ? addRuleNode(RuleNode(RuleNode::ANY), parentNode, fileSet) : parentNode;
+                for (size_t j = firstCondition; j < fileSet.scanConditions.size(); ++j)
+                {
+                    addRuleNode(RuleNode(RuleNode::CONDITION, j), conditionParent, fileSet);
+                }
+            }
+        }
+        return needsRule;
+    }
+
+    /** 
+     * Creates an InterestingFilesSet object from an an interesting files 
+     * set definition. 
+     *
+     * @param fileSetDefinition An interesting file set definition XML element.
+     * @param pack The name of the rule pack that defines the set, which 
+     * prefixes the name of the set, or the empty string.
+     */
+    void compileInterestingFilesSet(const Poco::XML::Node *fileSetDefinition, const std::string &pack)
+    {
+        // Create a counter for use in generating default interesting file set names.
+        static unsigned long defaultSetNumber = 1;
+
+        // Determine the name and description of the file set. Every file set must be named, but the description is optional.
+        // A default name is provided if omitted, so the parsing that follows logs warnings if unexpected attributes or values are parsed.
+        const std::string MSG_PREFIX = "InterestingFilesModule::compileInterestingFilesSet : ";
+        InterestingFilesSet fileSet;
+        if (fileSetDefinition->hasAttributes())
+        {
+            Poco::AutoPtr<Poco::XML::NamedNodeMap> attributes = fileSetDefinition->attributes(); 
+            for (unsigned long i = 0; i < attributes->length(); ++i)
+            {
+                Poco::XML::Node *attribute = attributes->item(i);
+                const std::string &attributeName = Poco::XML::fromXMLString(attribute->nodeName());                
+                const std::string &attributeValue = Poco::XML::fromXMLString(attribute->nodeValue());
+                if (!attributeValue.empty())
+                {
+                    if (attributeName == NAME_ATTRIBUTE)
+                    {        
+                        if (!attributeValue.empty())
+                        {
+                            fileSet.name = attributeValue;
+                        }
+                        else
+                        {
+                            std::ostringstream msg;
+                            msg << MSG_PREFIX << "ignored " << INTERESTING_FILE_SET_ELEMENT_TAG << "'" << NAME_ATTRIBUTE << "' attribute without a value"; 
+                            LOGWARN(msg.str());
+                        }
+                    }
+                    else if (attributeName == DESCRIPTION_ATTRIBUTE_TAG)
+                    {
+                        if (!attributeValue.empty())
+                        {
+                            fileSet.description = attributeValue;
+                        }
+                        else
+                        {
+                            std::ostringstream msg;
+                            msg << MSG_PREFIX << "ignored " << INTERESTING_FILE_SET_ELEMENT_TAG << "'" << DESCRIPTION_ATTRIBUTE_TAG << "' attribute without a value"; 
+                            LOGWARN(msg.str());
+                        }
+                    }
+                    else
+                    {
+                        std::ostringstream msg;
+                        msg << MSG_PREFIX << "ignored unrecognized " << INTERESTING_FILE_SET_ELEMENT_TAG << "'" << attributeName << "' attribute"; 
+                        LOGWARN(msg.str());
+                    }
+                }
+            }
+        }
+
+        if (fileSet.name.empty())
+        {
+            // Supply a default name.
+            std::stringstream nameBuilder;
+            nameBuilder << "Unnamed_" << defaultSetNumber++;
+            fileSet.name = nameBuilder.str();
+        }
+
+        // The file set name cannot contain a path character since it may be used later
+        // as a folder name by a save interesting files module.
+        if (fileSet.name.find_first_of("<>:\"/\\|?*") != std::string::npos)
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << INTERESTING_FILE_SET_ELEMENT_TAG << " element " << NAME_ATTRIBUTE << " attribute value '" << fileSet.name << "' contains file path character";
+            throw TskException(msg.str());
+        }
+
+        // The file set name cannot be shorthand for the a current directory or parent directory since it may be used later
+        // as a folder name by a save interesting files module.
+        if (fileSet.name == (".") || fileSet.name == (".."))
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << INTERESTING_FILE_SET_ELEMENT_TAG << " element " << NAME_ATTRIBUTE << " attribute value '" << fileSet.name << "' is directory alias";
+            throw TskException(msg.str());
+        }
+
+        // The sets of different rule packs may have the same names, so their names are prefixed by the pack name.
+        if (!pack.empty())
+        {
+            fileSet.name = pack + PACK_NAME_SEPARATOR + fileSet.name;
+        }
+
+        // Every file set must be uniquely named since it may be used later as a folder name by a save interesting files module.
+        if (!fileSetNames.insert(fileSet.name).second)
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "duplicate " << INTERESTING_FILE_SET_ELEMENT_TAG << " element " << NAME_ATTRIBUTE << " attribute value '" << fileSet.name << "'";
+            throw TskException(msg.str());
+        }
+
+        // Get the search conditions. Unless the set uses ALL, ANY, NOT or EXCLUDE elements, it has no rule.
+        fileSet.ruleNodes.push_back(RuleNode(RuleNode::ALL));
+        addRuleNode(RuleNode(RuleNode::ANY), RULE_ROOT_NODE, fileSet);
+        if (!compileRuleElements(fileSetDefinition, RULE_CONDITIONS_NODE, fileSet))
+        {
+            fileSet.ruleNodes.clear();
+        }
+        else if (fileSet.ruleNodes[RULE_CONDITIONS_NODE].children.empty())
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << INTERESTING_FILE_SET_ELEMENT_TAG << " element '" << fileSet.name << "' has no conditions besides its " << EXCLUDE_ELEMENT_TAG << " elements"; 
+            throw TskException(msg.str());
+        }
+
+        if (!fileSet.scanConditions.empty())
+        {
+            // The cached hits of the set are keyed by everything that decides them.
+            std::ostringstream definition;
+            definition << MODULE_VERSION << "\n" << fileSet.name << "\n" << fileSet.description << "\n";
+            describeDefinitionTree(fileSetDefinition, definition);
+            for (std::vector<Poco::SharedPtr<ScanCondition> >::const_iterator condition = fileSet.scanConditions.begin(); condition != fileSet.scanConditions.end(); ++condition)
+            {
+                definition << "\n" << (*condition)->getDataVersion();
+            }
+            fileSet.cacheKey = ResultCache::getKey(definition.str());
+
+            fileSet.isPushedDown.assign(fileSet.scanConditions.size(), false);
+            fileSets.push_back(fileSet);
+        }
+        else
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "empty " << INTERESTING_FILE_SET_ELEMENT_TAG << " element '" << fileSet.name << "'"; 
+            //throw TskException(msg.str());
+        }
+    }
+
+    /**
+     * Compiles the interesting files set definitions of a configuration file.
+     *
+     * @param path The path of the configuration file.
+     * @param isPack Whether the file is one of several rule packs, whose 
+     * sets are named after the pack.
+     */
+    void compileConfigFile(const std::string &path, bool isPack)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::compileConfigFile : ";
+
+        Poco::File configFile = Poco::File(path);
+        if (!configFile.exists())
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "config file'" << path << "' does not exist";
+            LOGERROR(msg.str());
+            return;
+        }
+
+        std::ifstream configStream(configFile.path().c_str());
+        if (!configStream)
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "failed to open config file '" << path << "'";
+            throw TskException(msg.str());
+        }
+
+        packFilePath = path;
+        const size_t firstFileSet = fileSets.size();
+        Poco::AutoPtr<Poco::XML::Document> configDoc = Poco::XML::DOMParser().parse(&Poco::XML::InputSource(configStream));
+        const Poco::XML::Element *configuration = configDoc->documentElement();
+        parseConfigurationOptions(configuration);
+
+        // A pack is named by the pack attribute of its configuration, or else by its file name, in which the separator is
+        // replaced.
+        std::string pack;
+        if (configuration != NULL && configuration->hasAttribute(PACK_ATTRIBUTE))
+        {
+            pack = Poco::XML::fromXMLString(configuration->getAttribute(PACK_ATTRIBUTE));
+        }
+        else if (isPack)
+        {
+            pack = Poco::Path(path).getBaseName();
+            Poco::replaceInPlace(pack, PACK_NAME_SEPARATOR, std::string("_"));
+        }
+        if ((configuration != NULL && configuration->hasAttribute(PACK_ATTRIBUTE) && pack.empty()) || pack.find_first_of("<>:\"/\\|?*") != std::string::npos ||
+            pack.find(PACK_NAME_SEPARATOR) != std::string::npos)
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "invalid " << PACK_ATTRIBUTE << " attribute value '" << pack << "' in config file '" << path << "'";
+            throw TskException(msg.str());
+        }
+
+        // Two packs with the same name, such as two config files with the same file name in different folders, would name
+        // their sets alike.
+        if (!pack.empty() && !packNames.insert(pack).second)
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "duplicate rule pack name '" << pack << "' of config file '" << path << "'";
+            throw TskException(msg.str());
+        }
+
+        Poco::AutoPtr<Poco::XML::NodeList> fileSetDefinitions = configDoc->getElementsByTagName(INTERESTING_FILE_SET_ELEMENT_TAG);
+        for (unsigned long i = 0; i < fileSetDefinitions->length(); ++i) 
+        {
+            compileInterestingFilesSet(fileSetDefinitions->item(i), pack);
+        }
+
+        std::ostringstream msg;
+        msg << MSG_PREFIX << "compiled " << fileSets.size() - firstFileSet << " interesting file set definitions" 
+            << (pack.empty() ? "" : " of rule pack " + pack) << " from '" << path << "'";
+        LOGINFO(msg.str());
+    }
+
+    /**
+     * Posts an interesting file hit to the blackboard.
+     *
+     * @param fileId The file id of the file that belongs to the set.
+     * @param fileSet The interesting files set the file belongs to.
+     */
+    void postInterestingFileHit(uint64_t fileId, const InterestingFilesSet &fileSet)
+    {
+        TskBlackboardArtifact artifact = TskServices::Instance().getBlackboard().createArtifact(fileId, TSK_INTERESTING_FILE_HIT);
+        TskBlackboardAttribute attribute(TSK_SET_NAME, ARTIFACT_SOURCE, fileSet.description, fileSet.name);
+        artifact.addAttribute(attribute);
+    }
+
+    /**
+     * A file that satisfies the file record part of a content condition of an
+     * interesting files set. Whether the file belongs to the set depends on its
+     * content.
+     */
+    struct ContentCandidate
+    {
+        ContentCandidate(uint64_t fileId, size_t fileSetIndex, size_t conditionIndex, const std::string &contentHash = "") : 
+            fileId(fileId), fileSetIndex(fileSetIndex), conditionIndex(conditionIndex), contentHash(contentHash)
+        {
+        }
+
+        bool operator<(const ContentCandidate &other) const
+        {
+            return fileId < other.fileId;
+        }
+
+        uint64_t fileId;
+        size_t fileSetIndex;
+        size_t conditionIndex;
+
+        // The hash of the file's content as the content cache keys it, or the empty string if there is no cache or the 
+        // content has no hash.
+        std::string contentHash;
+    };
+
+    /**
+     * Gets the hash of a file's content as the content cache keys it: the 
+     * strongest hash the hashing modules computed, prefixed by the name of 
+     * its algorithm.
+     *
+     * @return The hash, or the empty string if the file has none.
+     */
+    std::string getContentHash(const TskFileRecord &fileRecord)
+    {
+        if (!fileRecord.sha2_256.empty())
+        {
+            return "sha256:" + Poco::toLower(fileRecord.sha2_256);
+        }
+        if (!fileRecord.sha1.empty())
+        {
+            return "sha1:" + Poco::toLower(fileRecord.sha1);
+        }
+        if (!fileRecord.md5.empty())
+        {
+            return "md5:" + Poco::toLower(fileRecord.md5);
+        }
+        return "";
+    }
+
+    /**
+     * Creates the sets that hold the hits of each condition of each 
+     * interesting files set, in the same order as the sets and their 
+     * conditions. A file that satisfies a condition is a hit of the 
+     * condition, and the file belongs to the condition's set.
+     */
+    void createHitSets(std::vector<std::vector<FileIdSet> > &hits)
+    {
+        hits.resize(fileSets.size());
+        for (size_t i = 0; i < fileSets.size(); ++i)
+        {
+            hits[i].resize(fileSets[i].scanConditions.size());
+        }
+    }
+
+    /**
+     * Selects files from the image database with queries that each list a 
+     * batch of file ids.
+     *
+     * @param fileIds The file ids to list.
+     * @param conditionPrefix The part of the search condition of the queries
+     * before the list of file ids, which is followed by the list in 
+     * parentheses.
+     * @param conditionSuffix The part of the search condition after the list.
+     * @param selectedFiles The selected files are added to this set.
+     */
+    void selectFilesByFileIds(const FileIdSet &fileIds, const std::string &conditionPrefix, const std::string &conditionSuffix, FileIdSet &selectedFiles)
+    {
+        FileIdSet::Iterator fileId(fileIds);
+        while (!fileId.atEnd())
+        {
+            std::ostringstream condition;
+            condition << "WHERE " << conditionPrefix << " (";
+            for (size_t i = 0; i < FILE_ID_BATCH_SIZE && !fileId.atEnd(); ++i, fileId.next())
+            {
+                condition << (i == 0 ? "" : ", ") << fileId.get();
+            }
+            condition << ")" << conditionSuffix << " ORDER BY file_id";
+
+            std::vector<uint64_t> selectedFileIds = TskServices::Instance().getImgDB().getFileIds(condition.str());
+            for (std::vector<uint64_t>::const_iterator selectedFileId = selectedFileIds.begin(); selectedFileId != selectedFileIds.end(); ++selectedFileId)
+            {
+                selectedFiles.add(*selectedFileId);
+            }
+        }
+    }
+
+    /**
+     * Gets the directories that directly contain any of a set of files. The 
+     * files are grouped by directory in the image database, so each 
+     * directory is returned once no matter how many of the files it holds.
+     */
+    void getParentDirectories(const FileIdSet &files, FileIdSet &directories)
+    {
+        directories.clear();
+        selectFilesByFileIds(files, "file_id IN (SELECT DISTINCT par_file_id FROM files WHERE file_id IN", ")", directories);
+    }
+
+    /**
+     * Gets the files that are directly in any of a set of directories.
+     */
+    void getDirectoryFiles(const FileIdSet &directories, FileIdSet &files)
+    {
+        files.clear();
+        selectFilesByFileIds(directories, "par_file_id IN", "", files);
+    }
+
+    /**
+     * Evaluates a node of the rule of an interesting files set.
+     *
+     * @param fileSet The interesting files set.
+     * @param node The index of the rule node.
+     * @param fileSetHits The hits of each of the set's conditions.
+     * @param files Receives the files that satisfy the node. The files that
+     * satisfy a NOT node are those that satisfy any of its children; the ALL
+     * node that is its parent removes them.
+     * @param derivedHits The files selected by SIBLINGS, CONTAINS and WITHIN
+     * nodes are added to the hits of the nodes' conditions in these sets.
+     */
+    void evaluateRule(const InterestingFilesSet &fileSet, size_t node, const std::vector<FileIdSet> &fileSetHits, FileIdSet &files, std::vector<FileIdSet> &derivedHits)
+    {
+        const RuleNode &ruleNode = fileSet.ruleNodes[node];
+        if (ruleNode.type == RuleNode::CONDITION)
+        {
+            files = fileSetHits[ruleNode.conditionIndex];
+            return;
+        }
+
+        // The timestamps of the files that satisfy the children are looked up in the timestamp index all at once.
+        if (ruleNode.type == RuleNode::WITHIN)
+        {
+            FileIdSet childFiles;
+            FileIdSet anchorFiles;
+            for (std::vector<size_t>::const_iterator child = ruleNode.children.begin(); child != ruleNode.children.end(); ++child)
+            {
+                evaluateRule(fileSet, *child, fileSetHits, childFiles, derivedHits);
+                anchorFiles.unite(childFiles);
+            }
+            timestampIndexes[ruleNode.timestamp].findNear(anchorFiles, ruleNode.seconds, files);
+            derivedHits[ruleNode.conditionIndex].unite(files);
+            return;
+        }
+
+        // The directories of the files that satisfy the children are found once per node, rather than once per file.
+        if (ruleNode.type == RuleNode::SIBLINGS || ruleNode.type == RuleNode::CONTAINS)
+        {
+            FileIdSet childFiles;
+            FileIdSet anchorFiles;
+            FileIdSet directories;
+            FileIdSet childDirectories;
+            for (std::vector<size_t>::const_iterator child = ruleNode.children.begin(); child != ruleNode.children.end(); ++child)
+            {
+                evaluateRule(fileSet, *child, fileSetHits, childFiles, derivedHits);
+                if (ruleNode.type == RuleNode::SIBLINGS)
+                {
+                    anchorFiles.unite(childFiles);
+                    continue;
+                }
+
+                getParentDirectories(childFiles, childDirectories);
+                if (child == ruleNode.children.begin())
+                {
+                    directories = childDirectories;
+                }
+                else
+                {
+                    directories.intersect(childDirectories);
+                }
+                if (directories.empty())
+                {
+                    break;
+                }
+            }
+
+            if (ruleNode.type == RuleNode::SIBLINGS)
+            {
+                getParentDirectories(anchorFiles, directories);
+                getDirectoryFiles(directories, files);
+            }
+            else
+            {
+                files = directories;
+            }
+            derivedHits[ruleNode.conditionIndex].unite(files);
+            return;
+        }
+
+        files.clear();
+        bool isFirstChild = true;
+        FileIdSet childFiles;
+        for (std::vector<size_t>::const_iterator child = ruleNode.children.begin(); child != ruleNode.children.end(); ++child)
+        {
+            if (ruleNode.type == RuleNode::ALL && fileSet.ruleNodes[*child].type == RuleNode::NOT)
+            {
+                continue;
+            }
+
+            evaluateRule(fileSet, *child, fileSetHits, childFiles, derivedHits);
+            if (ruleNode.type != RuleNode::ALL || isFirstChild)
+            {
+                files.unite(childFiles);
+            }
+            else
+            {
+                files.intersect(childFiles);
+            }
+            isFirstChild = false;
+        }
+
+        // The NOT children of an ALL node are evaluated last, and only if there are files left to remove them from.
+        if (ruleNode.type == RuleNode::ALL)
+        {
+            for (std::vector<size_t>::const_iterator child = ruleNode.children.begin(); child != ruleNode.children.end() && !files.empty(); ++child)
+            {
+                if (fileSet.ruleNodes[*child].type == RuleNode::NOT)
+                {
+                    evaluateRule(fileSet, *child, fileSetHits, childFiles, derivedHits);
+                    files.subtract(childFiles);
+                }
+            }
+        }
+    }
+
+    /**
+     * Gets the hits of the conditions of an interesting files set that are 
+     * posted, so that a file is posted once per set no matter how many of 
+     * the set's conditions it satisfies. A file is posted for the first of 
+     * the set's conditions that it satisfies. If the set has a rule, only 
+     * the files that satisfy the rule are posted, along with the files that
+     * the rule's SIBLINGS, CONTAINS and WITHIN nodes select.
+     *
+     * @param fileSet The interesting files set.
+     * @param fileSetHits The hits of each of the set's conditions.
+     * @param postedHits Receives the posted hits of each of the set's 
+     * conditions.
+     */
+    void getPostedHits(const InterestingFilesSet &fileSet, const std::vector<FileIdSet> &fileSetHits, std::vector<FileIdSet> &postedHits)
+    {
+        postedHits = fileSetHits;
+        if (fileSet.hasRule())
+        {
+            FileIdSet ruleFiles;
+            evaluateRule(fileSet, RULE_ROOT_NODE, fileSetHits, ruleFiles, postedHits);
+            for (std::vector<FileIdSet>::iterator conditionHits = postedHits.begin(); conditionHits != postedHits.end(); ++conditionHits)
+            {
+                conditionHits->intersect(ruleFiles);
+            }
+        }
+
+        FileIdSet earlierHits;
+        for (std::vector<FileIdSet>::iterator conditionHits = postedHits.begin(); conditionHits != postedHits.end(); ++conditionHits)
+        {
+            conditionHits->subtract(earlierHits);
+            earlierHits.unite(*conditionHits);
+        }
+    }
+
+    /**
+     * Gets the number of bytes of memory held by the hits.
+     */
+    uint64_t getHitBytes(const std::vector<std::vector<FileIdSet> > &hits)
+    {
+        uint64_t bytes = 0;
+        for (std::vector<std::vector<FileIdSet> >::const_iterator fileSetHits = hits.begin(); fileSetHits != hits.end(); ++fileSetHits)
+        {
+            for (std::vector<FileIdSet>::const_iterator conditionHits = fileSetHits->begin(); conditionHits != fileSetHits->end(); ++conditionHits)
+            {
+                bytes += conditionHits->getBytes();
+            }
+        }
+        return bytes;
+    }
+
+    /**
+     * Measurements of the scan of the file records that is shared by all of 
+     * the scan conditions, and of the whole of report().
+     */
+    ConditionMetrics scanMetrics;
+    double reportSeconds = 0.0;
+
+    /**
+     * Gets the number of bytes of memory held by a file record.
+     */
+    uint64_t getFileRecordBytes(const TskFileRecord &fileRecord)
+    {
+        return sizeof(TskFileRecord) + fileRecord.name.capacity() + fileRecord.fullPath.capacity() + 
+            fileRecord.md5.capacity() + fileRecord.sha1.capacity() + fileRecord.sha2_256.capacity();
+    }
+
+    /**
+     * Compares a file record to a file id, for searching file records sorted
+     * by file id.
+     */
+    bool hasLowerFileId(const TskFileRecord &fileRecord, uint64_t fileId)
+    {
+        return fileRecord.fileId < fileId;
+    }
+
+    /**
+     * Determines whether the image database is the SQLite image database, 
+     * which the module can also open directly.
+     */
+    bool hasSqliteImageDatabase()
+    {
+        return dynamic_cast<TskImgDBSqlite *>(&TskServices::Instance().getImgDB()) != NULL;
+    }
+
+    /**
+     * Gets the path of the SQLite image database.
+     */
+    std::string getImageDatabasePath()
+    {
+        return Poco::Path(Poco::Path::forDirectory(GetSystemProperty(TskSystemProperties::OUT_DIR)), IMAGE_DATABASE_FILE_NAME).toString();
+    }
+
+    /**
+     * Gets where the content of each of a list of files starts in the image,
+     * which only serves to sort the reads of the files. With the SQLite image
+     * database the block runs of the files are queried a batch of files at a
+     * time; otherwise, or if that fails, the image database is asked for the
+     * sector runs of each file.
+     *
+     * @param fileIds The file ids of the files, in ascending order.
+     * @param reads Receives the start of the content of each file, or the 
+     * largest possible value if the content is not stored in blocks (e.g. 
+     * resident files), paired with its file id.
+     */
+    void getImageOffsets(const std::vector<uint64_t> &fileIds, std::vector<std::pair<uint64_t, uint64_t> > &reads)
+    {
+        const uint64_t NO_OFFSET = static_cast<uint64_t>(-1);
+
+        reads.clear();
+        if (hasSqliteImageDatabase())
+        {
+            try
+            {
+                SqliteConnection connection(getImageDatabasePath(), true);
+                for (size_t start = 0; start < fileIds.size(); start += FILE_ID_BATCH_SIZE)
+                {
+                    const size_t end = std::min(fileIds.size(), start + FILE_ID_BATCH_SIZE);
+                    std::ostringstream query;
+                    query << IMAGE_OFFSETS_QUERY_PREFIX;
+                    for (size_t i = start; i < end; ++i)
+                    {
+                        query << (i == start ? "" : ", ") << fileIds[i];
+                    }
+                    query << IMAGE_OFFSETS_QUERY_SUFFIX;
+
+                    // Files without block runs have no row.
+                    SqliteStatement offsetsQuery(connection, query.str());
+                    size_t i = start;
+                    while (offsetsQuery.step())
+                    {
+                        const uint64_t fileId = static_cast<uint64_t>(sqlite3_column_int64(offsetsQuery.get(), 0));
+                        for (; i < end && fileIds[i] < fileId; ++i)
+                        {
+                            reads.push_back(std::make_pair(NO_OFFSET, fileIds[i]));
+                        }
+                        if (i < end && fileIds[i] == fileId)
+                        {
+                            reads.push_back(std::make_pair(static_cast<uint64_t>(sqlite3_column_int64(offsetsQuery.get(), 2)), fileId));
+                            ++i;
+                        }
+                    }
+                    for (; i < end; ++i)
+                    {
+                        reads.push_back(std::make_pair(NO_OFFSET, fileIds[i]));
+                    }
+                }
+                return;
+            }
+            catch (TskException &ex)
+            {
+                std::ostringstream msg;
+                msg << "InterestingFilesModule::getImageOffsets : looking up the sector runs of each file instead: " << ex.message();
+                LOGWARN(msg.str());
+                reads.clear();
+            }
+        }
+
+        for (std::vector<uint64_t>::const_iterator fileId = fileIds.begin(); fileId != fileIds.end(); ++fileId)
+        {
+            std::auto_ptr<SectorRuns> sectorRuns(TskServices::Instance().getImgDB().getFileSectors(*fileId));
+            reads.push_back(std::make_pair(sectorRuns.get() != NULL && sectorRuns->begin() != -1 ? sectorRuns->getDataStart() : NO_OFFSET, *fileId));
+        }
+    }
+
+    /**
+     * Reads the first bytes of a file.
+     *
+     * @param fileId The file id of the file.
+     * @param header Receives the bytes read, resized to the number of bytes 
+     * read.
+     * @param headerLength The number of bytes to read.
+     * @return True if the whole header was read, that is, the number of 
+     * bytes asked for or the whole of a shorter file.
+     */
+    bool readFileHeader(uint64_t fileId, std::vector<unsigned char> &header, size_t headerLength)
+    {
+        header.resize(headerLength);
+        std::auto_ptr<TskFile> file(TskServices::Instance().getFileManager().getFile(fileId));
+        file->open();
+        const ssize_t bytesRead = file->read(reinterpret_cast<char *>(&header[0]), headerLength);
+        const TSK_OFF_T fileSize = file->getSize();
+        file->close();
+        header.resize(bytesRead > 0 ? static_cast<size_t>(bytesRead) : 0);
+        return fileSize >= 0 && header.size() == std::min<uint64_t>(headerLength, static_cast<uint64_t>(fileSize));
+    }
+
+    /**
+     * Opens the content cache, if the configuration file names one.
+     *
+     * @return The content cache, or NULL if matches are not cached.
+     */
+    ContentCache *openContentCache()
+    {
+        if (contentCachePath.empty())
+        {
+            return NULL;
+        }
+
+        try
+        {
+            return new ContentCache(contentCachePath, ResultCache::getKey(signatures.describe()));
+        }
+        catch (TskException &ex)
+        {
+            std::ostringstream msg;
+            msg << "InterestingFilesModule::openContentCache : the content cache is not used: " << ex.message();
+            LOGWARN(msg.str());
+            return NULL;
+        }
+    }
+
+    /**
+     * Adds a file to the hits of the content conditions it is a candidate 
+     * for whose content part its header satisfies.
+     *
+     * @param fileCandidates The candidates of the file.
+     * @param signatureMatches The signatures that match the file's header.
+     * @param hits Receives the hits.
+     */
+    void addContentHits(const std::pair<std::vector<ContentCandidate>::const_iterator, std::vector<ContentCandidate>::const_iterator> &fileCandidates, 
+        const std::vector<bool> &signatureMatches, std::vector<std::vector<FileIdSet> > &hits)
+    {
+        size_t lastHitFileSetIndex = static_cast<size_t>(-1);
+        for (std::vector<ContentCandidate>::const_iterator candidate = fileCandidates.first; candidate != fileCandidates.second; ++candidate)
+        {
+            // The rule of a set needs to know every condition of the set that a file satisfies.
+            if (candidate->fileSetIndex != lastHitFileSetIndex && 
+                fileSets[candidate->fileSetIndex].scanConditions[candidate->conditionIndex]->matchesContent(signatureMatches))
+            {
+                hits[candidate->fileSetIndex][candidate->conditionIndex].add(candidate->fileId);
+                ++fileSets[candidate->fileSetIndex].scanConditionMetrics[candidate->conditionIndex].hits;
+                if (!fileSets[candidate->fileSetIndex].hasRule())
+                {
+                    lastHitFileSetIndex = candidate->fileSetIndex;
+                }
+            }
+        }
+    }
+
+    /**
+     * Evaluates the content part of the content conditions for the files that
+     * satisfy the file record part of the conditions. Only the headers of the 
+     * files are read, and the reads are sorted by the location of the file 
+     * content in the image so that the image is read almost sequentially.
+     * Files whose content the content cache already knows are not read at 
+     * all.
+     *
+     * @param candidates The files that satisfy the file record part of a 
+     * content condition, in file id order.
+     * @param hits The files that satisfy the conditions are added to the hits
+     * of their interesting file sets.
+     */
+    void findContentHits(const std::vector<ContentCandidate> &candidates, std::vector<std::vector<FileIdSet> > &hits)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::findContentHits : ";
+
+        if (candidates.empty())
+        {
+            return;
+        }
+
+        std::auto_ptr<ContentCache> contentCache(openContentCache());
+        std::vector<bool> signatureMatches;
+        std::vector<uint64_t> readFileIds;
+        for (std::vector<ContentCandidate>::const_iterator candidate = candidates.begin(); candidate != candidates.end(); ++candidate)
+        {
+            // The candidates of a file are adjacent, and the first one stands for them all.
+            if (candidate != candidates.begin() && (candidate - 1)->fileId == candidate->fileId)
+            {
+                continue;
+            }
+
+            if (contentCache.get() != NULL && !candidate->contentHash.empty())
+            {
+                try
+                {
+                    if (contentCache->find(candidate->contentHash, signatures.size(), signatureMatches))
+                    {
+                        addContentHits(std::equal_range(candidates.begin(), candidates.end(), *candidate), signatureMatches, hits);
+                        continue;
+                    }
+                }
+                catch (TskException &ex)
+                {
+                    std::ostringstream msg;
+                    msg << MSG_PREFIX << "the content cache is not used: " << ex.message();
+                    LOGWARN(msg.str());
+                    contentCache.reset();
+                }
+            }
+            readFileIds.push_back(candidate->fileId);
+        }
+        std::vector<std::pair<uint64_t, uint64_t> > reads;
+        getImageOffsets(readFileIds, reads);
+        std::sort(reads.begin(), reads.end());
+
+        std::vector<unsigned char> header;
+        uint64_t failedReadCount = 0;
+        for (std::vector<std::pair<uint64_t, uint64_t> >::const_iterator read = reads.begin(); read != reads.end(); ++read)
+        {
+            const uint64_t fileId = read->second;
+            std::pair<std::vector<ContentCandidate>::const_iterator, std::vector<ContentCandidate>::const_iterator> fileCandidates = 
+                std::equal_range(candidates.begin(), candidates.end(), ContentCandidate(fileId, 0, 0));
+
+            // The time taken to read and match a file header is shared by the conditions that needed it.
+            Poco::Timestamp start;
+            bool isRead = false;
+            bool isMatched = false;
+            try
+            {
+                // What was read of a header that could not be read whole is still matched, but counts as a failed read
+                // and is not cached, since the whole header might match other signatures.
+                header.clear();
+                isRead = readFileHeader(fileId, header, signatures.getHeaderLength());
+                isMatched = !header.empty() && signatures.match(&header[0], header.size(), signatureMatches);
+            }
+            catch (TskException &)
+            {
+                // Do not let one unreadable file prevent the rest from being checked. 
+                isRead = false;
+            }
+            if (!isRead)
+            {
+                ++failedReadCount;
+            }
+
+            const double secondsPerCandidate = start.elapsed() / 1000000.0 / (fileCandidates.second - fileCandidates.first);
+            for (std::vector<ContentCandidate>::const_iterator candidate = fileCandidates.first; candidate != fileCandidates.second; ++candidate)
+            {
+                ConditionMetrics &metrics = fileSets[candidate->fileSetIndex].scanConditionMetrics[candidate->conditionIndex];
+                metrics.seconds += secondsPerCandidate;
+                metrics.bytesAllocated += header.size();
+            }
+
+            if (contentCache.get() != NULL && isRead && !fileCandidates.first->contentHash.empty())
+            {
+                if (!isMatched)
+                {
+                    signatureMatches.assign(signatures.size(), false);
+                }
+                contentCache->add(fileCandidates.first->contentHash, signatureMatches);
+            }
+
+            if (isMatched)
+            {
+                addContentHits(fileCandidates, signatureMatches, hits);
+            }
+        }
+
+        std::ostringstream msg;
+        msg << MSG_PREFIX << "read the headers of " << reads.size() << " files";
+        if (contentCache.get() != NULL)
+        {
+            try
+            {
+                contentCache->flush();
+                msg << ", found " << contentCache->getFoundCount() << " in the content cache and added " << contentCache->getAddedCount();
+            }
+            catch (TskException &ex)
+            {
+                std::ostringstream flushMsg;
+                flushMsg << MSG_PREFIX << "failed to add to the content cache: " << ex.message();
+                LOGWARN(flushMsg.str());
+            }
+        }
+        LOGINFO(msg.str());
+
+        if (failedReadCount != 0)
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "failed to read the headers of " << failedReadCount << " files";
+            LOGWARN(msg.str());
+        }
+    }
+
+    /**
+     * Loads the directories of the image into the directory tree.
+     */
+    void loadDirectoryTree()
+    {
+        directories.clear();
+
+        uint64_t lastFileId = 0;
+        while (true)
+        {
+            std::stringstream condition;
+            condition << "WHERE f.file_id > " << lastFileId << " AND f.meta_type = " << TSK_FS_META_TYPE_DIR << " ORDER BY f.file_id LIMIT " << FILE_RECORD_BATCH_SIZE;
+            std::vector<TskFileRecord> fileRecords = TskServices::Instance().getImgDB().getFileRecords(condition.str());
+            if (fileRecords.empty())
+            {
+                break;
+            }
+
+            for (std::vector<TskFileRecord>::const_iterator fileRecord = fileRecords.begin(); fileRecord != fileRecords.end(); ++fileRecord)
+            {
+                directories.add(fileRecord->fileId, fileRecord->parentFileId, Poco::toUpper(fileRecord->name));
+            }
+            lastFileId = fileRecords.back().fileId;
+        }
+
+        directories.build();
+
+        std::ostringstream msg;
+        msg << "InterestingFilesModule::loadDirectoryTree : loaded " << directories.size() << " directories";
+        LOGINFO(msg.str());
+    }
+
+    /**
+     * Loads the timestamps of the files of the image into the timestamp 
+     * index of each kind of timestamp that some WITHIN element compares, 
+     * all in one pass over the file records.
+     */
+    void loadTimestampIndexes()
+    {
+        bool isNeeded[FILE_TIMESTAMP_COUNT] = { false, false, false, false };
+        bool isAnyNeeded = false;
+        for (int i = 0; i < FILE_TIMESTAMP_COUNT; ++i)
+        {
+            timestampIndexes[i].clear();
+        }
+        for (std::vector<InterestingFilesSet>::const_iterator fileSet = fileSets.begin(); fileSet != fileSets.end(); ++fileSet)
+        {
+            for (std::vector<RuleNode>::const_iterator ruleNode = fileSet->ruleNodes.begin(); ruleNode != fileSet->ruleNodes.end(); ++ruleNode)
+            {
+                if (ruleNode->type == RuleNode::WITHIN)
+                {
+                    isNeeded[ruleNode->timestamp] = true;
+                    isAnyNeeded = true;
+                }
+            }
+        }
+        if (!isAnyNeeded)
+        {
+            return;
+        }
+
+        uint64_t lastFileId = 0;
+        while (true)
+        {
+            std::stringstream condition;
+            condition << "WHERE f.file_id > " << lastFileId << " ORDER BY f.file_id LIMIT " << FILE_RECORD_BATCH_SIZE;
+            std::vector<TskFileRecord> fileRecords = TskServices::Instance().getImgDB().getFileRecords(condition.str());
+            if (fileRecords.empty())
+            {
+                break;
+            }
+
+            for (std::vector<TskFileRecord>::const_iterator fileRecord = fileRecords.begin(); fileRecord != fileRecords.end(); ++fileRecord)
+            {
+                const time_t timestamps[FILE_TIMESTAMP_COUNT] = { fileRecord->crtime, fileRecord->mtime, fileRecord->atime, fileRecord->ctime };
+                for (int i = 0; i < FILE_TIMESTAMP_COUNT; ++i)
+                {
+                    if (isNeeded[i])
+                    {
+                        timestampIndexes[i].add(fileRecord->fileId, static_cast<int64_t>(timestamps[i]));
+                    }
+                }
+            }
+            lastFileId = fileRecords.back().fileId;
+        }
+
+        uint64_t bytes = 0;
+        for (int i = 0; i < FILE_TIMESTAMP_COUNT; ++i)
+        {
+            timestampIndexes[i].build();
+            bytes += timestampIndexes[i].getBytes();
+        }
+
+        std::ostringstream msg;
+        msg << "InterestingFilesModule::loadTimestampIndexes : loaded the timestamps of files in " << bytes << " bytes";
+        LOGINFO(msg.str());
+    }
+
+    /**
+     * Brings the file name index up to date, if the configuration file asks 
+     * for it or for the trigram index and some condition can use it. The 
+     * index is kept in the image database, so it can only be used with the 
+     * SQLite image database. If the index cannot be used the conditions are 
+     * evaluated without it.
+     */
+    void updateFileNameIndex()
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::updateFileNameIndex : ";
+
+        fileNameIndex.clear();
+        if (!useFileNameIndex && !useTrigramIndex)
+        {
+            return;
+        }
+
+        bool hasIndexableConditions = false;
+        for (std::vector<InterestingFilesSet>::const_iterator fileSet = fileSets.begin(); fileSet != fileSets.end(); ++fileSet)
+        {
+            for (std::vector<Poco::SharedPtr<ScanCondition> >::const_iterator condition = fileSet->scanConditions.begin(); condition != fileSet->scanConditions.end(); ++condition)
+            {
+                hasIndexableConditions = hasIndexableConditions || (*condition)->canUseFileNameIndex();
+            }
+        }
+        if (!hasIndexableConditions)
+        {
+            return;
+        }
+
+        if (!hasSqliteImageDatabase())
+        {
+            LOGWARN(MSG_PREFIX + "the file name index requires the SQLite image database and is not used");
+            return;
+        }
+
+        try
+        {
+            Poco::Timestamp start;
+            const uint64_t addedFileCount = fileNameIndex.update(getImageDatabasePath(), useTrigramIndex);
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "added " << addedFileCount << " files to the file name index in " << start.elapsed() / 1000000.0 << " s";
+            LOGINFO(msg.str());
+        }
+        catch (TskException &ex)
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "the file name index is not used: " << ex.message();
+            LOGWARN(msg.str());
+        }
+    }
+
+    /**
+     * Samples file records from places spread evenly over the file ids of the
+     * files table.
+     *
+     * @param sample Receives the sampled file records.
+     */
+    void sampleFileRecords(std::vector<TskFileRecord> &sample)
+    {
+        std::vector<TskFileRecord> lastFileRecord = TskServices::Instance().getImgDB().getFileRecords("WHERE f.file_id > 0 ORDER BY f.file_id DESC LIMIT 1");
+        if (lastFileRecord.empty())
+        {
+            return;
+        }
+
+        const uint64_t lastFileId = lastFileRecord.front().fileId;
+        uint64_t lastSampledFileId = 0;
+        for (int i = 0; i < PLANNER_SAMPLE_COUNT; ++i)
+        {
+            std::stringstream condition;
+            condition << "WHERE f.file_id > " << std::max(lastSampledFileId, lastFileId / PLANNER_SAMPLE_COUNT * i) << " ORDER BY f.file_id LIMIT " << PLANNER_SAMPLE_SIZE;
+            std::vector<TskFileRecord> fileRecords = TskServices::Instance().getImgDB().getFileRecords(condition.str());
+            if (fileRecords.empty())
+            {
+                break;
+            }
+
+            sample.insert(sample.end(), fileRecords.begin(), fileRecords.end());
+            lastSampledFileId = fileRecords.back().fileId;
+        }
+    }
+
+    /**
+     * Estimates the fraction of the files in the image that satisfy a 
+     * condition from a sample of the file records.
+     */
+    double estimateSelectivity(const ScanCondition &condition, const std::vector<TskFileRecord> &sample)
+    {
+        uint64_t matchCount = 0;
+        for (std::vector<TskFileRecord>::const_iterator fileRecord = sample.begin(); fileRecord != sample.end(); ++fileRecord)
+        {
+            ScannedFile file(*fileRecord);
+            if (condition.matches(file))
+            {
+                ++matchCount;
+            }
+        }
+
+        // A sample cannot show that no file, or every file, satisfies the condition.
+        return (matchCount + 0.5) / (sample.size() + 1.0);
+    }
+
+    /**
+     * Decides which of the conditions that the image database can evaluate on
+     * its own are pushed down to it, and which are evaluated in the scan.
+     *
+     * A pushed down condition is a query of its own. The name conditions are
+     * case insensitive, so unless the query is a lookup in the file name 
+     * index it visits every row of the files table, but it only returns file
+     * ids. A condition left in the scan adds no visits of its own, but every 
+     * file that satisfies it is returned as a whole file record, unless the 
+     * scan reads every file record anyway. So conditions that many files 
+     * satisfy are pushed down and the rest are batched into the scan, which 
+     * is only worthwhile if the scan saves more than it costs. How many files 
+     * satisfy each condition is estimated from a sample of the file records.
+     */
+    void planSearchConditions()
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::planSearchConditions : ";
+
+        Poco::Timestamp start;
+
+        // Find out whether there is a scan no matter what is pushed down, and whether it reads every file record.
+        bool hasScan = false;
+        bool scanAllFiles = false;
+        for (std::vector<InterestingFilesSet>::const_iterator fileSet = fileSets.begin(); fileSet != fileSets.end(); ++fileSet)
+        {
+            for (std::vector<Poco::SharedPtr<ScanCondition> >::const_iterator condition = fileSet->scanConditions.begin(); condition != fileSet->scanConditions.end(); ++condition)
+            {
+                if ((*condition)->getSearchCondition().empty())
+                {
+                    hasScan = true;
+                    scanAllFiles = scanAllFiles || (*condition)->getCandidateFilesCondition().empty();
+                }
+            }
+        }
+
+        const double fileCount = TskServices::Instance().getImgDB().getFileCount("");
+        std::vector<TskFileRecord> sample;
+        sampleFileRecords(sample);
+
+        // A scan run with the match function calls it for every file, and only returns the records of the files that 
+        // satisfy some scan condition.
+        const bool scanUsesMatchFunction = useMatchFunction && hasSqliteImageDatabase();
+        double pushDownCost = 0.0;
+        double planCost = hasScan ? 0.0 : QUERY_COST + fileCount * (scanUsesMatchFunction ? TABLE_ROW_COST + MATCH_FUNCTION_COST : TABLE_ROW_COST);
+        std::vector<std::vector<double> > estimatedFileCounts(fileSets.size());
+        for (size_t i = 0; i < fileSets.size(); ++i)
+        {
+            InterestingFilesSet &fileSet = fileSets[i];
+            estimatedFileCounts[i].assign(fileSet.scanConditions.size(), 0.0);
+            for (size_t j = 0; j < fileSet.scanConditions.size(); ++j)
+            {
+                fileSet.isPushedDown[j] = false;
+                if (fileSet.scanConditions[j]->getSearchCondition().empty())
+                {
+                    continue;
+                }
+
+                // A condition looked up in the file name index only visits the index entries that the lookup needs.
+                const double estimatedFileCount = estimateSelectivity(*fileSet.scanConditions[j], sample) * fileCount;
+                const double indexLookupRows = fileSet.scanConditions[j]->getIndexLookupRows(estimatedFileCount);
+                const double databaseCost = indexLookupRows >= 0.0 ?
+                    QUERY_COST + indexLookupRows * INDEX_LOOKUP_COST + estimatedFileCount * FILE_ID_COST :
+                    QUERY_COST + fileCount * (TABLE_ROW_COST + SQL_CONDITION_COST) + estimatedFileCount * FILE_ID_COST;
+                const double scanCost = scanUsesMatchFunction ? fileCount * SCAN_CONDITION_COST + estimatedFileCount * (FILE_RECORD_COST + SCAN_CONDITION_COST) :
+                    scanAllFiles ? fileCount * SCAN_CONDITION_COST : 
+                    fileCount * SQL_CONDITION_COST + estimatedFileCount * (FILE_RECORD_COST + SCAN_CONDITION_COST);
+
+                fileSet.isPushedDown[j] = databaseCost <= scanCost;
+                estimatedFileCounts[i][j] = estimatedFileCount;
+                pushDownCost += databaseCost;
+                planCost += std::min(databaseCost, scanCost);
+            }
+        }
+
+        // Without other scan conditions, the scan must pay for itself.
+        const bool pushDownAll = !hasScan && pushDownCost <= planCost;
+        for (size_t i = 0; i < fileSets.size(); ++i)
+        {
+            InterestingFilesSet &fileSet = fileSets[i];
+            for (size_t j = 0; j < fileSet.scanConditions.size(); ++j)
+            {
+                if (pushDownAll && !fileSet.scanConditions[j]->getSearchCondition().empty())
+                {
+                    fileSet.isPushedDown[j] = true;
+                }
+
+                std::ostringstream msg;
+                msg << MSG_PREFIX << "set " << fileSet.name << ": " << fileSet.scanConditionMetrics[j].definition << " " 
+                    << (fileSet.isPushedDown[j] ? "pushed down" : "scanned")
+                    << (fileSet.scanConditions[j]->getIndexLookupRows(0.0) >= 0.0 ? " using the file name index" : "");
+                if (!fileSet.scanConditions[j]->getSearchCondition().empty())
+                {
+                    msg << ", estimated " << static_cast<uint64_t>(estimatedFileCounts[i][j]) << " files";
+                }
+                LOGINFO(msg.str());
+            }
+        }
+
+        std::ostringstream msg;
+        msg << MSG_PREFIX << "planned for " << static_cast<uint64_t>(fileCount) << " files from a sample of " << sample.size() << " in " 
+            << start.elapsed() / 1000000.0 << " s, estimated cost " << std::min(pushDownCost, planCost) 
+            << (scanUsesMatchFunction ? ", scanning with the match function" : scanAllFiles ? ", scanning all files" : "");
+        LOGINFO(msg.str());
+    }
+
+    /**
+     * Opens a hit table in the image database, if the configuration file 
+     * asks for bulk posting.
+     *
+     * @return The hit table, or NULL if the hits are posted one at a time.
+     */
+    HitTable *openHitTable()
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::openHitTable : ";
+
+        if (!useBulkPosting)
+        {
+            return NULL;
+        }
+
+        if (!hasSqliteImageDatabase())
+        {
+            LOGWARN(MSG_PREFIX + "bulk posting requires the SQLite image database and is not used");
+            return NULL;
+        }
+
+        std::vector<HitTable::FileSet> hitTableFileSets;
+        for (std::vector<InterestingFilesSet>::const_iterator fileSet = fileSets.begin(); fileSet != fileSets.end(); ++fileSet)
+        {
+            hitTableFileSets.push_back(HitTable::FileSet(fileSet->name, fileSet->description));
+        }
+
+        try
+        {
+            return new HitTable(getImageDatabasePath(), hitTableFileSets);
+        }
+        catch (TskException &ex)
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "bulk posting is not used: " << ex.message();
+            LOGWARN(msg.str());
+            return NULL;
+        }
+    }
+
+    /**
+     * Runs the conditions that are pushed down to the image database.
+     *
+     * @param hits The files selected by each query are added to the hits of 
+     * the query's interesting files set, unless there is a hit table and 
+     * the set has no rule.
+     * @param hitTable The hit table the image database adds the files 
+     * selected by each query to, or NULL.
+     * @param tableHits Receives, for each set, the files that the image 
+     * database added to the hit table.
+     */
+    void findDatabaseHits(std::vector<std::vector<FileIdSet> > &hits, HitTable *hitTable, std::vector<FileIdSet> &tableHits)
+    {
+        tableHits.assign(fileSets.size(), FileIdSet());
+        for (size_t i = 0; i < fileSets.size(); ++i)
+        {
+            for (size_t j = 0; j < fileSets[i].scanConditions.size(); ++j)
+            {
+                if (!fileSets[i].isPushedDown[j])
+                {
+                    continue;
+                }
+
+                ConditionMetrics &metrics = fileSets[i].scanConditionMetrics[j];
+                Poco::Timestamp start;
+                if (hitTable != NULL && !fileSets[i].hasRule())
+                {
+                    const uint64_t hitCount = hitTable->addQueryHits(i, j, fileSets[i].scanConditions[j]->getSearchCondition(), tableHits[i]);
+                    metrics.rows += hitCount;
+                    metrics.hits += hitCount;
+                    metrics.seconds += start.elapsed() / 1000000.0;
+                    continue;
+                }
+
+                std::vector<uint64_t> fileIds = TskServices::Instance().getImgDB().getFileIds("WHERE " + fileSets[i].scanConditions[j]->getSearchCondition() + " ORDER BY file_id");
+                metrics.rows += fileIds.size();
+                metrics.hits += fileIds.size();
+                metrics.bytesAllocated += fileIds.capacity() * sizeof(uint64_t);
+                for (std::vector<uint64_t>::const_iterator fileId = fileIds.begin(); fileId != fileIds.end(); ++fileId)
+                {
+                    hits[i][j].add(*fileId);
+                }
+                metrics.seconds += start.elapsed() / 1000000.0;
+            }
+        }
+    }
+
+    /**
+     * The progress of a scan of the file records, which visits the files in
+     * file id order.
+     */
+    struct ScanProgress
+    {
+        ScanProgress(const std::vector<std::vector<FileIdSet> > &hits, const std::vector<FileIdSet> &tableHits) : databaseHits(tableHits)
+        {
+            for (size_t i = 0; i < hits.size(); ++i)
+            {
+                if (fileSets[i].hasRule())
+                {
+                    continue;
+                }
+
+                for (std::vector<FileIdSet>::const_iterator conditionHits = hits[i].begin(); conditionHits != hits[i].end(); ++conditionHits)
+                {
+                    databaseHits[i].unite(*conditionHits);
+                }
+            }
+        }
+
+        // The files that the pushed down conditions of each set already selected, whether they are in the hits or only in the
+        // hit table. The files selected for a set with a rule may still be removed by its rule, so none are recorded for it.
+        std::vector<FileIdSet> databaseHits;
+        std::vector<ContentCandidate> contentCandidates;
+    };
+
+    /**
+     * Determines whether a bitmask returned by the match function includes 
+     * an interesting files set.
+     */
+    bool hasMatchedSet(const std::string &matchedSets, size_t fileSetIndex)
+    {
+        return (static_cast<unsigned char>(matchedSets[fileSetIndex / 8]) & (1 << (fileSetIndex % 8))) != 0;
+    }
+
+    /**
+     * Evaluates the scan conditions for a batch of file records.
+     *
+     * @param fileRecords The file records, sorted by file id and following 
+     * those of earlier batches.
+     * @param matchedSets The bitmask returned by the match function for each 
+     * of the file records, or NULL if the records were not selected by it. A
+     * set's conditions are not evaluated for the files that the bitmask 
+     * excludes from the set.
+     * @param progress The progress of the scan.
+     * @param hits Receives the hits of the scan conditions.
+     */
+    void scanFileRecords(const std::vector<TskFileRecord> &fileRecords, const std::vector<std::string> *matchedSets, ScanProgress &progress, std::vector<std::vector<FileIdSet> > &hits)
+    {
+        std::vector<Poco::SharedPtr<ScannedFile> > files;
+        for (std::vector<TskFileRecord>::const_iterator fileRecord = fileRecords.begin(); fileRecord != fileRecords.end(); ++fileRecord)
+        {
+            files.push_back(new ScannedFile(*fileRecord));
+            scanMetrics.bytesAllocated += getFileRecordBytes(*fileRecord);
+        }
+
+        std::vector<ContentCandidate> &contentCandidates = progress.contentCandidates;
+        std::vector<bool> isDecided;
+        for (size_t i = 0; i < fileSets.size(); ++i)
+        {
+            // Each condition is evaluated for the whole batch before the next, so that the time spent in each condition can
+            // be measured. A file is a hit for a set only once, no matter how many of the set's scan conditions it satisfies,
+            // so once a file is a hit the set's remaining conditions are not evaluated for it and its content is not checked.
+            // Neither are they for a file that the match function found to satisfy none of them. The rule of a set, if it has
+            // one, needs to know every condition of the set that a file satisfies, so for such a set all are evaluated.
+            const size_t firstCandidate = contentCandidates.size();
+            isDecided.assign(files.size(), false);
+            for (size_t k = 0; k < files.size(); ++k)
+            {
+                isDecided[k] = progress.databaseHits[i].contains(fileRecords[k].fileId) || 
+                    (matchedSets != NULL && !hasMatchedSet((*matchedSets)[k], i));
+            }
+
+            for (size_t j = 0; j < fileSets[i].scanConditions.size(); ++j)
+            {
+                if (fileSets[i].isPushedDown[j])
+                {
+                    continue;
+                }
+
+                const ScanCondition &scanCondition = *fileSets[i].scanConditions[j];
+                ConditionMetrics &metrics = fileSets[i].scanConditionMetrics[j];
+                Poco::Timestamp start;
+                for (size_t k = 0; k < files.size(); ++k)
+                {
+                    if (isDecided[k])
+                    {
+                        continue;
+                    }
+
+                    ++metrics.rows;
+                    if (scanCondition.matches(*files[k]))
+                    {
+                        if (scanCondition.isContentCondition())
+                        {
+                            contentCandidates.push_back(ContentCandidate(fileRecords[k].fileId, i, j, contentCachePath.empty() ? "" : getContentHash(fileRecords[k])));
+                            metrics.bytesAllocated += sizeof(ContentCandidate);
+                        }
+                        else
+                        {
+                            hits[i][j].add(fileRecords[k].fileId);
+                            ++metrics.hits;
+                            isDecided[k] = !fileSets[i].hasRule();
+                        }
+                    }
+                }
+                metrics.seconds += start.elapsed() / 1000000.0;
+            }
+
+            size_t keptCandidate = firstCandidate;
+            for (size_t candidate = firstCandidate; candidate < contentCandidates.size(); ++candidate)
+            {
+                const size_t k = std::lower_bound(fileRecords.begin(), fileRecords.end(), contentCandidates[candidate].fileId, hasLowerFileId) - fileRecords.begin();
+                if (!isDecided[k])
+                {
+                    contentCandidates[keptCandidate++] = contentCandidates[candidate];
+                }
+            }
+            contentCandidates.erase(contentCandidates.begin() + keptCandidate, contentCandidates.end());
+        }
+    }
+
+    /**
+     * The state of a scan run with the match function, which the image 
+     * database passes to each call of the function.
+     */
+    struct MatchFunctionScan
+    {
+        MatchFunctionScan() : rows(0) {}
+
+        // The record of the file the function was last called for, reused so that its strings keep their buffers.
+        TskFileRecord fileRecord;
+        std::string fileMatchedSets;
+
+        // The records of the files that satisfy some scan condition, and the bitmasks the function returned for them,
+        // not yet evaluated by scanFileRecords().
+        std::vector<TskFileRecord> fileRecords;
+        std::vector<std::string> matchedSets;
+        uint64_t rows;
+    };
+
+    void readText(sqlite3_value *value, std::string &text)
+    {
+        const unsigned char *chars = sqlite3_value_text(value);
+        if (chars != NULL)
+        {
+            text.assign(reinterpret_cast<const char *>(chars), sqlite3_value_bytes(value));
+        }
+        else
+        {
+            text.clear();
+        }
+    }
+
+    /**
+     * Reads the arguments of the match function into a file record.
+     */
+    void readFileRecord(sqlite3_value **arguments, TskFileRecord &fileRecord)
+    {
+        fileRecord.fileId = sqlite3_value_int64(arguments[0]);
+        fileRecord.typeId = static_cast<TskImgDB::FILE_TYPES>(sqlite3_value_int(arguments[1]));
+        readText(arguments[2], fileRecord.name);
+        fileRecord.parentFileId = sqlite3_value_int64(arguments[3]);
+        fileRecord.dirType = static_cast<TSK_FS_NAME_TYPE_ENUM>(sqlite3_value_int(arguments[4]));
+        fileRecord.metaType = static_cast<TSK_FS_META_TYPE_ENUM>(sqlite3_value_int(arguments[5]));
+        fileRecord.size = sqlite3_value_int64(arguments[6]);
+        fileRecord.ctime = static_cast<time_t>(sqlite3_value_int64(arguments[7]));
+        fileRecord.crtime = static_cast<time_t>(sqlite3_value_int64(arguments[8]));
+        fileRecord.atime = static_cast<time_t>(sqlite3_value_int64(arguments[9]));
+        fileRecord.mtime = static_cast<time_t>(sqlite3_value_int64(arguments[10]));
+        readText(arguments[11], fileRecord.fullPath);
+        readText(arguments[12], fileRecord.md5);
+        readText(arguments[13], fileRecord.sha1);
+        readText(arguments[14], fileRecord.sha2_256);
+        readText(arguments[15], fileRecord.sha2_512);
+    }
+
+    /**
+     * The match function, called by the image database for each file. 
+     * Evaluates the scan conditions of every interesting files set for the 
+     * file, stopping at the first condition of each set that the file 
+     * satisfies, and keeps the record of the file if it satisfies any.
+     */
+    void matchFile(sqlite3_context *context, int argumentCount, sqlite3_value **arguments)
+    {
+        if (argumentCount != MATCH_FUNCTION_ARGUMENT_COUNT)
+        {
+            sqlite3_result_error(context, "ifm_match : wrong number of arguments", -1);
+            return;
+        }
+
+        // Exceptions must not propagate into the image database.
+        try
+        {
+            MatchFunctionScan &scan = *static_cast<MatchFunctionScan *>(sqlite3_user_data(context));
+            ++scan.rows;
+            readFileRecord(arguments, scan.fileRecord);
+            ScannedFile file(scan.fileRecord);
+            scan.fileMatchedSets.assign((fileSets.size() + 7) / 8, '\0');
+            bool isMatched = false;
+            for (size_t i = 0; i < fileSets.size(); ++i)
+            {
+                for (size_t j = 0; j < fileSets[i].scanConditions.size(); ++j)
+                {
+                    if (!fileSets[i].isPushedDown[j] && fileSets[i].scanConditions[j]->matches(file))
+                    {
+                        scan.fileMatchedSets[i / 8] = static_cast<char>(scan.fileMatchedSets[i / 8] | (1 << (i % 8)));
+                        isMatched = true;
+                        break;
+                    }
+                }
+            }
+
+            if (!isMatched)
+            {
+                sqlite3_result_null(context);
+                return;
+            }
+
+            scan.fileRecords.push_back(scan.fileRecord);
+            scan.matchedSets.push_back(scan.fileMatchedSets);
+            sqlite3_result_blob(context, scan.fileMatchedSets.data(), static_cast<int>(scan.fileMatchedSets.size()), SQLITE_TRANSIENT);
+        }
+        catch (std::exception &ex)
+        {
+            sqlite3_result_error(context, ex.what(), -1);
+        }
+        catch (...)
+        {
+            sqlite3_result_error(context, "ifm_match : unrecognized exception", -1);
+        }
+    }
+
+    /**
+     * Runs the scan inside the SQLite image database with the match function.
+     * The function is registered with a connection of the module's own, and a
+     * single query calls it for every file, so that only the records of the 
+     * files that satisfy some scan condition are returned to the module. 
+     * Those are then evaluated by scanFileRecords() in batches, which finds
+     * the conditions they satisfy.
+     *
+     * @return False if the match function cannot be registered, in which 
+     * case no files have been scanned.
+     */
+    bool scanWithMatchFunction(ScanProgress &progress, std::vector<std::vector<FileIdSet> > &hits)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::scanWithMatchFunction : ";
+
+        MatchFunctionScan scan;
+        std::auto_ptr<SqliteConnection> connection;
+        std::auto_ptr<SqliteStatement> query;
+        try
+        {
+            connection.reset(new SqliteConnection(getImageDatabasePath(), true));
+            if (sqlite3_create_function(connection->get(), MATCH_FUNCTION_NAME, MATCH_FUNCTION_ARGUMENT_COUNT, SQLITE_UTF8, &scan, matchFile, NULL, NULL) != SQLITE_OK)
+            {
+                connection->throwError(MATCH_FUNCTION_NAME);
+            }
+            query.reset(new SqliteStatement(*connection, MATCH_FUNCTION_QUERY));
+        }
+        catch (TskException &ex)
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "the match function is not used: " << ex.message();
+            LOGWARN(msg.str());
+            return false;
+        }
+
+        // Each row of the query is a file whose record the match function kept, so the records are evaluated whenever
+        // a batch of them has been kept. A finished query is not stepped again, as that would run it again.
+        bool hasMoreRows = true;
+        while (hasMoreRows)
+        {
+            Poco::Timestamp queryStart;
+            while (hasMoreRows && scan.fileRecords.size() < static_cast<size_t>(FILE_RECORD_BATCH_SIZE))
+            {
+                hasMoreRows = query->step();
+            }
+            scanMetrics.seconds += queryStart.elapsed() / 1000000.0;
+
+            if (!scan.fileRecords.empty())
+            {
+                scanFileRecords(scan.fileRecords, &scan.matchedSets, progress, hits);
+                scan.fileRecords.clear();
+                scan.matchedSets.clear();
+            }
+        }
+        scanMetrics.rows += scan.rows;
+        return true;
+    }
+
+    /**
+     * Evaluates the scan conditions of all of the interesting file sets in a 
+     * single scan of the file records in the image database. Unless the scan
+     * is run with the match function, the records are read in batches, and 
+     * only the records of files that could satisfy at least one scan 
+     * condition are read. Content conditions are completed after the scan. 
+     * Conditions that are pushed down to the image database are not 
+     * evaluated.
+     *
+     * @param hits The hits of each condition of each interesting files set.
+     * Holds the hits of the pushed down conditions, and receives the hits of
+     * the scan conditions.
+     * @param tableHits The files of each set that the pushed down conditions
+     * added to the hit table, which are not scanned for the set.
+     */
+    void findScanHits(std::vector<std::vector<FileIdSet> > &hits, const std::vector<FileIdSet> &tableHits)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::findScanHits : ";
+
+        // The scan conditions of a set are not evaluated for the files that the set's pushed down conditions selected.
+        ScanProgress progress(hits, tableHits);
+
+        bool hasScanConditions = false;
+        bool needsDirectoryTree = false;
+        bool scanAllFiles = false;
+        std::set<std::string> candidateFilesConditions;
+        for (std::vector<InterestingFilesSet>::const_iterator fileSet = fileSets.begin(); fileSet != fileSets.end(); ++fileSet)
+        {
+            for (size_t i = 0; i < fileSet->scanConditions.size(); ++i)
+            {
+                if (fileSet->isPushedDown[i])
+                {
+                    continue;
+                }
+
+                const Poco::SharedPtr<ScanCondition> &condition = fileSet->scanConditions[i];
+                hasScanConditions = true;
+                needsDirectoryTree = needsDirectoryTree || condition->usesDirectoryTree();
+                const std::string candidateFilesCondition = condition->getCandidateFilesCondition();
+                if (candidateFilesCondition.empty())
+                {
+                    scanAllFiles = true;
+                }
+                else
+                {
+                    candidateFilesConditions.insert(candidateFilesCondition);
+                }
+            }
+        }
+
+        if (!hasScanConditions)
+        {
+            return;
+        }
+
+        if (needsDirectoryTree)
+        {
+            Poco::Timestamp loadStart;
+            loadDirectoryTree();
+            scanMetrics.seconds += loadStart.elapsed() / 1000000.0;
+        }
+
+        bool isScanned = false;
+        if (useMatchFunction)
+        {
+            if (hasSqliteImageDatabase())
+            {
+                isScanned = scanWithMatchFunction(progress, hits);
+            }
+            else
+            {
+                LOGWARN(MSG_PREFIX + "the match function requires the SQLite image database and is not used");
+            }
+        }
+
+        std::stringstream candidateFilesCondition;
+        if (!scanAllFiles)
+        {
+            for (std::set<std::string>::const_iterator condition = candidateFilesConditions.begin(); condition != candidateFilesConditions.end(); ++condition)
+            {
+                candidateFilesCondition << (condition == candidateFilesConditions.begin() ? " AND (" : " OR ") << *condition;
+            }
+            candidateFilesCondition << ")";
+        }
+
+        uint64_t lastFileId = 0;
+        while (!isScanned)
+        {
+            Poco::Timestamp queryStart;
+            std::stringstream condition;
+            condition << "WHERE f.file_id > " << lastFileId << candidateFilesCondition.str() << " ORDER BY f.file_id LIMIT " << FILE_RECORD_BATCH_SIZE;
+            std::vector<TskFileRecord> fileRecords = TskServices::Instance().getImgDB().getFileRecords(condition.str());
+            scanMetrics.seconds += queryStart.elapsed() / 1000000.0;
+            if (fileRecords.empty())
+            {
+                break;
+            }
+
+            scanMetrics.rows += fileRecords.size();
+            scanFileRecords(fileRecords, NULL, progress, hits);
+            lastFileId = fileRecords.back().fileId;
+        }
+
+        std::ostringstream msg;
+        msg << MSG_PREFIX << "scanned " << scanMetrics.rows << " files";
+        LOGINFO(msg.str());
+
+        // The candidates of a file are kept in set order, as findContentHits() expects.
+        std::vector<ContentCandidate> &contentCandidates = progress.contentCandidates;
+        std::stable_sort(contentCandidates.begin(), contentCandidates.end());
+        findContentHits(contentCandidates, hits);
+
+        std::ostringstream hitsMsg;
+        hitsMsg << MSG_PREFIX << "holding the hits in " << getHitBytes(hits) << " bytes";
+        LOGINFO(hitsMsg.str());
+    }
+
+    /**
+     * Finds the posted hits of the interesting files sets whose hits are not
+     * cached. The sets whose hits are cached are left out of the search by 
+     * searching a copy of the other sets, whose metrics are then copied 
+     * back.
+     *
+     * @param isCached Whether the hits of each set are cached.
+     * @param hitTable The hit table the pushed down conditions of the sets 
+     * without a rule add their hits to, or NULL.
+     * @param postedHits Receives the posted hits of each condition of each 
+     * set whose hits are not cached.
+     */
+    void findPostedHits(const std::vector<bool> &isCached, HitTable *hitTable, std::vector<std::vector<FileIdSet> > &postedHits)
+    {
+        std::vector<size_t> searchedSets;
+        for (size_t i = 0; i < fileSets.size(); ++i)
+        {
+            if (!isCached[i])
+            {
+                searchedSets.push_back(i);
+            }
+        }
+        if (searchedSets.empty())
+        {
+            return;
+        }
+
+        std::vector<InterestingFilesSet> allFileSets;
+        const bool isPartialSearch = searchedSets.size() < fileSets.size();
+        if (isPartialSearch)
+        {
+            allFileSets.swap(fileSets);
+            for (std::vector<size_t>::const_iterator i = searchedSets.begin(); i != searchedSets.end(); ++i)
+            {
+                fileSets.push_back(allFileSets[*i]);
+            }
+        }
+
+        try
+        {
+            updateFileNameIndex();
+            planSearchConditions();
+
+            std::vector<std::vector<FileIdSet> > hits;
+            createHitSets(hits);
+            std::vector<FileIdSet> tableHits;
+            findDatabaseHits(hits, hitTable, tableHits);
+            findScanHits(hits, tableHits);
+
+            Poco::Timestamp loadStart;
+            loadTimestampIndexes();
+            scanMetrics.seconds += loadStart.elapsed() / 1000000.0;
+
+            for (size_t k = 0; k < searchedSets.size(); ++k)
+            {
+                getPostedHits(fileSets[k], hits[k], postedHits[searchedSets[k]]);
+            }
+        }
+        catch (...)
+        {
+            if (isPartialSearch)
+            {
+                fileSets.swap(allFileSets);
+            }
+            throw;
+        }
+
+        if (isPartialSearch)
+        {
+            for (size_t k = 0; k < searchedSets.size(); ++k)
+            {
+                allFileSets[searchedSets[k]].scanConditionMetrics = fileSets[k].scanConditionMetrics;
+                allFileSets[searchedSets[k]].isPushedDown = fileSets[k].isPushedDown;
+            }
+            fileSets.swap(allFileSets);
+        }
+    }
+
+    /**
+     * Opens the result cache in the image database, if the configuration 
+     * file asks for it.
+     *
+     * @return The result cache, or NULL if the hits are not cached.
+     */
+    ResultCache *openResultCache()
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::openResultCache : ";
+
+        if (!useResultCache)
+        {
+            return NULL;
+        }
+
+        if (!hasSqliteImageDatabase())
+        {
+            LOGWARN(MSG_PREFIX + "the result cache requires the SQLite image database and is not used");
+            return NULL;
+        }
+
+        try
+        {
+            return new ResultCache(getImageDatabasePath());
+        }
+        catch (TskException &ex)
+        {
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "the result cache is not used: " << ex.message();
+            LOGWARN(msg.str());
+            return NULL;
+        }
+    }
+
+    /**
+     * Finds the interesting files sets whose hits are cached for the image 
+     * database as it is, and whether their hits are already posted.
+     *
+     * @param resultCache The result cache.
+     * @param postedHits Receives the cached posted hits of each condition of
+     * each set whose hits are cached.
+     * @param isCached Receives whether the hits of each set are cached.
+     * @param isPosted Receives whether the hits of each set are cached and
+     * were posted to the blackboard by an earlier search.
+     */
+    void findCachedHits(ResultCache &resultCache, std::vector<std::vector<FileIdSet> > &postedHits, std::vector<bool> &isCached, std::vector<bool> &isPosted)
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::findCachedHits : ";
+
+        size_t cachedCount = 0;
+        size_t postedCount = 0;
+        for (size_t i = 0; i < fileSets.size(); ++i)
+        {
+            try
+            {
+                isCached[i] = resultCache.find(fileSets[i].cacheKey, fileSets[i].scanConditions.size(), postedHits[i]);
+                if (!isCached[i])
+                {
+                    continue;
+                }
+
+                isPosted[i] = resultCache.isPosted(fileSets[i].cacheKey);
+                ++cachedCount;
+                postedCount += isPosted[i] ? 1 : 0;
+            }
+            catch (TskException &ex)
+            {
+                isCached[i] = false;
+                isPosted[i] = false;
+                std::ostringstream msg;
+                msg << MSG_PREFIX << "the cached hits of set " << fileSets[i].name << " are not used: " << ex.message();
+                LOGWARN(msg.str());
+            }
+        }
+
+        std::ostringstream msg;
+        msg << MSG_PREFIX << "found the hits of " << cachedCount << " of " << fileSets.size() << " sets cached for image database fingerprint " 
+            << resultCache.getFingerprint() << ", " << postedCount << " of them already posted";
+        LOGINFO(msg.str());
+    }
+
+    /**
+     * Caches the posted hits of the interesting files sets that were 
+     * searched. Failing to cache the hits of a set does not fail the search.
+     */
+    void storeCachedHits(ResultCache &resultCache, const std::vector<std::vector<FileIdSet> > &postedHits, const std::vector<bool> &isCached)
+    {
+        for (size_t i = 0; i < fileSets.size(); ++i)
+        {
+            if (isCached[i])
+            {
+                continue;
+            }
+
+            try
+            {
+                resultCache.store(fileSets[i].cacheKey, postedHits[i]);
+            }
+            catch (TskException &ex)
+            {
+                std::ostringstream msg;
+                msg << "InterestingFilesModule::storeCachedHits : the hits of set " << fileSets[i].name << " are not cached: " << ex.message();
+                LOGWARN(msg.str());
+            }
+        }
     }
 
-    /** 
-     * Adds optional file type (file, directory) and path substring filters to 
-     * an SQL WHERE clause for a file search condition.
-     *
-     * @param conditionDefinition A file name or extension condition XML 
-     * element.
-     * @param conditionBuilder A string stream to which to append the filters.
+    /**
+     * Records that the cached hits of the interesting files sets that were 
+     * not already posted have now been posted. A set that fails to be 
+     * recorded has its hits posted again by the next search.
      */
-    void addPathAndTypeFilterOptions(const Poco::XML::Node *conditionDefinition, std::stringstream &conditionBuilder)
+    void setCachedHitsPosted(ResultCache &resultCache, const std::vector<bool> &isPosted)
     {
-        const std::string MSG_PREFIX = "InterestingFilesModule::compileExtensionSearchCondition : ";
-
-        if (conditionDefinition->hasAttributes())
+        for (size_t i = 0; i < fileSets.size(); ++i)
         {
-            // Look for pathFilter and typeFilter attributes.
-            Poco::AutoPtr<Poco::XML::NamedNodeMap> attributes = conditionDefinition->attributes(); 
-            for (unsigned long i = 0; i < attributes->length(); ++i)
+            if (isPosted[i])
             {
-                Poco::XML::Node *attribute = attributes->item(i);
-                const std::string& attributeName = Poco::XML::fromXMLString(attribute->nodeName());
-                std::string attributeValue(Poco::XML::fromXMLString(attribute->nodeValue()));
-                if (attributeName == PATH_FILTER_ATTRIBUTE)
-                {        
-                    if (!attributeValue.empty())
-                    {
-                        // File must include a specified substring somewhere in its path.
-                        convertGlobWildcardsToSQLWildcards(attributeValue);
-                        conditionBuilder << " AND UPPER(full_path) LIKE UPPER('%" + attributeValue + "%') ESCAPE '#'";
-                    }
-                    else
-                    {
-                        std::ostringstream msg;
-                        msg << MSG_PREFIX << Poco::XML::fromXMLString(conditionDefinition->nodeName()) << " element has empty " << PATH_FILTER_ATTRIBUTE << " attribute"; 
-                        throw TskException(msg.str());
-                    }
-                }
-                else if (attributeName == TYPE_FILTER_ATTRIBUTE)
-                {
-                    if (!attributeValue.empty())
-                    {
-                        if (attributeValue == FILE_TYPE_FILTER_VALUE)
-                        {
-                            // File must be a regular file.
-                            conditionBuilder << " AND meta_type = " << TSK_FS_META_TYPE_REG;
-                        }
-                        else if (attributeValue == DIR_TYPE_FILTER_VALUE)
-                        {
-                            // File must be a directory.
-                            conditionBuilder << " AND meta_type = " << TSK_FS_META_TYPE_DIR;
-                        }
-                        else
-                        {
-                            std::ostringstream msg;
-                            msg << MSG_PREFIX << Poco::XML::fromXMLString(conditionDefinition->nodeName()) << " element has unrecognized " << TYPE_FILTER_ATTRIBUTE << " attribute value: " << attributeValue; 
-                            throw TskException(msg.str());
-                        }
-                    }
-                    else
-                    {
-                        std::ostringstream msg;
-                        msg << MSG_PREFIX << Poco::XML::fromXMLString(conditionDefinition->nodeName()) << " element has empty " << TYPE_FILTER_ATTRIBUTE << " attribute"; 
-                        throw TskException(msg.str());
-                    }
-                }
-                else
-                {
-                    std::stringstream msg;
-                    msg << MSG_PREFIX << Poco::XML::fromXMLString(conditionDefinition->nodeName()) << " element has unrecognized " << attributeName << " attribute"; 
-                    throw TskException(msg.str());
-                }
+                continue;
+            }
+
+            try
+            {
+                resultCache.setPosted(fileSets[i].cacheKey);
+            }
+            catch (TskException &ex)
+            {
+                std::ostringstream msg;
+                msg << "InterestingFilesModule::setCachedHitsPosted : the hits of set " << fileSets[i].name << " are not recorded as posted: " << ex.message();
+                LOGWARN(msg.str());
             }
         }
     }
 
     /**
-      * Creates an SQL WHERE clause for a file query from a file name
-      * condition.
-      *
-      * @param conditionDefinition A file name condition XML element.
-      * @param conditions The WHERE clause is added to this collection.
-      */
-    void compileFileNameSearchCondition(const Poco::XML::Node *conditionDefinition, std::vector<std::string> &conditions)
+     * Posts the hits to the blackboard in bulk through a hit table, which 
+     * already holds the hits of the pushed down conditions of the sets 
+     * without a rule, unless the hits are cached. The time taken is added to
+     * the time of the scan.
+     */
+    void postHitsInBulk(const std::vector<std::vector<FileIdSet> > &postedHits, HitTable &hitTable)
     {
-        const std::string MSG_PREFIX = "InterestingFilesModule::compileFileNameSearchCondition : ";
-
-        std::string name(Poco::XML::fromXMLString(conditionDefinition->innerText()));
-        if (name.empty())
+        Poco::Timestamp start;
+        for (size_t i = 0; i < postedHits.size(); ++i)
         {
-            std::ostringstream msg;
-            msg << MSG_PREFIX << "empty " << NAME_ELEMENT_TAG << " element"; 
-            throw TskException(msg.str());
+            for (size_t j = 0; j < postedHits[i].size(); ++j)
+            {
+                for (FileIdSet::Iterator fileId(postedHits[i][j]); !fileId.atEnd(); fileId.next())
+                {
+                    hitTable.addHit(i, j, fileId.get());
+                }
+            }
         }
 
-        std::stringstream conditionBuilder;
-        if (hasGlobWildcards(name))
-        {
-            convertGlobWildcardsToSQLWildcards(name);
-            conditionBuilder << "WHERE UPPER(name) LIKE UPPER(" << TskServices::Instance().getImgDB().quote(name) << ") ESCAPE '#' ";
-        }
-        else
+        std::vector<std::vector<uint64_t> > artifactCounts;
+        hitTable.post(artifactCounts);
+        uint64_t artifactCount = 0;
+        for (size_t i = 0; i < artifactCounts.size(); ++i)
         {
-            conditionBuilder << "WHERE UPPER(name) = UPPER(" +  TskServices::Instance().getImgDB().quote(name) + ")";
+            for (size_t j = 0; j < artifactCounts[i].size() && j < fileSets[i].scanConditionMetrics.size(); ++j)
+            {
+                fileSets[i].scanConditionMetrics[j].artifacts += artifactCounts[i][j];
+                artifactCount += artifactCounts[i][j];
+            }
         }
+        const double seconds = start.elapsed() / 1000000.0;
+        scanMetrics.seconds += seconds;
 
-        addPathAndTypeFilterOptions(conditionDefinition, conditionBuilder);
-        conditionBuilder << " ORDER BY file_id";
-        conditions.push_back(conditionBuilder.str());
+        std::ostringstream msg;
+        msg << "InterestingFilesModule::postHitsInBulk : posted " << artifactCount << " artifacts in " << seconds << " s";
+        LOGINFO(msg.str());
     }
 
     /**
-      * Creates an SQL WHERE clause for a file query from a file extension
-      * condition.
-      *
-      * @param conditionDefinition A file extension condition XML element.
-      * @param conditions The WHERE clause is added to this collection.
-      */
-    void compileExtensionSearchCondition(const Poco::XML::Node *conditionDefinition, std::vector<std::string> &conditions)
+     * Resets the metrics of all of the search conditions.
+     */
+    void resetMetrics()
     {
-        const std::string MSG_PREFIX = "InterestingFilesModule::compileExtensionSearchCondition : ";
-
-        std::string extension(Poco::XML::fromXMLString(conditionDefinition->innerText()));
-        if (extension.empty())
+        for (std::vector<InterestingFilesSet>::iterator fileSet = fileSets.begin(); fileSet != fileSets.end(); ++fileSet)
         {
-            std::ostringstream msg;
-            msg << MSG_PREFIX << "empty " << EXTENSION_ELEMENT_TAG << " element"; 
-            throw TskException(msg.str());
+            for (std::vector<ConditionMetrics>::iterator metrics = fileSet->scanConditionMetrics.begin(); metrics != fileSet->scanConditionMetrics.end(); ++metrics)
+            {
+                *metrics = ConditionMetrics(metrics->definition);
+            }
         }
+        scanMetrics = ConditionMetrics();
+        reportSeconds = 0.0;
+    }
 
-        // Supply the leading dot, if omitted.
-        if (extension[0] != '.')
+    /**
+     * Adds the measurements of a condition to a total.
+     */
+    void addMetrics(const ConditionMetrics &metrics, ConditionMetrics &total)
+    {
+        total.seconds += metrics.seconds;
+        total.rows += metrics.rows;
+        total.hits += metrics.hits;
+        total.artifacts += metrics.artifacts;
+        total.bytesAllocated += metrics.bytesAllocated;
+    }
+
+    /**
+     * Escapes a string for use as a JSON string or a Prometheus label value,
+     * both of which use backslash escapes for quotes, backslashes and 
+     * newlines.
+     */
+    std::string escapeMetricsString(const std::string &s)
+    {
+        std::string escaped;
+        for (std::string::const_iterator c = s.begin(); c != s.end(); ++c)
         {
-            extension.insert(0, ".");
+            if (*c == '"' || *c == '\\')
+            {
+                escaped += '\\';
+                escaped += *c;
+            }
+            else if (*c == '\n')
+            {
+                escaped += "\\n";
+            }
+            else if (static_cast<unsigned char>(*c) >= 0x20)
+            {
+                escaped += *c;
+            }
         }
+        return escaped;
+    }
 
-        convertGlobWildcardsToSQLWildcards(extension);
-        
-        // Extension searches must always have an initial SQL zero to many chars wildcard.
-        // @@@ TODO: In combination with glob wildcards this may create some unxepected matches.
-        // For example, ".htm*" will become "%.htm%" which will match "file.htm.txt" and the like.
-        std::stringstream conditionBuilder;
-        conditionBuilder << "WHERE UPPER(name) LIKE UPPER('%" << extension << "') ESCAPE '#' ";
-
-        addPathAndTypeFilterOptions(conditionDefinition, conditionBuilder);            
-        conditionBuilder << " ORDER BY file_id";
-        conditions.push_back(conditionBuilder.str());
+    /**
+     * Writes the measurements of a condition as a JSON object.
+     */
+    void writeConditionMetricsJson(std::ostream &out, const ConditionMetrics &metrics, const std::string &type, size_t index)
+    {
+        out << "        {\"type\": \"" << type << "\", \"index\": " << index
+            << ", \"definition\": \"" << escapeMetricsString(metrics.definition)
+            << "\", \"seconds\": " << metrics.seconds << ", \"rows\": " << metrics.rows 
+            << ", \"hits\": " << metrics.hits << ", \"artifacts\": " << metrics.artifacts 
+            << ", \"bytesAllocated\": " << metrics.bytesAllocated << "}";
     }
 
-    /** 
-     * Creates an InterestingFilesSet object from an an interesting files 
-     * set definition. 
-     *
-     * @param fileSetDefinition An interesting file set definition XML element.
+    /**
+     * Writes the measurements of a condition as Prometheus text format samples.
      */
-    void compileInterestingFilesSet(const Poco::XML::Node *fileSetDefinition)
+    void writeConditionMetricsPrometheus(std::ostream &out, const std::string &fileSetName, const ConditionMetrics &metrics, const std::string &type, size_t index)
     {
-        // Create a counter for use in generating default interesting file set names.
-        static unsigned long defaultSetNumber = 1;
+        std::ostringstream labels;
+        labels << "{set=\"" << escapeMetricsString(fileSetName) << "\",type=\"" << type << "\",index=\"" << index 
+            << "\",definition=\"" << escapeMetricsString(metrics.definition) << "\"}";
+        out << "interesting_files_condition_seconds" << labels.str() << " " << metrics.seconds << "\n";
+        out << "interesting_files_condition_rows" << labels.str() << " " << metrics.rows << "\n";
+        out << "interesting_files_condition_hits" << labels.str() << " " << metrics.hits << "\n";
+        out << "interesting_files_condition_artifacts" << labels.str() << " " << metrics.artifacts << "\n";
+        out << "interesting_files_condition_bytes_allocated" << labels.str() << " " << metrics.bytesAllocated << "\n";
+    }
 
-        // Keep track of unique file set names.
-        static std::set<std::string> setNames;
+    /**
+     * Writes the metrics collected by report() to a JSON file and a 
+     * Prometheus text format file in the module output folder.
+     */
+    void writeMetrics()
+    {
+        Poco::Path metricsFolderPath(Poco::Path::forDirectory(GetSystemProperty(TskSystemProperties::MODULE_OUT_DIR)));
+        metricsFolderPath.pushDirectory(MODULE_NAME);
+        Poco::File(metricsFolderPath).createDirectories();
 
-        // Determine the name and description of the file set. Every file set must be named, but the description is optional.
-        // A default name is provided if omitted, so the parsing that follows logs warnings if unexpected attributes or values are parsed.
-        const std::string MSG_PREFIX = "InterestingFilesModule::compileInterestingFilesSet : ";
-        InterestingFilesSet fileSet;
-        if (fileSetDefinition->hasAttributes())
+        std::ofstream json(Poco::Path(metricsFolderPath, METRICS_JSON_FILE_NAME).toString().c_str(), std::ios::trunc);
+        json << std::fixed;
+        json.precision(6);
+        json << "{\n    \"module\": \"" << MODULE_NAME << "\",\n    \"version\": \"" << MODULE_VERSION << "\",\n";
+        json << "    \"reportSeconds\": " << reportSeconds << ",\n";
+        json << "    \"scan\": {\"seconds\": " << scanMetrics.seconds << ", \"rows\": " << scanMetrics.rows << ", \"bytesAllocated\": " << scanMetrics.bytesAllocated << "},\n";
+        json << "    \"fileSets\": [";
+        for (std::vector<InterestingFilesSet>::const_iterator fileSet = fileSets.begin(); fileSet != fileSets.end(); ++fileSet)
         {
-            Poco::AutoPtr<Poco::XML::NamedNodeMap> attributes = fileSetDefinition->attributes(); 
-            for (unsigned long i = 0; i < attributes->length(); ++i)
+            json << (fileSet == fileSets.begin() ? "\n" : ",\n") << "    {\"name\": \"" << escapeMetricsString(fileSet->name) << "\", \"conditions\": [";
+            for (size_t i = 0; i < fileSet->scanConditionMetrics.size(); ++i)
             {
-                Poco::XML::Node *attribute = attributes->item(i);
-                const std::string &attributeName = Poco::XML::fromXMLString(attribute->nodeName());                
-                const std::string &attributeValue = Poco::XML::fromXMLString(attribute->nodeValue());
-                if (!attributeValue.empty())
-                {
-                    if (attributeName == NAME_ATTRIBUTE)
-                    {        
-                        if (!attributeValue.empty())
-                        {
-                            fileSet.name = attributeValue;
-                        }
-                        else
-                        {
-                            std::ostringstream msg;
-                            msg << MSG_PREFIX << "ignored " << INTERESTING_FILE_SET_ELEMENT_TAG << "'" << NAME_ATTRIBUTE << "' attribute without a value"; 
-                            LOGWARN(msg.str());
-                        }
-                    }
-                    else if (attributeName == DESCRIPTION_ATTRIBUTE_TAG)
-                    {
-                        if (!attributeValue.empty())
-                        {
-                            fileSet.description = attributeValue;
-                        }
-                        else
-                        {
-                            std::ostringstream msg;
-                            msg << MSG_PREFIX << "ignored " << INTERESTING_FILE_SET_ELEMENT_TAG << "'" << DESCRIPTION_ATTRIBUTE_TAG << "' attribute without a value"; 
-                            LOGWARN(msg.str());
-                        }
-                    }
-                    else
-                    {
-                        std::ostringstream msg;
-                        msg << MSG_PREFIX << "ignored unrecognized " << INTERESTING_FILE_SET_ELEMENT_TAG << "'" << attributeName << "' attribute"; 
-                        LOGWARN(msg.str());
-                    }
-                }
+                json << (i == 0 ? "\n" : ",\n");
+                writeConditionMetricsJson(json, fileSet->scanConditionMetrics[i], fileSet->isPushedDown[i] ? "sql" : "scan", i);
             }
+            json << "]}";
         }
+        json << "]\n}\n";
 
-        if (fileSet.name.empty())
+        std::ofstream prometheus(Poco::Path(metricsFolderPath, METRICS_PROMETHEUS_FILE_NAME).toString().c_str(), std::ios::trunc);
+        prometheus << std::fixed;
+        prometheus.precision(6);
+        prometheus << "# TYPE interesting_files_report_seconds gauge\n";
+        prometheus << "interesting_files_report_seconds " << reportSeconds << "\n";
+        prometheus << "# TYPE interesting_files_scan_seconds gauge\n";
+        prometheus << "interesting_files_scan_seconds " << scanMetrics.seconds << "\n";
+        prometheus << "# TYPE interesting_files_scan_rows gauge\n";
+        prometheus << "interesting_files_scan_rows " << scanMetrics.rows << "\n";
+        prometheus << "# TYPE interesting_files_scan_bytes_allocated gauge\n";
+        prometheus << "interesting_files_scan_bytes_allocated " << scanMetrics.bytesAllocated << "\n";
+        prometheus << "# TYPE interesting_files_condition_seconds gauge\n";
+        prometheus << "# TYPE interesting_files_condition_rows gauge\n";
+        prometheus << "# TYPE interesting_files_condition_hits gauge\n";
+        prometheus << "# TYPE interesting_files_condition_artifacts gauge\n";
+        prometheus << "# TYPE interesting_files_condition_bytes_allocated gauge\n";
+        for (std::vector<InterestingFilesSet>::const_iterator fileSet = fileSets.begin(); fileSet != fileSets.end(); ++fileSet)
         {
-            // Supply a default name.
-            std::stringstream nameBuilder;
-            nameBuilder << "Unnamed_" << defaultSetNumber++;
-            fileSet.name = nameBuilder.str();
+            for (size_t i = 0; i < fileSet->scanConditionMetrics.size(); ++i)
+            {
+                writeConditionMetricsPrometheus(prometheus, fileSet->name, fileSet->scanConditionMetrics[i], fileSet->isPushedDown[i] ? "sql" : "scan", i);
+            }
         }
 
-        // The file set name cannot contain a path character since it may be used later
-        // as a folder name by a save interesting files module.
-        if (fileSet.name.find_first_of("<>:\"/\\|?*") != std::string::npos)
+        if (!json || !prometheus)
         {
             std::ostringstream msg;
-            msg << MSG_PREFIX << INTERESTING_FILE_SET_ELEMENT_TAG << " element " << NAME_ATTRIBUTE << " attribute value '" << fileSet.name << "' contains file path character";
+            msg << "InterestingFilesModule::writeMetrics : failed to write metrics to " << metricsFolderPath.toString();
             throw TskException(msg.str());
         }
+    }
 
-        // The file set name cannot be shorthand for the a current directory or parent directory since it may be used later
-        // as a folder name by a save interesting files module.
-        if (fileSet.name == (".") || fileSet.name == (".."))
-        {
-            std::ostringstream msg;
-            msg << MSG_PREFIX << INTERESTING_FILE_SET_ELEMENT_TAG << " element " << NAME_ATTRIBUTE << " attribute value '" << fileSet.name << "' is directory alias";
-            throw TskException(msg.str());
-        }
+    /**
+     * Orders condition metrics by time spent, most first.
+     */
+    bool takesLonger(const ConditionMetrics *a, const ConditionMetrics *b)
+    {
+        return a->seconds > b->seconds;
+    }
 
-        // Every file set must be uniquely named since it may be used later as a folder name by a save interesting files module.
-        if (setNames.count(fileSet.name) != 0)
-        {
-            std::ostringstream msg;
-            msg << MSG_PREFIX << "duplicate " << INTERESTING_FILE_SET_ELEMENT_TAG << " element " << NAME_ATTRIBUTE << " attribute value '" << fileSet.name << "'";
-            throw TskException(msg.str());
-        }
+    /**
+     * Logs a summary of the metrics collected by report(): the totals for each
+     * interesting files set and the conditions that took the most time.
+     */
+    void logMetricsSummary()
+    {
+        const std::string MSG_PREFIX = "InterestingFilesModule::logMetricsSummary : ";
 
-        // Get the search conditions.
-        Poco::AutoPtr<Poco::XML::NodeList>conditionDefinitions = fileSetDefinition->childNodes();
-        for (unsigned long i = 0; i < conditionDefinitions->length(); ++i)
+        std::vector<const ConditionMetrics *> conditionMetrics;
+        for (std::vector<InterestingFilesSet>::const_iterator fileSet = fileSets.begin(); fileSet != fileSets.end(); ++fileSet)
         {
-            Poco::XML::Node *conditionDefinition = conditionDefinitions->item(i);
-            if (conditionDefinition->nodeType() == Poco::XML::Node::ELEMENT_NODE) 
+            ConditionMetrics total;
+            for (std::vector<ConditionMetrics>::const_iterator metrics = fileSet->scanConditionMetrics.begin(); metrics != fileSet->scanConditionMetrics.end(); ++metrics)
             {
-                const std::string &conditionType = Poco::XML::fromXMLString(conditionDefinition->nodeName());
-                if (conditionType == NAME_ELEMENT_TAG)
-                {
-                    compileFileNameSearchCondition(conditionDefinition, fileSet.conditions);
-                }
-                else if (conditionType == EXTENSION_ELEMENT_TAG)
-                {
-                    compileExtensionSearchCondition(conditionDefinition, fileSet.conditions);
-                }
-                else
-                {
-                    std::ostringstream msg;
-                    msg << MSG_PREFIX << "unrecognized " << INTERESTING_FILE_SET_ELEMENT_TAG << " child element '" << conditionType << "'"; 
-                    throw TskException(msg.str());
-                }
+                addMetrics(*metrics, total);
+                conditionMetrics.push_back(&*metrics);
             }
 
+            std::ostringstream msg;
+            msg << MSG_PREFIX << "set " << fileSet->name << ": " << total.seconds << " s, " << total.rows << " rows, " 
+                << total.hits << " hits, " << total.artifacts << " artifacts";
+            LOGINFO(msg.str());
         }
 
-        if (!fileSet.conditions.empty())
-        {
-            fileSets.push_back(fileSet);
-        }
-        else
+        const size_t slowestCount = std::min(conditionMetrics.size(), METRICS_SUMMARY_CONDITION_COUNT);
+        std::partial_sort(conditionMetrics.begin(), conditionMetrics.begin() + slowestCount, conditionMetrics.end(), takesLonger);
+        for (size_t i = 0; i < slowestCount; ++i)
         {
             std::ostringstream msg;
-            msg << MSG_PREFIX << "empty " << INTERESTING_FILE_SET_ELEMENT_TAG << " element '" << fileSet.name << "'"; 
-            //throw TskException(msg.str());
+            msg << MSG_PREFIX << "slowest condition " << i + 1 << ": " << conditionMetrics[i]->definition << " " << conditionMetrics[i]->seconds << " s, " 
+                << conditionMetrics[i]->rows << " rows, " << conditionMetrics[i]->hits << " hits";
+            LOGINFO(msg.str());
         }
+
+        std::ostringstream msg;
+        msg << MSG_PREFIX << "report took " << reportSeconds << " s, scan read " << scanMetrics.rows << " rows in " << scanMetrics.seconds << " s";
+        LOGINFO(msg.str());
     }
 }
 
@@ -434,7 +4511,11 @@ extern "C"
      * Module initialization function. The initialization arguments string should
      * provide the path of a module configuration file that defines what files 
      * are interesting. If the empty string is passed to this function, the module
-     * assumes a default config file is present in the output directory.
+     * assumes a default config file is present in the output directory. The
+     * paths of several configuration files, or rule packs, may be given 
+     * separated by semicolons, in which case the sets of all of them are 
+     * searched together and the name of each set is prefixed by the name of 
+     * its pack.
      *
      * @param args Path of the configuration file that defines what files are 
      * interesting, may be set to the empty string.
@@ -449,6 +4530,26 @@ extern "C"
         {
             // Make sure the file sets are cleared in case initialize() is called more than once.
             fileSets.clear();
+            fileSetNames.clear();
+            packNames.clear();
+            hashSetDatabases.clear();
+            nameRegexes.clear();
+            pathRegexes.clear();
+            fuzzyNames.clear();
+            signatures.clear();
+            directories.clear();
+            for (int i = 0; i < FILE_TIMESTAMP_COUNT; ++i)
+            {
+                timestampIndexes[i].clear();
+            }
+            pathFilters.clear();
+            useFileNameIndex = false;
+            useTrigramIndex = false;
+            fileNameIndex.clear();
+            useMatchFunction = false;
+            useBulkPosting = false;
+            useResultCache = false;
+            contentCachePath.clear();
 
             configFilePath.assign(arguments);
             if (configFilePath.empty())
@@ -460,34 +4561,33 @@ extern "C"
                 configFilePath = configurationFilePath.toString();
             }
 
-            // Compile the contents of the config file into interesting file set definitions.
-            Poco::File configFile = Poco::File(configFilePath);
-            if (configFile.exists())
+            // Compile the contents of the config files into interesting file set definitions. The sets of all of the rule
+            // packs share the regular expression automata, signature table, hash set databases and path filters, so the
+            // search reads each file record once no matter how many packs there are.
+            std::vector<std::string> packFilePaths;
+            for (size_t start = 0; start <= configFilePath.size(); )
             {
-                std::ifstream configStream(configFile.path().c_str());
-                if (configStream)
+                size_t end = configFilePath.find(CONFIG_FILE_PATH_SEPARATOR, start);
+                if (end == std::string::npos)
                 {
-                    Poco::AutoPtr<Poco::XML::Document> configDoc = Poco::XML::DOMParser().parse(&Poco::XML::InputSource(configStream));
-                    Poco::AutoPtr<Poco::XML::NodeList> fileSetDefinitions = configDoc->getElementsByTagName(INTERESTING_FILE_SET_ELEMENT_TAG);
-                    for (unsigned long i = 0; i < fileSetDefinitions->length(); ++i) 
-                    {
-                        compileInterestingFilesSet(fileSetDefinitions->item(i));
-                    }
+                    end = configFilePath.size();
                 }
-                else
+                const std::string path = Poco::trim(configFilePath.substr(start, end - start));
+                if (!path.empty())
                 {
-                    std::ostringstream msg;
-                    msg << MSG_PREFIX << "failed to open config file '" << configFilePath << "'";
-                    throw TskException(msg.str());
+                    packFilePaths.push_back(path);
                 }
+                start = end + 1;
             }
-            else
+            for (std::vector<std::string>::const_iterator path = packFilePaths.begin(); path != packFilePaths.end(); ++path)
             {
-                std::ostringstream msg;
-                msg << MSG_PREFIX << "config file'" << configFilePath << "' does not exist";
-                LOGERROR(msg.str());
+                compileConfigFile(*path, packFilePaths.size() > 1);
             }
 
+            // Build the automata for the regular expression conditions.
+            nameRegexes.compile();
+            pathRegexes.compile();
+
             // Log the configuration.
             std::ostringstream msg;
             msg << MSG_PREFIX << "configured with " << fileSets.size() << " intersting file set definitions from '" << configFilePath << "'";
@@ -546,19 +4646,74 @@ extern "C"
                 return TskModule::FAIL;
             }
 
-            for (std::vector<InterestingFilesSet>::iterator fileSet = fileSets.begin(); fileSet != fileSets.end(); ++fileSet)
+            Poco::Timestamp reportStart;
+            resetMetrics();
+
+            // The pushed down conditions add their hits to the hit table themselves, unless the hits are cached.
+            std::auto_ptr<ResultCache> resultCache(openResultCache());
+            std::vector<std::vector<FileIdSet> > postedHits(fileSets.size());
+            std::vector<bool> isCached(fileSets.size(), false);
+            std::vector<bool> isPosted(fileSets.size(), false);
+            if (resultCache.get() != NULL)
+            {
+                findCachedHits(*resultCache, postedHits, isCached, isPosted);
+            }
+            std::auto_ptr<HitTable> hitTable(openHitTable());
+            findPostedHits(isCached, resultCache.get() != NULL ? NULL : hitTable.get(), postedHits);
+            if (resultCache.get() != NULL)
+            {
+                storeCachedHits(*resultCache, postedHits, isCached);
+            }
+
+            for (size_t i = 0; i < postedHits.size(); ++i)
+            {
+                if (isPosted[i])
+                {
+                    postedHits[i].assign(postedHits[i].size(), FileIdSet());
+                }
+            }
+
+            if (hitTable.get() != NULL)
             {
-                for (std::vector<string>::iterator condition = (*fileSet).conditions.begin(); condition != (*fileSet).conditions.end(); ++condition)
+                postHitsInBulk(postedHits, *hitTable);
+            }
+            else
+            {
+                for (size_t i = 0; i < postedHits.size(); ++i)
                 {
-                    vector<uint64_t> fileIds = TskServices::Instance().getImgDB().getFileIds(*condition);
-                    for (size_t i = 0; i < fileIds.size(); i++)
+                    for (size_t j = 0; j < postedHits[i].size(); ++j)
                     {
-                        TskBlackboardArtifact artifact = TskServices::Instance().getBlackboard().createArtifact(fileIds[i], TSK_INTERESTING_FILE_HIT);
-                        TskBlackboardAttribute attribute(TSK_SET_NAME, "InterestingFiles", (*fileSet).description, (*fileSet).name);
-                        artifact.addAttribute(attribute);
+                        ConditionMetrics &metrics = fileSets[i].scanConditionMetrics[j];
+                        for (FileIdSet::Iterator fileId(postedHits[i][j]); !fileId.atEnd(); fileId.next())
+                        {
+                            Poco::Timestamp start;
+                            postInterestingFileHit(fileId.get(), fileSets[i]);
+                            ++metrics.artifacts;
+                            metrics.seconds += start.elapsed() / 1000000.0;
+                        }
                     }
                 }
             }
+
+            // Only hits that were posted without error are recorded as posted, so that a failed posting is repeated.
+            if (resultCache.get() != NULL)
+            {
+                setCachedHitsPosted(*resultCache, isPosted);
+            }
+
+            reportSeconds = reportStart.elapsed() / 1000000.0;
+            logMetricsSummary();
+            try
+            {
+                writeMetrics();
+            }
+            catch (std::exception &ex)
+            {
+                // The hits have been posted, so failing to write the metrics does not fail the module.
+                std::ostringstream msg;
+                msg << MSG_PREFIX << "failed to write metrics: " << ex.what();
+                LOGWARN(msg.str());
+            }
         }
         catch (TskException &ex)
         {
@@ -603,6 +4758,26 @@ extern "C"
         try
         {
             fileSets.clear();
+            fileSetNames.clear();
+            packNames.clear();
+            hashSetDatabases.clear();
+            nameRegexes.clear();
+            pathRegexes.clear();
+            fuzzyNames.clear();
+            signatures.clear();
+            directories.clear();
+            for (int i = 0; i < FILE_TIMESTAMP_COUNT; ++i)
+            {
+                timestampIndexes[i].clear();
+            }
+            pathFilters.clear();
+            useFileNameIndex = false;
+            useTrigramIndex = false;
+            fileNameIndex.clear();
+            useMatchFunction = false;
+            useBulkPosting = false;
+            useResultCache = false;
+            contentCachePath.clear();
         }
         catch (TskException &ex)
         {
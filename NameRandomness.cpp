@@ -0,0 +1,137 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file NameRandomness.cpp
+ * Contains the implementation of the measures of how random a file name 
+ * looks.
+ */
+
+#include "NameRandomness.h"
+
+// System includes
+#include <cmath>
+
+namespace
+{
+    enum CharacterClass { OTHER_CLASS, LETTER_CLASS, DIGIT_CLASS };
+
+    // The surprise of a pair involving a digit, in bits: digits next to each other are common in names, as in dates, 
+    // but a letter next to a digit is as surprising as an unlikely pair of letters.
+    const unsigned int DIGIT_PAIR_BITS = 2;
+    const unsigned int LETTER_DIGIT_PAIR_BITS = 7;
+
+    // The surprise of each pair of letters, in bits, as a hexadecimal digit: the row is the first letter and the column 
+    // the second. The surprise is -log2 of the probability of the second letter following the first, estimated with 
+    // add-one smoothing from the pairs of letters in about 300,000 words of English text and rounded.
+    const char *LETTER_PAIR_BITS[26] =
+    {
+        "9545985B5A6352B59343568A6B",   // A
+        "4877377A36B37948D45629C84A",   // B
+        "395839A35B448C27C57357C87C",   // C
+        "4765187929A67837F658488D6D",   // D
+        "464355797AA453857235A5757C",   // E
+        "4A7944BA2FF5992BF4754CCD6E",   // F
+        "594728643AE56356E347498C97",   // G
+        "3CAA19BC3FB97948F6846C8F9D",   // H
+        "5446555CBC845236C533A6C7D7",   // I
+        "376627796B866C33594A3A7CAB",   // J
+        "289716483AA7A468A747797C8A",   // K
+        "4884288B2A939A47E855599C4A",   // L
+        "25762C994DA55942DA5959D98C",   // M
+        "4943453B5B668748EA3356AC6A",   // N
+        "7755746A78854264F254465AAB",   // O
+        "3A7839773C746834C3445ABC5E",   // P
+        "999788BB7AA67989A8550ABBA9",   // Q
+        "375627593D675637D644578C4F",   // R
+        "5A5828943A767745A742488B5B",   // S
+        "4A6838C23BA68A36F4556E6A6B",   // T
+        "5555574B4EA443A4C333BCD6BA",   // U
+        "3C8B1A7E3EBB8959DB7B89E9AD",   // V
+        "3CA93D932E97D53CD5599D5DCE",   // W
+        "393A37A84A864BA3A97297A576",   // X
+        "67795A7A59B655138533798B78",   // Y
+        "3877197629745958A8796A8974"    // Z
+    };
+
+    /**
+     * The classes of the bytes, indexed by byte.
+     */
+    class CharacterClasses
+    {
+    public:
+        CharacterClasses()
+        {
+            for (int c = 0; c < 256; ++c)
+            {
+                m_classes[c] = static_cast<unsigned char>(c >= 'A' && c <= 'Z' ? LETTER_CLASS : c >= '0' && c <= '9' ? DIGIT_CLASS : OTHER_CLASS);
+            }
+        }
+
+        CharacterClass get(unsigned char c) const { return static_cast<CharacterClass>(m_classes[c]); }
+
+    private:
+        unsigned char m_classes[256];
+    };
+
+    const CharacterClasses characterClasses;
+
+    unsigned int getPairBits(unsigned char first, CharacterClass firstClass, unsigned char second, CharacterClass secondClass)
+    {
+        if (firstClass == LETTER_CLASS && secondClass == LETTER_CLASS)
+        {
+            const char bits = LETTER_PAIR_BITS[first - 'A'][second - 'A'];
+            return bits <= '9' ? bits - '0' : bits - 'A' + 10;
+        }
+        return firstClass == DIGIT_CLASS && secondClass == DIGIT_CLASS ? DIGIT_PAIR_BITS : LETTER_DIGIT_PAIR_BITS;
+    }
+}
+
+NameRandomness::NameRandomness(const std::string &foldedName) : length(foldedName.size()), entropy(0.0), bigramBits(0.0)
+{
+    if (foldedName.empty())
+    {
+        return;
+    }
+
+    // The histogram of the bytes and the surprise of the pairs are gathered in one pass over the name.
+    unsigned int histogram[256] = { 0 };
+    unsigned int pairBits = 0;
+    unsigned int pairCount = 0;
+    unsigned char previous = 0;
+    CharacterClass previousClass = OTHER_CLASS;
+    for (std::string::const_iterator c = foldedName.begin(); c != foldedName.end(); ++c)
+    {
+        const unsigned char byte = static_cast<unsigned char>(*c);
+        const CharacterClass byteClass = characterClasses.get(byte);
+        ++histogram[byte];
+        if (previousClass != OTHER_CLASS && byteClass != OTHER_CLASS)
+        {
+            pairBits += getPairBits(previous, previousClass, byte, byteClass);
+            ++pairCount;
+        }
+        previous = byte;
+        previousClass = byteClass;
+    }
+
+    // Only the bytes of the name need to be visited to sum the entropy.
+    const double nameLength = static_cast<double>(foldedName.size());
+    for (std::string::const_iterator c = foldedName.begin(); c != foldedName.end(); ++c)
+    {
+        unsigned int &count = histogram[static_cast<unsigned char>(*c)];
+        if (count != 0)
+        {
+            const double probability = count / nameLength;
+            entropy -= probability * std::log(probability) / std::log(2.0);
+            count = 0;
+        }
+    }
+
+    bigramBits = pairCount != 0 ? static_cast<double>(pairBits) / pairCount : 0.0;
+}
@@ -0,0 +1,53 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file NameRandomness.h
+ * Contains the interface of the measures of how random a file name looks.
+ */
+
+#ifndef _NAME_RANDOMNESS_H
+#define _NAME_RANDOMNESS_H
+
+// System includes
+#include <string>
+
+/**
+ * Measures of how random a file name looks, such as "a8f3kq2z" compared 
+ * with "document".
+ */
+struct NameRandomness
+{
+    NameRandomness() : length(0), entropy(0.0), bigramBits(0.0) {}
+
+    /**
+     * Measures a name.
+     *
+     * @param foldedName The name, without its extension, folded to upper 
+     * case.
+     */
+    explicit NameRandomness(const std::string &foldedName);
+
+    /** The length of the name, in bytes. */
+    size_t length;
+
+    /** The Shannon entropy of the characters of the name, in bits per character. */
+    double entropy;
+
+    /**
+     * The average surprise of the adjacent pairs of letters and digits in
+     * the name, in bits, under a model of the pairs of letters in English 
+     * words in which a letter next to a digit is as surprising as in a 
+     * random name. Ordinary words average about 3.5 bits, and random 
+     * letters about 7.
+     */
+    double bigramBits;
+};
+
+#endif
@@ -0,0 +1,267 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file NameSkeleton.cpp
+ * Contains the implementation of a function that reduces file names to 
+ * skeletons in which characters that look alike are the same.
+ */
+
+#include "NameSkeleton.h"
+
+// System includes
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    /** A character that is replaced by a string of ASCII characters in a skeleton. */
+    struct Confusable
+    {
+        unsigned int codePoint;
+        const char *skeleton;
+    };
+
+    // The replacements of upper case letters, after case folding, sorted by code point. An empty skeleton removes the 
+    // character.
+    const Confusable CONFUSABLES[] =
+    {
+        { 0x00AD, "" },                                                                     // Soft hyphen
+        { 0x0391, "A" }, { 0x0392, "B" }, { 0x0395, "E" }, { 0x0396, "Z" }, { 0x0397, "H" }, // Greek
+        { 0x0399, "L" }, { 0x039A, "K" }, { 0x039C, "RN" }, { 0x039D, "N" }, { 0x039F, "O" },
+        { 0x03A1, "P" }, { 0x03A4, "T" }, { 0x03A5, "Y" }, { 0x03A7, "X" },
+        { 0x0405, "S" }, { 0x0406, "L" }, { 0x0408, "J" },                                  // Cyrillic
+        { 0x0410, "A" }, { 0x0412, "B" }, { 0x0415, "E" }, { 0x041A, "K" }, { 0x041C, "RN" }, 
+        { 0x041D, "H" }, { 0x041E, "O" }, { 0x0420, "P" }, { 0x0421, "C" }, { 0x0422, "T" }, 
+        { 0x0423, "Y" }, { 0x0425, "X" }, { 0x04C0, "L" },
+        { 0x200B, "" }, { 0x200C, "" }, { 0x200D, "" }, { 0x200E, "" }, { 0x200F, "" },     // Zero width and direction marks
+        { 0x2024, "." },                                                                    // One dot leader
+        { 0x202A, "" }, { 0x202B, "" }, { 0x202C, "" }, { 0x202D, "" }, { 0x202E, "" },     // Bidirectional embeddings and overrides
+        { 0x2044, "/" },                                                                    // Fraction slash
+        { 0x2060, "" }, { 0x2066, "" }, { 0x2067, "" }, { 0x2068, "" }, { 0x2069, "" },     // Word joiner and bidirectional isolates
+        { 0x2215, "/" },                                                                    // Division slash
+        { 0xFEFF, "" }                                                                      // Zero width no-break space
+    };
+
+    bool hasLowerCodePoint(const Confusable &confusable, unsigned int codePoint)
+    {
+        return confusable.codePoint < codePoint;
+    }
+
+    /**
+     * The skeletons of the ASCII characters, indexed by character.
+     */
+    class AsciiSkeletons
+    {
+    public:
+        AsciiSkeletons()
+        {
+            for (int c = 0; c < 128; ++c)
+            {
+                m_skeletons[c] = std::string(1, static_cast<char>(c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c));
+            }
+            m_skeletons[static_cast<int>('0')] = "O";
+            m_skeletons[static_cast<int>('1')] = "L";
+            m_skeletons[static_cast<int>('I')] = "L";
+            m_skeletons[static_cast<int>('i')] = "L";
+            m_skeletons[static_cast<int>('|')] = "L";
+            m_skeletons[static_cast<int>('M')] = "RN";
+            m_skeletons[static_cast<int>('m')] = "RN";
+        }
+
+        const std::string &get(unsigned char c) const { return m_skeletons[c]; }
+
+    private:
+        std::string m_skeletons[128];
+    };
+
+    const AsciiSkeletons asciiSkeletons;
+
+    /**
+     * Folds a code point to upper case, for the scripts that are folded.
+     */
+    unsigned int foldCase(unsigned int codePoint)
+    {
+        if (codePoint >= 0xFF01 && codePoint <= 0xFF5E)
+        {
+            // Full width forms of ASCII characters.
+            codePoint -= 0xFF01 - 0x21;
+        }
+        if (codePoint < 0x80)
+        {
+            return codePoint >= 'a' && codePoint <= 'z' ? codePoint - 'a' + 'A' : codePoint;
+        }
+        if ((codePoint >= 0xE0 && codePoint <= 0xFE && codePoint != 0xF7) ||          // Latin-1
+            (codePoint >= 0x3B1 && codePoint <= 0x3CB && codePoint != 0x3C2) ||        // Greek
+            (codePoint >= 0x430 && codePoint <= 0x44F))                                // Cyrillic
+        {
+            return codePoint - 0x20;
+        }
+        if (codePoint == 0xFF)
+        {
+            return 0x178;
+        }
+        if (codePoint == 0x3C2)
+        {
+            // Final sigma.
+            return 0x3A3;
+        }
+        if (codePoint >= 0x450 && codePoint <= 0x45F)
+        {
+            return codePoint - 0x50;
+        }
+        if (((codePoint >= 0x100 && codePoint <= 0x137) || (codePoint >= 0x14A && codePoint <= 0x177) || (codePoint >= 0x460 && codePoint <= 0x481) ||
+            (codePoint >= 0x48A && codePoint <= 0x4BF)) && (codePoint & 1) != 0)
+        {
+            // Latin Extended-A and Cyrillic letters in upper and lower case pairs, upper case first.
+            return codePoint - 1;
+        }
+        if (((codePoint >= 0x139 && codePoint <= 0x148) || (codePoint >= 0x179 && codePoint <= 0x17E) || (codePoint >= 0x4C1 && codePoint <= 0x4CE)) && 
+            (codePoint & 1) == 0)
+        {
+            // Latin Extended-A and Cyrillic letters in upper and lower case pairs, lower case first.
+            return codePoint - 1;
+        }
+        if (codePoint == 0x4CF)
+        {
+            // Cyrillic small letter palochka.
+            return 0x4C0;
+        }
+        return codePoint;
+    }
+
+    /**
+     * Decodes a UTF-8 character.
+     *
+     * @param name The string.
+     * @param position The position of the first byte of the character, 
+     * advanced past the character.
+     * @param codePoint Receives the code point of the character.
+     * @return False if the bytes at the position are not a valid UTF-8 
+     * character, in which case the position is not advanced.
+     */
+    bool decodeUtf8(const std::string &name, size_t &position, unsigned int &codePoint)
+    {
+        const unsigned char lead = static_cast<unsigned char>(name[position]);
+        size_t length;
+        unsigned int minCodePoint;
+        if ((lead & 0xE0) == 0xC0)
+        {
+            length = 2;
+            codePoint = lead & 0x1F;
+            minCodePoint = 0x80;
+        }
+        else if ((lead & 0xF0) == 0xE0)
+        {
+            length = 3;
+            codePoint = lead & 0x0F;
+            minCodePoint = 0x800;
+        }
+        else if ((lead & 0xF8) == 0xF0)
+        {
+            length = 4;
+            codePoint = lead & 0x07;
+            minCodePoint = 0x10000;
+        }
+        else
+        {
+            return false;
+        }
+
+        if (position + length > name.size())
+        {
+            return false;
+        }
+        for (size_t i = 1; i < length; ++i)
+        {
+            const unsigned char continuation = static_cast<unsigned char>(name[position + i]);
+            if ((continuation & 0xC0) != 0x80)
+            {
+                return false;
+            }
+            codePoint = (codePoint << 6) | (continuation & 0x3F);
+        }
+        if (codePoint < minCodePoint || codePoint > 0x10FFFF)
+        {
+            return false;
+        }
+
+        position += length;
+        return true;
+    }
+
+    void encodeUtf8(unsigned int codePoint, std::string &skeleton)
+    {
+        if (codePoint < 0x80)
+        {
+            skeleton += static_cast<char>(codePoint);
+        }
+        else if (codePoint < 0x800)
+        {
+            skeleton += static_cast<char>(0xC0 | (codePoint >> 6));
+            skeleton += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else if (codePoint < 0x10000)
+        {
+            skeleton += static_cast<char>(0xE0 | (codePoint >> 12));
+            skeleton += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            skeleton += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else
+        {
+            skeleton += static_cast<char>(0xF0 | (codePoint >> 18));
+            skeleton += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            skeleton += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            skeleton += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+}
+
+std::string getNameSkeleton(const std::string &name)
+{
+    std::string skeleton;
+    skeleton.reserve(name.size());
+    const Confusable *confusablesEnd = CONFUSABLES + sizeof(CONFUSABLES) / sizeof(CONFUSABLES[0]);
+    size_t position = 0;
+    while (position < name.size())
+    {
+        const unsigned char c = static_cast<unsigned char>(name[position]);
+        if (c < 0x80)
+        {
+            skeleton += asciiSkeletons.get(c);
+            ++position;
+            continue;
+        }
+
+        unsigned int codePoint;
+        if (!decodeUtf8(name, position, codePoint))
+        {
+            skeleton += static_cast<char>(c);
+            ++position;
+            continue;
+        }
+
+        codePoint = foldCase(codePoint);
+        if (codePoint < 0x80)
+        {
+            skeleton += asciiSkeletons.get(static_cast<unsigned char>(codePoint));
+            continue;
+        }
+        const Confusable *confusable = std::lower_bound(CONFUSABLES, confusablesEnd, codePoint, hasLowerCodePoint);
+        if (confusable != confusablesEnd && confusable->codePoint == codePoint)
+        {
+            skeleton += confusable->skeleton;
+        }
+        else
+        {
+            encodeUtf8(codePoint, skeleton);
+        }
+    }
+    return skeleton;
+}
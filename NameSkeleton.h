@@ -0,0 +1,42 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file NameSkeleton.h
+ * Contains the interface of a function that reduces file names to skeletons
+ * in which characters that look alike are the same.
+ */
+
+#ifndef _NAME_SKELETON_H
+#define _NAME_SKELETON_H
+
+// System includes
+#include <string>
+
+/**
+ * Gets the skeleton of a UTF-8 file name, in the manner of the confusable
+ * skeletons of Unicode Technical Standard #39, so that names that look
+ * alike have the same skeleton. The name is case folded to upper case,
+ * including Latin-1, Latin Extended-A, Greek and Cyrillic letters; full 
+ * width forms are replaced by their ASCII equivalents; Greek and Cyrillic 
+ * letters that look like Latin letters are replaced by them; invisible 
+ * formatting characters such as zero width spaces and bidirectional 
+ * overrides are removed; and '0', '1', 'I', '|' and 'M' are replaced by 
+ * 'O', 'L', 'L', 'L' and "RN". Bytes that are not valid UTF-8 are kept.
+ *
+ * Names that are entirely ASCII, as most are, are reduced a byte at a time
+ * with a lookup table. The skeleton of a glob pattern is a glob pattern 
+ * that matches the skeletons of the names the pattern matches.
+ *
+ * @param name The file name.
+ * @return The skeleton of the name.
+ */
+std::string getNameSkeleton(const std::string &name);
+
+#endif
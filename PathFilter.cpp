@@ -0,0 +1,208 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file PathFilter.cpp
+ * Contains the implementation of a path substring filter that is evaluated
+ * once per directory.
+ */
+
+#include "PathFilter.h"
+
+// TSK Framework includes
+#include "TskModuleDev.h"
+
+// System includes
+#include <sstream>
+#include <algorithm>
+
+namespace
+{
+    // The matched prefixes of a directory are kept in a 64 bit mask.
+    const size_t MAX_PATH_FILTER_COMPONENTS = 64;
+
+    const char PATH_SEPARATOR = '/';
+
+    bool startsWith(const std::string &text, const std::string &prefix)
+    {
+        return text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    bool endsWith(const std::string &text, const std::string &suffix)
+    {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    std::string normalizeSeparators(const std::string &path)
+    {
+        std::string normalizedPath(path);
+        std::replace(normalizedPath.begin(), normalizedPath.end(), '\\', PATH_SEPARATOR);
+        return normalizedPath;
+    }
+}
+
+PathFilter::PathFilter(const std::string &filter) :
+    m_hasWildcards(filter.find('*') != std::string::npos), m_pathPattern(normalizeSeparators(filter)), m_directories(NULL)
+{
+    size_t componentStart = 0;
+    while (true)
+    {
+        const size_t separator = m_pathPattern.find(PATH_SEPARATOR, componentStart);
+        m_components.push_back(m_pathPattern.substr(componentStart, separator - componentStart));
+        if (separator == std::string::npos)
+        {
+            break;
+        }
+        componentStart = separator + 1;
+    }
+
+    if (!m_hasWildcards && m_components.size() > MAX_PATH_FILTER_COMPONENTS)
+    {
+        std::ostringstream msg;
+        msg << "PathFilter::PathFilter : path filter " << filter << " has more than " << MAX_PATH_FILTER_COMPONENTS << " components";
+        throw TskException(msg.str());
+    }
+}
+
+bool PathFilter::matches(const DirectoryTree &directories, size_t parent, const std::string &name) const
+{
+    prepare(directories);
+    const DirectoryState &parentState = getState(directories, parent);
+    return parentState.containsFilter == 1 || completes(parentState, name);
+}
+
+bool PathFilter::matchesPath(const std::string &path) const
+{
+    const std::string normalizedPath = normalizeSeparators(path);
+
+    // The pattern is an implicit substring match, so the pieces between the
+    // wildcards only need to be found in order.
+    size_t position = 0;
+    size_t pieceStart = 0;
+    while (pieceStart <= m_pathPattern.size())
+    {
+        size_t pieceEnd = m_pathPattern.find('*', pieceStart);
+        if (pieceEnd == std::string::npos)
+        {
+            pieceEnd = m_pathPattern.size();
+        }
+
+        if (pieceEnd > pieceStart)
+        {
+            const size_t found = normalizedPath.find(m_pathPattern.substr(pieceStart, pieceEnd - pieceStart), position);
+            if (found == std::string::npos)
+            {
+                return false;
+            }
+            position = found + (pieceEnd - pieceStart);
+        }
+        pieceStart = pieceEnd + 1;
+    }
+    return true;
+}
+
+void PathFilter::prepare(const DirectoryTree &directories) const
+{
+    if (m_directories == &directories && m_states.size() == directories.size())
+    {
+        return;
+    }
+
+    m_directories = &directories;
+    DirectoryState unknownState;
+    unknownState.matchedPrefixes = 0;
+    unknownState.containsFilter = -1;
+    m_states.assign(directories.size(), unknownState);
+
+    // Components other than the first and last must be whole directory names.
+    m_componentNameIds.assign(m_components.size(), DirectoryTree::NO_NAME);
+    for (size_t i = 1; i + 1 < m_components.size(); ++i)
+    {
+        m_componentNameIds[i] = directories.findName(m_components[i]);
+    }
+}
+
+const PathFilter::DirectoryState &PathFilter::getState(const DirectoryTree &directories, size_t directory) const
+{
+    // Walk up to the first directory whose state is known, then work out the
+    // states of the directories on the way back down.
+    m_path.clear();
+    size_t ancestor = directory;
+    while (ancestor != DirectoryTree::NO_DIRECTORY && m_states[ancestor].containsFilter == -1)
+    {
+        m_path.push_back(ancestor);
+        ancestor = directories.getParent(ancestor);
+        if (m_path.size() > directories.size())
+        {
+            // The parent links of a damaged file system can form a cycle.
+            ancestor = DirectoryTree::NO_DIRECTORY;
+            break;
+        }
+    }
+
+    DirectoryState noState;
+    noState.matchedPrefixes = 0;
+    noState.containsFilter = 0;
+
+    for (std::vector<size_t>::const_reverse_iterator pathDirectory = m_path.rbegin(); pathDirectory != m_path.rend(); ++pathDirectory)
+    {
+        DirectoryState parentState = noState;
+        if (ancestor != DirectoryTree::NO_DIRECTORY)
+        {
+            parentState = m_states[ancestor];
+        }
+        else if (!directories.getName(*pathDirectory).empty())
+        {
+            // The root directory of a file system, which has no name, is not
+            // in the tree, so account for the separator that begins the path.
+            parentState = getChildState(noState, DirectoryTree::NO_NAME, "");
+        }
+
+        m_states[*pathDirectory] = getChildState(parentState, directories.getNameId(*pathDirectory), directories.getName(*pathDirectory));
+        ancestor = *pathDirectory;
+    }
+
+    return m_states[directory];
+}
+
+PathFilter::DirectoryState PathFilter::getChildState(const DirectoryState &parentState, size_t nameId, const std::string &name) const
+{
+    DirectoryState state;
+    state.containsFilter = parentState.containsFilter == 1 || completes(parentState, name) ? 1 : 0;
+    state.matchedPrefixes = 0;
+
+    const size_t lastComponent = m_components.size() - 1;
+    if (lastComponent > 0)
+    {
+        if (endsWith(name, m_components[0]))
+        {
+            state.matchedPrefixes |= 2;
+        }
+
+        for (size_t i = 1; i < lastComponent; ++i)
+        {
+            if ((parentState.matchedPrefixes & (static_cast<uint64_t>(1) << i)) && nameId != DirectoryTree::NO_NAME && nameId == m_componentNameIds[i])
+            {
+                state.matchedPrefixes |= static_cast<uint64_t>(1) << (i + 1);
+            }
+        }
+    }
+
+    return state;
+}
+
+bool PathFilter::completes(const DirectoryState &parentState, const std::string &name) const
+{
+    const size_t lastComponent = m_components.size() - 1;
+    if (lastComponent == 0)
+    {
+        return name.find(m_components[0]) != std::string::npos;
+    }
+    return (parentState.matchedPrefixes & (static_cast<uint64_t>(1) << lastComponent)) && startsWith(name, m_components[lastComponent]);
+}
@@ -0,0 +1,106 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file PathFilter.h
+ * Contains the interface of a path substring filter that is evaluated once
+ * per directory rather than once per file.
+ */
+
+#ifndef _PATH_FILTER_H
+#define _PATH_FILTER_H
+
+#include "DirectoryTree.h"
+
+// System includes
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * A path filter determines whether the path of a file contains a substring.
+ * Both '/' and '\\' are path separators, in the filter and in paths.
+ *
+ * The filter is split into components at the separators. A path contains
+ * the filter if consecutive components of the path match the filter
+ * components: the first filter component must end a path component, the
+ * last must begin a path component, and any in between must equal path
+ * components. Middle components are compared by directory tree name id.
+ *
+ * Which prefixes of the filter match at the end of the path of each
+ * directory, and whether the whole filter occurs in the path of the
+ * directory, is worked out once per directory from the result for its
+ * parent. Checking a file then only looks at its parent directory's result
+ * and the file name.
+ *
+ * Filters containing the '*' wildcard, and files whose parent directory is
+ * not in the directory tree, are matched against the full path instead.
+ */
+class PathFilter
+{
+public:
+    /**
+     * @param filter The path substring, folded to upper case. May contain
+     * '*' wildcards.
+     * @throws TskException If the filter has too many components.
+     */
+    explicit PathFilter(const std::string &filter);
+
+    /**
+     * Determines whether the filter is evaluated using the directory tree.
+     * If not, only matchesPath() may be used.
+     */
+    bool usesDirectoryTree() const { return !m_hasWildcards; }
+
+    /**
+     * Determines whether the path of a file contains the filter, using the
+     * directory tree.
+     *
+     * @param directories The directory tree, with names folded to upper case.
+     * @param parent The index of the parent directory of the file.
+     * @param name The name of the file, folded to upper case.
+     * @return True if the path of the file contains the filter.
+     */
+    bool matches(const DirectoryTree &directories, size_t parent, const std::string &name) const;
+
+    /**
+     * Determines whether a path contains the filter.
+     *
+     * @param path The full path of a file, folded to upper case.
+     * @return True if the path contains the filter.
+     */
+    bool matchesPath(const std::string &path) const;
+
+private:
+    /** What is known about the path of a directory. */
+    struct DirectoryState
+    {
+        // Bit j is set if the first j filter components match the components
+        // that end the path of the directory.
+        uint64_t matchedPrefixes;
+        // -1 if not yet known, otherwise whether the path contains the filter.
+        signed char containsFilter;
+    };
+
+    void prepare(const DirectoryTree &directories) const;
+    const DirectoryState &getState(const DirectoryTree &directories, size_t directory) const;
+    DirectoryState getChildState(const DirectoryState &parentState, size_t nameId, const std::string &name) const;
+    bool completes(const DirectoryState &parentState, const std::string &name) const;
+
+    std::vector<std::string> m_components;
+    bool m_hasWildcards;
+    std::string m_pathPattern;
+
+    mutable const DirectoryTree *m_directories;
+    mutable std::vector<size_t> m_componentNameIds;
+    mutable std::vector<DirectoryState> m_states;
+    mutable std::vector<size_t> m_path;
+};
+
+#endif
@@ -0,0 +1,994 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file RegexSet.cpp
+ * Contains the implementation of a multi-pattern regular expression matcher
+ * based on a lazily built DFA.
+ */
+
+#include "RegexSet.h"
+
+// TSK Framework includes
+#include "TskModuleDev.h"
+
+// System includes
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define REGEX_SET_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // Limits that keep compiled expressions and the DFA state cache bounded.
+    const size_t MAX_REPETITION_COUNT = 1000;
+    const size_t MAX_NFA_STATES_PER_EXPRESSION = 20000;
+    const size_t MAX_DFA_STATES = 4096;
+
+    /**
+     * Gets the number of NFA states a syntax tree node compiles to, used to
+     * reject expressions that grow too large while they are parsed.
+     */
+    template <typename NodeType>
+    size_t countNfaStates(const NodeType &node)
+    {
+        size_t count = 1;
+        for (typename std::vector<NodeType>::const_iterator child = node.children.begin(); child != node.children.end(); ++child)
+        {
+            count += countNfaStates(*child);
+        }
+        return count;
+    }
+}
+
+RegexSet::ByteSet::ByteSet()
+{
+    memset(bits, 0, sizeof(bits));
+}
+
+void RegexSet::ByteSet::add(unsigned char byte)
+{
+    bits[byte / 32] |= 1u << (byte % 32);
+}
+
+void RegexSet::ByteSet::addRange(unsigned char first, unsigned char last)
+{
+    for (unsigned int byte = first; byte <= last; ++byte)
+    {
+        add(static_cast<unsigned char>(byte));
+    }
+}
+
+void RegexSet::ByteSet::addAll(const ByteSet &other)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        bits[i] |= other.bits[i];
+    }
+}
+
+void RegexSet::ByteSet::invert()
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        bits[i] = ~bits[i];
+    }
+}
+
+bool RegexSet::ByteSet::contains(unsigned char byte) const
+{
+    return (bits[byte / 32] & (1u << (byte % 32))) != 0;
+}
+
+bool RegexSet::ByteSet::isSingleByte(unsigned char &byte) const
+{
+    // Input is folded to upper case, so lower case letters in a set never
+    // match anything and do not count.
+    int count = 0;
+    for (unsigned int i = 0; i < 256; ++i)
+    {
+        if (contains(static_cast<unsigned char>(i)) && !(i >= 'a' && i <= 'z'))
+        {
+            byte = static_cast<unsigned char>(i);
+            ++count;
+        }
+    }
+    return count == 1;
+}
+
+/**
+ * A recursive descent parser that converts an expression into a syntax tree.
+ * Byte sets are folded to upper case as they are parsed.
+ */
+class RegexSet::Parser
+{
+public:
+    Parser(const std::string &expression, std::vector<ByteSet> &byteSets) :
+        m_expression(expression), m_position(0), m_end(expression.size()), m_byteSets(byteSets)
+    {
+    }
+
+    Node parse(bool &anchoredAtStart, bool &anchoredAtEnd)
+    {
+        anchoredAtStart = false;
+        anchoredAtEnd = false;
+        if (m_end > 0 && m_expression[0] == '^')
+        {
+            anchoredAtStart = true;
+            m_position = 1;
+        }
+        if (m_end > m_position && m_expression[m_end - 1] == '$')
+        {
+            // The '$' is an anchor unless it is escaped.
+            size_t backslashCount = 0;
+            while (m_end - 1 - backslashCount > m_position && m_expression[m_end - 2 - backslashCount] == '\\')
+            {
+                ++backslashCount;
+            }
+            if (backslashCount % 2 == 0)
+            {
+                anchoredAtEnd = true;
+                --m_end;
+            }
+        }
+
+        Node root = parseAlternation();
+        if (m_position != m_end)
+        {
+            fail("unexpected ')'");
+        }
+        return root;
+    }
+
+private:
+    void fail(const std::string &reason) const
+    {
+        std::ostringstream msg;
+        msg << "RegexSet::Parser : " << reason << " at offset " << m_position << " of regular expression '" << m_expression << "'";
+        throw TskException(msg.str());
+    }
+
+    /**
+     * Fails if a part of the expression compiles to too many NFA states, so
+     * that counted repetitions are rejected before they are expanded.
+     */
+    void checkStateCount(size_t stateCount) const
+    {
+        if (stateCount > MAX_NFA_STATES_PER_EXPRESSION)
+        {
+            fail("regular expression is too large");
+        }
+    }
+
+    bool atEnd() const
+    {
+        return m_position >= m_end;
+    }
+
+    char peek() const
+    {
+        return m_expression[m_position];
+    }
+
+    Node makeBytes(ByteSet byteSet)
+    {
+        // Fold lower case letters to upper case.
+        for (unsigned char c = 'a'; c <= 'z'; ++c)
+        {
+            if (byteSet.contains(c))
+            {
+                byteSet.add(static_cast<unsigned char>(c - 'a' + 'A'));
+            }
+        }
+        Node node(Node::BYTES);
+        node.bytes = m_byteSets.size();
+        m_byteSets.push_back(byteSet);
+        return node;
+    }
+
+    Node parseAlternation()
+    {
+        Node alternatives(Node::ALTERNATE);
+        alternatives.children.push_back(parseConcatenation());
+        size_t stateCount = 1 + countNfaStates(alternatives.children.back());
+        while (!atEnd() && peek() == '|')
+        {
+            ++m_position;
+            alternatives.children.push_back(parseConcatenation());
+            stateCount += countNfaStates(alternatives.children.back());
+            checkStateCount(stateCount);
+        }
+        if (alternatives.children.size() == 1)
+        {
+            return alternatives.children[0];
+        }
+        return alternatives;
+    }
+
+    Node parseConcatenation()
+    {
+        Node sequence(Node::CONCATENATE);
+        size_t stateCount = 1;
+        while (!atEnd() && peek() != '|' && peek() != ')')
+        {
+            sequence.children.push_back(parseRepetition());
+            stateCount += countNfaStates(sequence.children.back());
+            checkStateCount(stateCount);
+        }
+        if (sequence.children.empty())
+        {
+            return Node(Node::EMPTY);
+        }
+        if (sequence.children.size() == 1)
+        {
+            return sequence.children[0];
+        }
+        return sequence;
+    }
+
+    Node parseRepetition()
+    {
+        Node node = parseAtom();
+        while (!atEnd())
+        {
+            const char c = peek();
+            if (c == '*' || c == '+' || c == '?')
+            {
+                ++m_position;
+                Node repeated(c == '*' ? Node::STAR : (c == '+' ? Node::PLUS : Node::OPTIONAL));
+                repeated.children.push_back(node);
+                node = repeated;
+            }
+            else if (c == '{')
+            {
+                node = parseCountedRepetition(node);
+            }
+            else
+            {
+                break;
+            }
+        }
+        return node;
+    }
+
+    size_t parseCount()
+    {
+        size_t count = 0;
+        const size_t start = m_position;
+        while (!atEnd() && peek() >= '0' && peek() <= '9')
+        {
+            count = count * 10 + (peek() - '0');
+            if (count > MAX_REPETITION_COUNT)
+            {
+                fail("repetition count too large");
+            }
+            ++m_position;
+        }
+        if (m_position == start)
+        {
+            fail("expected repetition count");
+        }
+        return count;
+    }
+
+    Node parseCountedRepetition(const Node &node)
+    {
+        // Expand x{m,n} into m copies of x followed by n - m optional copies,
+        // or by x* if there is no upper bound.
+        ++m_position;
+        const size_t minimum = parseCount();
+        size_t maximum = minimum;
+        bool unbounded = false;
+        if (!atEnd() && peek() == ',')
+        {
+            ++m_position;
+            if (!atEnd() && peek() == '}')
+            {
+                unbounded = true;
+            }
+            else
+            {
+                maximum = parseCount();
+            }
+        }
+        if (atEnd() || peek() != '}')
+        {
+            fail("expected '}'");
+        }
+        ++m_position;
+        if (!unbounded && maximum < minimum)
+        {
+            fail("invalid repetition range");
+        }
+
+        // Each copy of x is wrapped in a node of its own when it is optional.
+        const size_t copyCount = unbounded ? minimum + 1 : maximum;
+        if (copyCount != 0 && countNfaStates(node) + 1 > MAX_NFA_STATES_PER_EXPRESSION / copyCount)
+        {
+            fail("regular expression is too large");
+        }
+
+        Node sequence(Node::CONCATENATE);
+        for (size_t i = 0; i < minimum; ++i)
+        {
+            sequence.children.push_back(node);
+        }
+        if (unbounded)
+        {
+            Node star(Node::STAR);
+            star.children.push_back(node);
+            sequence.children.push_back(star);
+        }
+        else
+        {
+            for (size_t i = minimum; i < maximum; ++i)
+            {
+                Node optional(Node::OPTIONAL);
+                optional.children.push_back(node);
+                sequence.children.push_back(optional);
+            }
+        }
+        if (sequence.children.empty())
+        {
+            return Node(Node::EMPTY);
+        }
+        return sequence;
+    }
+
+    Node parseAtom()
+    {
+        const char c = peek();
+        ++m_position;
+        switch (c)
+        {
+        case '(':
+            {
+                // Groups do not capture, so "(?:" is the same as "(".
+                if (m_position + 1 < m_end && peek() == '?' && m_expression[m_position + 1] == ':')
+                {
+                    m_position += 2;
+                }
+                Node group = parseAlternation();
+                if (atEnd() || peek() != ')')
+                {
+                    fail("expected ')'");
+                }
+                ++m_position;
+                return group;
+            }
+        case '[':
+            return makeBytes(parseClass());
+        case '.':
+            {
+                ByteSet any;
+                any.invert();
+                return makeBytes(any);
+            }
+        case '\\':
+            return makeBytes(parseEscape());
+        case '*':
+        case '+':
+        case '?':
+        case '{':
+            --m_position;
+            fail("nothing to repeat");
+            return Node(Node::EMPTY);
+        case '^':
+        case '$':
+            --m_position;
+            fail("anchors are only supported at the start or end of an expression");
+            return Node(Node::EMPTY);
+        default:
+            {
+                ByteSet literal;
+                literal.add(static_cast<unsigned char>(c));
+                return makeBytes(literal);
+            }
+        }
+        return Node(Node::EMPTY);
+    }
+
+    ByteSet parseEscape()
+    {
+        if (atEnd())
+        {
+            fail("trailing '\\'");
+        }
+
+        ByteSet byteSet;
+        const char c = peek();
+        ++m_position;
+        switch (c)
+        {
+        case 'd':
+        case 'D':
+            byteSet.addRange('0', '9');
+            break;
+        case 'w':
+        case 'W':
+            byteSet.addRange('0', '9');
+            byteSet.addRange('A', 'Z');
+            byteSet.addRange('a', 'z');
+            byteSet.add('_');
+            break;
+        case 's':
+        case 'S':
+            byteSet.add(' ');
+            byteSet.addRange('\t', '\r');
+            break;
+        case 't':
+            byteSet.add('\t');
+            break;
+        case 'x':
+            {
+                unsigned int value = 0;
+                for (int i = 0; i < 2; ++i)
+                {
+                    if (atEnd() || !isxdigit(static_cast<unsigned char>(peek())))
+                    {
+                        fail("expected two hex digits after '\\x'");
+                    }
+                    const char digit = static_cast<char>(toupper(static_cast<unsigned char>(peek())));
+                    value = value * 16 + (digit <= '9' ? digit - '0' : digit - 'A' + 10);
+                    ++m_position;
+                }
+                byteSet.add(static_cast<unsigned char>(value));
+            }
+            break;
+        default:
+            if (isalnum(static_cast<unsigned char>(c)))
+            {
+                --m_position;
+                fail("unsupported escape");
+            }
+            byteSet.add(static_cast<unsigned char>(c));
+            break;
+        }
+
+        if (c == 'D' || c == 'W' || c == 'S')
+        {
+            byteSet.invert();
+        }
+        return byteSet;
+    }
+
+    ByteSet parseClass()
+    {
+        ByteSet byteSet;
+        bool negated = false;
+        if (!atEnd() && peek() == '^')
+        {
+            negated = true;
+            ++m_position;
+        }
+
+        bool first = true;
+        while (!atEnd() && (peek() != ']' || first))
+        {
+            first = false;
+            ByteSet member;
+            unsigned char low = 0;
+            bool isSingle = false;
+            if (peek() == '\\')
+            {
+                ++m_position;
+                member = parseEscape();
+                isSingle = member.isSingleByte(low);
+            }
+            else
+            {
+                low = static_cast<unsigned char>(peek());
+                ++m_position;
+                member.add(low);
+                isSingle = true;
+            }
+
+            if (isSingle && m_position + 1 < m_end && peek() == '-' && m_expression[m_position + 1] != ']')
+            {
+                ++m_position;
+                unsigned char high = static_cast<unsigned char>(peek());
+                ++m_position;
+                if (high == '\\')
+                {
+                    ByteSet escaped = parseEscape();
+                    if (!escaped.isSingleByte(high))
+                    {
+                        fail("invalid class range");
+                    }
+                }
+                if (high < low)
+                {
+                    fail("invalid class range");
+                }
+                member.addRange(low, high);
+            }
+            byteSet.addAll(member);
+        }
+        if (atEnd())
+        {
+            fail("expected ']'");
+        }
+        ++m_position;
+
+        if (negated)
+        {
+            // Fold before inverting so that [^a] excludes both 'a' and 'A'.
+            for (unsigned char c = 'a'; c <= 'z'; ++c)
+            {
+                if (byteSet.contains(c) || byteSet.contains(static_cast<unsigned char>(c - 'a' + 'A')))
+                {
+                    byteSet.add(c);
+                    byteSet.add(static_cast<unsigned char>(c - 'a' + 'A'));
+                }
+            }
+            byteSet.invert();
+        }
+        return byteSet;
+    }
+
+    const std::string &m_expression;
+    size_t m_position;
+    size_t m_end;
+    std::vector<ByteSet> &m_byteSets;
+};
+
+RegexSet::RegexSet() : m_expressionCount(0), m_allExpressionsHaveLiterals(false), m_byteClassCount(0), m_initialDfaState(-1)
+{
+    memset(m_byteClasses, 0, sizeof(m_byteClasses));
+}
+
+size_t RegexSet::add(const std::string &expression)
+{
+    // Parse the expression now so that syntax errors are reported when the
+    // configuration is read. It is parsed again when the set is compiled.
+    std::vector<ByteSet> byteSets;
+    bool anchoredAtStart;
+    bool anchoredAtEnd;
+    Node root = Parser(expression, byteSets).parse(anchoredAtStart, anchoredAtEnd);
+    if (countNfaStates(root) > MAX_NFA_STATES_PER_EXPRESSION)
+    {
+        std::ostringstream msg;
+        msg << "RegexSet::add : regular expression '" << expression << "' is too large";
+        throw TskException(msg.str());
+    }
+
+    m_expressions.push_back(expression);
+    m_requiredLiterals.push_back(findRequiredLiteral(root, byteSets));
+    return m_expressionCount++;
+}
+
+void RegexSet::clear()
+{
+    m_expressionCount = 0;
+    m_expressions.clear();
+    m_anchoredAtStart.clear();
+    m_requiredLiterals.clear();
+    m_allExpressionsHaveLiterals = false;
+    m_byteSets.clear();
+    m_nfaStates.clear();
+    m_anchoredStarts.clear();
+    m_unanchoredStarts.clear();
+    memset(m_byteClasses, 0, sizeof(m_byteClasses));
+    m_byteClassCount = 0;
+    flushDfaCache();
+}
+
+std::string RegexSet::findRequiredLiteral(const Node &node, const std::vector<ByteSet> &byteSets)
+{
+    unsigned char byte;
+    switch (node.type)
+    {
+    case Node::BYTES:
+        if (byteSets[node.bytes].isSingleByte(byte))
+        {
+            return std::string(1, static_cast<char>(byte));
+        }
+        return "";
+    case Node::PLUS:
+        return findRequiredLiteral(node.children[0], byteSets);
+    case Node::CONCATENATE:
+        {
+            // The longest run of consecutive single bytes, or the longest
+            // literal required by a child.
+            std::string longest;
+            std::string run;
+            for (std::vector<Node>::const_iterator child = node.children.begin(); child != node.children.end(); ++child)
+            {
+                if (child->type == Node::BYTES && byteSets[child->bytes].isSingleByte(byte))
+                {
+                    run += static_cast<char>(byte);
+                    continue;
+                }
+                if (run.size() > longest.size())
+                {
+                    longest = run;
+                }
+                run.clear();
+                const std::string childLiteral = findRequiredLiteral(*child, byteSets);
+                if (childLiteral.size() > longest.size())
+                {
+                    longest = childLiteral;
+                }
+            }
+            return run.size() > longest.size() ? run : longest;
+        }
+    default:
+        return "";
+    }
+}
+
+int RegexSet::addNfaState(NfaState::Type type, size_t bytes, int out, int out1)
+{
+    NfaState state;
+    state.type = type;
+    state.bytes = bytes;
+    state.out = out;
+    state.out1 = out1;
+    state.expressionId = 0;
+    state.anchoredAtEnd = false;
+    m_nfaStates.push_back(state);
+    return static_cast<int>(m_nfaStates.size() - 1);
+}
+
+void RegexSet::connect(const std::vector<std::pair<int, int> > &exits, int target)
+{
+    for (std::vector<std::pair<int, int> >::const_iterator exit = exits.begin(); exit != exits.end(); ++exit)
+    {
+        if (exit->second == 0)
+        {
+            m_nfaStates[exit->first].out = target;
+        }
+        else
+        {
+            m_nfaStates[exit->first].out1 = target;
+        }
+    }
+}
+
+RegexSet::Fragment RegexSet::compileNode(const Node &node)
+{
+    Fragment fragment;
+    switch (node.type)
+    {
+    case Node::EMPTY:
+        fragment.start = addNfaState(NfaState::SPLIT, 0, -1, -1);
+        fragment.exits.push_back(std::make_pair(fragment.start, 0));
+        break;
+    case Node::BYTES:
+        fragment.start = addNfaState(NfaState::BYTES, node.bytes, -1, -1);
+        fragment.exits.push_back(std::make_pair(fragment.start, 0));
+        break;
+    case Node::CONCATENATE:
+        fragment = compileNode(node.children[0]);
+        for (size_t i = 1; i < node.children.size(); ++i)
+        {
+            Fragment next = compileNode(node.children[i]);
+            connect(fragment.exits, next.start);
+            fragment.exits = next.exits;
+        }
+        break;
+    case Node::ALTERNATE:
+        fragment = compileNode(node.children.back());
+        for (size_t i = node.children.size() - 1; i-- > 0; )
+        {
+            Fragment alternative = compileNode(node.children[i]);
+            fragment.start = addNfaState(NfaState::SPLIT, 0, alternative.start, fragment.start);
+            fragment.exits.insert(fragment.exits.end(), alternative.exits.begin(), alternative.exits.end());
+        }
+        break;
+    case Node::STAR:
+        {
+            Fragment repeated = compileNode(node.children[0]);
+            fragment.start = addNfaState(NfaState::SPLIT, 0, repeated.start, -1);
+            connect(repeated.exits, fragment.start);
+            fragment.exits.push_back(std::make_pair(fragment.start, 1));
+        }
+        break;
+    case Node::PLUS:
+        {
+            Fragment repeated = compileNode(node.children[0]);
+            const int loop = addNfaState(NfaState::SPLIT, 0, repeated.start, -1);
+            connect(repeated.exits, loop);
+            fragment.start = repeated.start;
+            fragment.exits.push_back(std::make_pair(loop, 1));
+        }
+        break;
+    case Node::OPTIONAL:
+        {
+            Fragment optional = compileNode(node.children[0]);
+            fragment.start = addNfaState(NfaState::SPLIT, 0, optional.start, -1);
+            fragment.exits = optional.exits;
+            fragment.exits.push_back(std::make_pair(fragment.start, 1));
+        }
+        break;
+    }
+    return fragment;
+}
+
+void RegexSet::compile()
+{
+    m_byteSets.clear();
+    m_nfaStates.clear();
+    m_anchoredStarts.clear();
+    m_unanchoredStarts.clear();
+    m_anchoredAtStart.clear();
+    flushDfaCache();
+
+    m_allExpressionsHaveLiterals = m_expressionCount > 0;
+    for (size_t id = 0; id < m_expressionCount; ++id)
+    {
+        bool anchoredAtStart;
+        bool anchoredAtEnd;
+        Node root = Parser(m_expressions[id], m_byteSets).parse(anchoredAtStart, anchoredAtEnd);
+        Fragment fragment = compileNode(root);
+        const int match = addNfaState(NfaState::MATCH, 0, -1, -1);
+        m_nfaStates[match].expressionId = id;
+        m_nfaStates[match].anchoredAtEnd = anchoredAtEnd;
+        connect(fragment.exits, match);
+
+        m_anchoredAtStart.push_back(anchoredAtStart);
+        (anchoredAtStart ? m_anchoredStarts : m_unanchoredStarts).push_back(fragment.start);
+        if (m_requiredLiterals[id].empty())
+        {
+            m_allExpressionsHaveLiterals = false;
+        }
+    }
+
+    // Partition the bytes into classes of bytes that no byte set tells
+    // apart, so that DFA transition tables have one entry per class rather
+    // than one per byte.
+    std::vector<int> classes(256, 0);
+    int classCount = 1;
+    for (std::vector<ByteSet>::const_iterator byteSet = m_byteSets.begin(); byteSet != m_byteSets.end(); ++byteSet)
+    {
+        std::map<std::pair<int, bool>, int> refinedClasses;
+        for (unsigned int byte = 0; byte < 256; ++byte)
+        {
+            const std::pair<int, bool> key(classes[byte], byteSet->contains(static_cast<unsigned char>(byte)));
+            std::map<std::pair<int, bool>, int>::iterator refinedClass = refinedClasses.find(key);
+            if (refinedClass == refinedClasses.end())
+            {
+                refinedClass = refinedClasses.insert(std::make_pair(key, static_cast<int>(refinedClasses.size()))).first;
+            }
+            classes[byte] = refinedClass->second;
+        }
+        classCount = static_cast<int>(refinedClasses.size());
+    }
+    for (unsigned int byte = 0; byte < 256; ++byte)
+    {
+        m_byteClasses[byte] = static_cast<unsigned char>(classes[byte]);
+    }
+    m_byteClassCount = classCount;
+}
+
+void RegexSet::addToClosure(int nfaState, std::vector<bool> &visited, std::vector<int> &closure) const
+{
+    std::vector<int> stack(1, nfaState);
+    while (!stack.empty())
+    {
+        const int state = stack.back();
+        stack.pop_back();
+        if (state < 0 || visited[state])
+        {
+            continue;
+        }
+        visited[state] = true;
+
+        const NfaState &nfaState = m_nfaStates[state];
+        if (nfaState.type == NfaState::SPLIT)
+        {
+            stack.push_back(nfaState.out1);
+            stack.push_back(nfaState.out);
+        }
+        else
+        {
+            closure.push_back(state);
+        }
+    }
+}
+
+void RegexSet::flushDfaCache() const
+{
+    m_dfaStates.clear();
+    m_dfaStateIds.clear();
+    m_initialDfaState = -1;
+}
+
+int RegexSet::getDfaState(std::vector<int> &nfaStates) const
+{
+    std::sort(nfaStates.begin(), nfaStates.end());
+    std::map<std::vector<int>, int>::const_iterator existing = m_dfaStateIds.find(nfaStates);
+    if (existing != m_dfaStateIds.end())
+    {
+        return existing->second;
+    }
+
+    DfaState dfaState;
+    dfaState.nfaStates = nfaStates;
+    dfaState.transitions.assign(m_byteClassCount, -1);
+    for (std::vector<int>::const_iterator state = nfaStates.begin(); state != nfaStates.end(); ++state)
+    {
+        const NfaState &nfaState = m_nfaStates[*state];
+        if (nfaState.type == NfaState::MATCH)
+        {
+            (nfaState.anchoredAtEnd ? dfaState.matchesAtEnd : dfaState.matches).push_back(nfaState.expressionId);
+        }
+    }
+
+    const int id = static_cast<int>(m_dfaStates.size());
+    m_dfaStates.push_back(dfaState);
+    m_dfaStateIds.insert(std::make_pair(nfaStates, id));
+    return id;
+}
+
+int RegexSet::getTransition(int dfaState, unsigned char byte) const
+{
+    const int byteClass = m_byteClasses[byte];
+    const int cached = m_dfaStates[dfaState].transitions[byteClass];
+    if (cached >= 0)
+    {
+        return cached;
+    }
+
+    // Step every NFA state in the DFA state over the byte, then restart the
+    // unanchored expressions so they can begin matching at the next byte.
+    std::vector<bool> visited(m_nfaStates.size(), false);
+    std::vector<int> next;
+    const std::vector<int> &current = m_dfaStates[dfaState].nfaStates;
+    for (std::vector<int>::const_iterator state = current.begin(); state != current.end(); ++state)
+    {
+        const NfaState &nfaState = m_nfaStates[*state];
+        if (nfaState.type == NfaState::BYTES && m_byteSets[nfaState.bytes].contains(byte))
+        {
+            addToClosure(nfaState.out, visited, next);
+        }
+    }
+    for (std::vector<int>::const_iterator start = m_unanchoredStarts.begin(); start != m_unanchoredStarts.end(); ++start)
+    {
+        addToClosure(*start, visited, next);
+    }
+
+    if (m_dfaStates.size() >= MAX_DFA_STATES)
+    {
+        // The cache is full. Start over; the states needed by the strings
+        // being matched are quickly rebuilt.
+        std::vector<int> currentNfaStates(current);
+        flushDfaCache();
+        dfaState = getDfaState(currentNfaStates);
+    }
+
+    const int nextDfaState = getDfaState(next);
+    m_dfaStates[dfaState].transitions[byteClass] = nextDfaState;
+    return nextDfaState;
+}
+
+bool RegexSet::match(const std::string &text, std::vector<bool> &matches) const
+{
+    matches.assign(m_expressionCount, false);
+    if (m_expressionCount == 0)
+    {
+        return false;
+    }
+
+    // Skip the automaton if the string cannot match any expression.
+    if (m_allExpressionsHaveLiterals)
+    {
+        bool hasCandidate = false;
+        for (std::vector<std::string>::const_iterator literal = m_requiredLiterals.begin(); literal != m_requiredLiterals.end() && !hasCandidate; ++literal)
+        {
+            hasCandidate = containsLiteral(text.data(), text.size(), *literal);
+        }
+        if (!hasCandidate)
+        {
+            return false;
+        }
+    }
+
+    if (m_initialDfaState < 0)
+    {
+        std::vector<bool> visited(m_nfaStates.size(), false);
+        std::vector<int> initial;
+        for (std::vector<int>::const_iterator start = m_anchoredStarts.begin(); start != m_anchoredStarts.end(); ++start)
+        {
+            addToClosure(*start, visited, initial);
+        }
+        for (std::vector<int>::const_iterator start = m_unanchoredStarts.begin(); start != m_unanchoredStarts.end(); ++start)
+        {
+            addToClosure(*start, visited, initial);
+        }
+        m_initialDfaState = getDfaState(initial);
+    }
+
+    size_t matchCount = 0;
+    int state = m_initialDfaState;
+    for (size_t i = 0; ; ++i)
+    {
+        const std::vector<size_t> &stateMatches = m_dfaStates[state].matches;
+        for (std::vector<size_t>::const_iterator id = stateMatches.begin(); id != stateMatches.end(); ++id)
+        {
+            if (!matches[*id])
+            {
+                matches[*id] = true;
+                ++matchCount;
+            }
+        }
+
+        if (i == text.size() || matchCount == m_expressionCount || m_dfaStates[state].nfaStates.empty())
+        {
+            break;
+        }
+        state = getTransition(state, static_cast<unsigned char>(text[i]));
+    }
+
+    if (m_dfaStates[state].nfaStates.size() > 0 && matchCount < m_expressionCount)
+    {
+        const std::vector<size_t> &stateMatches = m_dfaStates[state].matchesAtEnd;
+        for (std::vector<size_t>::const_iterator id = stateMatches.begin(); id != stateMatches.end(); ++id)
+        {
+            if (!matches[*id])
+            {
+                matches[*id] = true;
+                ++matchCount;
+            }
+        }
+    }
+
+    return matchCount != 0;
+}
+
+bool RegexSet::containsLiteral(const char *text, size_t textLength, const std::string &literal)
+{
+    const size_t literalLength = literal.size();
+    if (literalLength == 0 || literalLength > textLength)
+    {
+        return literalLength == 0;
+    }
+
+    const size_t lastStart = textLength - literalLength;
+    size_t position = 0;
+
+#ifdef REGEX_SET_USE_SSE2
+    // Compare the first and last bytes of the literal against 16 candidate
+    // positions at a time and only verify the positions where both match.
+    const __m128i firstByte = _mm_set1_epi8(literal[0]);
+    const __m128i lastByte = _mm_set1_epi8(literal[literalLength - 1]);
+    for (; position + 16 <= lastStart + 1; position += 16)
+    {
+        const __m128i firstBlock = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + position));
+        const __m128i lastBlock = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + position + literalLength - 1));
+        unsigned int candidates = static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(firstBlock, firstByte), _mm_cmpeq_epi8(lastBlock, lastByte))));
+        for (size_t offset = 0; candidates != 0; ++offset, candidates >>= 1)
+        {
+            if ((candidates & 1) && (literalLength <= 2 || memcmp(text + position + offset + 1, literal.data() + 1, literalLength - 2) == 0))
+            {
+                return true;
+            }
+        }
+    }
+#endif
+
+    for (; position <= lastStart; ++position)
+    {
+        const void *candidate = memchr(text + position, literal[0], lastStart - position + 1);
+        if (candidate == NULL)
+        {
+            return false;
+        }
+        position = static_cast<const char *>(candidate) - text;
+        if (memcmp(text + position, literal.data(), literalLength) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,187 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file RegexSet.h
+ * Contains the interface of a multi-pattern regular expression matcher that
+ * runs in time linear in the length of its input.
+ */
+
+#ifndef _REGEX_SET_H
+#define _REGEX_SET_H
+
+// System includes
+#include <string>
+#include <vector>
+#include <map>
+
+/**
+ * A regex set compiles any number of regular expressions into a single
+ * automaton that reports which of the expressions match a string in one
+ * pass over the string. Matching is case insensitive (ASCII) and callers must
+ * pass strings already folded to upper case.
+ *
+ * The automaton is a Thompson NFA that is converted to a DFA lazily, one
+ * state at a time, as strings are matched. The DFA state cache is bounded;
+ * when it fills up it is flushed. There is no backtracking, so matching time
+ * is linear in the length of the string no matter what the expressions or
+ * the string are.
+ *
+ * Expressions are searched for anywhere in a string unless anchored with '^'
+ * and/or '$'. The supported syntax is literals, '.', character classes with
+ * ranges and negation, the escapes \\d \\D \\w \\W \\s \\S and \\xHH, grouping,
+ * alternation, and the '*', '+', '?' and {m,n} quantifiers. Anchors may only
+ * appear at the start ('^') or end ('$') of an expression.
+ *
+ * Before running the automaton, a string is checked for the literal
+ * substrings that the expressions require (e.g. "PASSWORD" for
+ * "^.*password[0-9]+$"), using a SIMD search where available. If every
+ * expression has a required literal and none of them are present, the
+ * automaton is not run at all.
+ */
+class RegexSet
+{
+public:
+    RegexSet();
+
+    /**
+     * Adds an expression to the set. The set must be compiled after all of
+     * the expressions are added.
+     *
+     * @param expression The regular expression.
+     * @return The id of the expression, used to report matches.
+     * @throws TskException If the expression is invalid or too large.
+     */
+    size_t add(const std::string &expression);
+
+    /**
+     * Builds the automaton for the expressions added to the set.
+     */
+    void compile();
+
+    /**
+     * Removes all of the expressions from the set.
+     */
+    void clear();
+
+    size_t size() const { return m_expressionCount; }
+
+    /**
+     * Finds the expressions that match a string.
+     *
+     * @param text The string to match, folded to upper case.
+     * @param matches Resized to size() and set to true for each expression
+     * that matches the string.
+     * @return True if any expression matches the string.
+     */
+    bool match(const std::string &text, std::vector<bool> &matches) const;
+
+    /**
+     * Searches a string for a literal substring. Exposed so that other
+     * matchers can share the SIMD substring search.
+     *
+     * @param text The string to search.
+     * @param textLength The length of the string.
+     * @param literal The substring to search for, must not be empty.
+     * @return True if the substring occurs in the string.
+     */
+    static bool containsLiteral(const char *text, size_t textLength, const std::string &literal);
+
+    /**
+     * Gets the literal substring that every match of an expression contains.
+     *
+     * @param expressionId The id of an expression.
+     * @return The required literal, folded to upper case, or the empty string
+     * if the expression has no required literal.
+     */
+    const std::string &requiredLiteral(size_t expressionId) const { return m_requiredLiterals[expressionId]; }
+
+private:
+    /** A set of bytes, stored as a 256 bit bitmap. */
+    struct ByteSet
+    {
+        ByteSet();
+        void add(unsigned char byte);
+        void addRange(unsigned char first, unsigned char last);
+        void addAll(const ByteSet &other);
+        void invert();
+        bool contains(unsigned char byte) const;
+        bool isSingleByte(unsigned char &byte) const;
+        unsigned int bits[8];
+    };
+
+    /** A node of an expression's syntax tree. */
+    struct Node
+    {
+        enum Type { EMPTY, BYTES, CONCATENATE, ALTERNATE, STAR, PLUS, OPTIONAL };
+        explicit Node(Type type = EMPTY) : type(type), bytes(0) {}
+        Type type;
+        size_t bytes;
+        std::vector<Node> children;
+    };
+
+    /** An NFA state. Byte states consume one byte of a byte set. */
+    struct NfaState
+    {
+        enum Type { BYTES, SPLIT, MATCH };
+        Type type;
+        size_t bytes;
+        int out;
+        int out1;
+        size_t expressionId;
+        bool anchoredAtEnd;
+    };
+
+    /** A partially built NFA fragment with a list of unconnected exits. */
+    struct Fragment
+    {
+        int start;
+        std::vector<std::pair<int, int> > exits;
+    };
+
+    /** A lazily built DFA state, a set of NFA states. */
+    struct DfaState
+    {
+        std::vector<int> nfaStates;
+        std::vector<int> transitions;
+        std::vector<size_t> matches;
+        std::vector<size_t> matchesAtEnd;
+    };
+
+    class Parser;
+
+    Fragment compileNode(const Node &node);
+    int addNfaState(NfaState::Type type, size_t bytes, int out, int out1);
+    void connect(const std::vector<std::pair<int, int> > &exits, int target);
+    void addToClosure(int nfaState, std::vector<bool> &visited, std::vector<int> &closure) const;
+    int getDfaState(std::vector<int> &nfaStates) const;
+    int getTransition(int dfaState, unsigned char byte) const;
+    void flushDfaCache() const;
+    static std::string findRequiredLiteral(const Node &node, const std::vector<ByteSet> &byteSets);
+
+    size_t m_expressionCount;
+    std::vector<std::string> m_expressions;
+    std::vector<bool> m_anchoredAtStart;
+    std::vector<std::string> m_requiredLiterals;
+    bool m_allExpressionsHaveLiterals;
+
+    std::vector<ByteSet> m_byteSets;
+    std::vector<NfaState> m_nfaStates;
+    std::vector<int> m_anchoredStarts;
+    std::vector<int> m_unanchoredStarts;
+    unsigned char m_byteClasses[256];
+    int m_byteClassCount;
+
+    // The DFA is built while matching, so it is mutable.
+    mutable std::vector<DfaState> m_dfaStates;
+    mutable std::map<std::vector<int>, int> m_dfaStateIds;
+    mutable int m_initialDfaState;
+};
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file ResultCache.cpp
+ * Contains the implementation of a cache of the hits of interesting files 
+ * sets kept in an SQLite image database.
+ */
+
+#include "ResultCache.h"
+
+// TSK Framework includes, including the SQLite API used by the SQLite image database.
+#include "TskModuleDev.h"
+#include "framework.h"
+
+// System includes
+#include <sstream>
+#include <iomanip>
+
+namespace
+{
+    const char *CREATE_TABLES_STATEMENT = "CREATE TABLE IF NOT EXISTS ifm_result_cache "
+        "(file_set_key TEXT, condition_index INTEGER, fingerprint TEXT, file_ids BLOB, PRIMARY KEY (file_set_key, condition_index)); "
+        "CREATE TABLE IF NOT EXISTS ifm_result_cache_posted (file_set_key TEXT PRIMARY KEY, fingerprint TEXT)";
+    const char *FILES_FINGERPRINT_QUERY = "SELECT COUNT(*), IFNULL(MAX(file_id), 0), TOTAL(size), TOTAL(ctime), TOTAL(mtime) FROM files";
+    const char *FILE_HASHES_FINGERPRINT_QUERY = "SELECT COUNT(*), COUNT(md5), COUNT(sha1), COUNT(sha2_256) FROM file_hashes";
+    const char *DELETE_STALE_STATEMENT = "DELETE FROM ifm_result_cache WHERE fingerprint <> ?";
+    const char *DELETE_STALE_POSTED_STATEMENT = "DELETE FROM ifm_result_cache_posted WHERE fingerprint <> ?";
+    const char *SELECT_STATEMENT = "SELECT condition_index, file_ids FROM ifm_result_cache WHERE file_set_key = ? AND fingerprint = ?";
+    const char *DELETE_STATEMENT = "DELETE FROM ifm_result_cache WHERE file_set_key = ?";
+    const char *DELETE_POSTED_STATEMENT = "DELETE FROM ifm_result_cache_posted WHERE file_set_key = ?";
+    const char *INSERT_STATEMENT = "INSERT INTO ifm_result_cache (file_set_key, condition_index, fingerprint, file_ids) VALUES (?, ?, ?, ?)";
+    const char *POSTED_QUERY = "SELECT COUNT(*) FROM ifm_result_cache_posted WHERE file_set_key = ? AND fingerprint = ?";
+    const char *INSERT_POSTED_STATEMENT = "INSERT OR REPLACE INTO ifm_result_cache_posted (file_set_key, fingerprint) VALUES (?, ?)";
+
+    void bindText(SqliteStatement &statement, int parameter, const std::string &text)
+    {
+        sqlite3_bind_text(statement.get(), parameter, text.c_str(), static_cast<int>(text.size()), SQLITE_TRANSIENT);
+    }
+
+    /**
+     * Appends the columns of the first row of a query to a fingerprint.
+     */
+    void appendQueryRow(const SqliteConnection &connection, const char *query, std::ostringstream &fingerprint)
+    {
+        SqliteStatement statement(connection, query);
+        if (statement.step())
+        {
+            for (int i = 0; i < sqlite3_column_count(statement.get()); ++i)
+            {
+                const unsigned char *value = sqlite3_column_text(statement.get(), i);
+                fingerprint << (value != NULL ? reinterpret_cast<const char *>(value) : "") << "/";
+            }
+        }
+    }
+
+    void encodeFileIds(const FileIdSet &fileIds, std::string &bytes)
+    {
+        bytes.clear();
+        uint64_t lastFileId = 0;
+        for (FileIdSet::Iterator fileId(fileIds); !fileId.atEnd(); fileId.next())
+        {
+            uint64_t difference = fileId.get() - lastFileId;
+            lastFileId = fileId.get();
+            while (difference >= 0x80)
+            {
+                bytes.push_back(static_cast<char>((difference & 0x7F) | 0x80));
+                difference >>= 7;
+            }
+            bytes.push_back(static_cast<char>(difference));
+        }
+    }
+
+    bool decodeFileIds(const unsigned char *bytes, size_t length, FileIdSet &fileIds)
+    {
+        fileIds.clear();
+        uint64_t fileId = 0;
+        uint64_t difference = 0;
+        unsigned int shift = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            if (shift >= 64)
+            {
+                return false;
+            }
+            difference |= static_cast<uint64_t>(bytes[i] & 0x7F) << shift;
+            shift += 7;
+            if ((bytes[i] & 0x80) == 0)
+            {
+                fileId += difference;
+                fileIds.add(fileId);
+                difference = 0;
+                shift = 0;
+            }
+        }
+        return shift == 0;
+    }
+}
+
+ResultCache::ResultCache(const std::string &imageDatabasePath) : m_connection(imageDatabasePath, false)
+{
+    m_connection.execute(CREATE_TABLES_STATEMENT);
+
+    std::ostringstream fingerprint;
+    appendQueryRow(m_connection, FILES_FINGERPRINT_QUERY, fingerprint);
+    appendQueryRow(m_connection, FILE_HASHES_FINGERPRINT_QUERY, fingerprint);
+    m_fingerprint = fingerprint.str();
+
+    SqliteStatement deleteStaleStatement(m_connection, DELETE_STALE_STATEMENT);
+    bindText(deleteStaleStatement, 1, m_fingerprint);
+    deleteStaleStatement.execute();
+
+    SqliteStatement deleteStalePostedStatement(m_connection, DELETE_STALE_POSTED_STATEMENT);
+    bindText(deleteStalePostedStatement, 1, m_fingerprint);
+    deleteStalePostedStatement.execute();
+}
+
+std::string ResultCache::getKey(const std::string &definition)
+{
+    // A 64 bit FNV-1a hash, which is not cryptographic but suffices to tell the sets of a configuration apart.
+    uint64_t hash = 14695981039346656037ULL;
+    for (std::string::const_iterator c = definition.begin(); c != definition.end(); ++c)
+    {
+        hash ^= static_cast<unsigned char>(*c);
+        hash *= 1099511628211ULL;
+    }
+
+    std::ostringstream key;
+    key << std::hex << std::setw(16) << std::setfill('0') << hash << "-" << definition.size();
+    return key.str();
+}
+
+bool ResultCache::find(const std::string &key, size_t conditionCount, std::vector<FileIdSet> &postedHits)
+{
+    postedHits.assign(conditionCount, FileIdSet());
+
+    SqliteStatement selectStatement(m_connection, SELECT_STATEMENT);
+    bindText(selectStatement, 1, key);
+    bindText(selectStatement, 2, m_fingerprint);
+    size_t rowCount = 0;
+    while (selectStatement.step())
+    {
+        const int64_t conditionIndex = sqlite3_column_int64(selectStatement.get(), 0);
+        const unsigned char *bytes = static_cast<const unsigned char *>(sqlite3_column_blob(selectStatement.get(), 1));
+        const size_t length = static_cast<size_t>(sqlite3_column_bytes(selectStatement.get(), 1));
+        if (conditionIndex < 0 || static_cast<uint64_t>(conditionIndex) >= conditionCount || 
+            !decodeFileIds(bytes, length, postedHits[static_cast<size_t>(conditionIndex)]))
+        {
+            return false;
+        }
+        ++rowCount;
+    }
+    return rowCount == conditionCount;
+}
+
+void ResultCache::store(const std::string &key, const std::vector<FileIdSet> &postedHits)
+{
+    m_connection.execute("BEGIN IMMEDIATE");
+    try
+    {
+        SqliteStatement deleteStatement(m_connection, DELETE_STATEMENT);
+        bindText(deleteStatement, 1, key);
+        deleteStatement.execute();
+
+        // The hits replacing the cached ones have not been posted yet.
+        SqliteStatement deletePostedStatement(m_connection, DELETE_POSTED_STATEMENT);
+        bindText(deletePostedStatement, 1, key);
+        deletePostedStatement.execute();
+
+        SqliteStatement insertStatement(m_connection, INSERT_STATEMENT);
+        std::string bytes;
+        for (size_t i = 0; i < postedHits.size(); ++i)
+        {
+            encodeFileIds(postedHits[i], bytes);
+            bindText(insertStatement, 1, key);
+            sqlite3_bind_int64(insertStatement.get(), 2, i);
+            bindText(insertStatement, 3, m_fingerprint);
+            sqlite3_bind_blob(insertStatement.get(), 4, bytes.data(), static_cast<int>(bytes.size()), SQLITE_TRANSIENT);
+            insertStatement.execute();
+        }
+
+        m_connection.execute("COMMIT");
+    }
+    catch (...)
+    {
+        sqlite3_exec(m_connection.get(), "ROLLBACK", NULL, NULL, NULL);
+        throw;
+    }
+}
+
+bool ResultCache::isPosted(const std::string &key)
+{
+    SqliteStatement postedQuery(m_connection, POSTED_QUERY);
+    bindText(postedQuery, 1, key);
+    bindText(postedQuery, 2, m_fingerprint);
+    return postedQuery.queryInteger() != 0;
+}
+
+void ResultCache::setPosted(const std::string &key)
+{
+    SqliteStatement insertPostedStatement(m_connection, INSERT_POSTED_STATEMENT);
+    bindText(insertPostedStatement, 1, key);
+    bindText(insertPostedStatement, 2, m_fingerprint);
+    insertPostedStatement.execute();
+}
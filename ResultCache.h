@@ -0,0 +1,116 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file ResultCache.h
+ * Contains the interface of a cache of the hits of interesting files sets
+ * kept in an SQLite image database.
+ */
+
+#ifndef _RESULT_CACHE_H
+#define _RESULT_CACHE_H
+
+#include "SqliteDatabase.h"
+#include "FileIdSet.h"
+
+// System includes
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * A result cache keeps the posted hits of each condition of each 
+ * interesting files set in a table of an SQLite image database, so that a
+ * search of an unchanged image with an unchanged set can replay the hits 
+ * rather than search for them again. 
+ *
+ * Hits are keyed by a hash of the compiled set, which covers its 
+ * definition and the data, such as hash lists, that its conditions depend
+ * on, and are only valid for the fingerprint of the image database they 
+ * were found in. The fingerprint summarizes the files and file hashes 
+ * tables: their row counts, the last file id and totals of the columns 
+ * that change when files are added or their hashes are computed. Hits of 
+ * other fingerprints are removed when the cache is opened. The file ids of
+ * each condition are stored as variable length differences between 
+ * successive ids.
+ *
+ * The cache also records which cached hits have been posted to the 
+ * blackboard for the fingerprint, so that they are not posted again.
+ */
+class ResultCache
+{
+public:
+    /**
+     * Opens a connection to an SQLite image database, creates the cache 
+     * table if it does not exist, and works out the fingerprint of the 
+     * image database.
+     *
+     * @param imageDatabasePath The path of the SQLite image database.
+     * @throws TskException If the database cannot be opened or the cache
+     * table cannot be created.
+     */
+    explicit ResultCache(const std::string &imageDatabasePath);
+
+    /**
+     * Gets the key of a compiled interesting files set.
+     *
+     * @param definition A description of the compiled set.
+     */
+    static std::string getKey(const std::string &definition);
+
+    const std::string &getFingerprint() const { return m_fingerprint; }
+
+    /**
+     * Finds the cached hits of an interesting files set.
+     *
+     * @param key The key of the set.
+     * @param conditionCount The number of conditions of the set.
+     * @param postedHits Receives the posted hits of each of the set's 
+     * conditions.
+     * @return False if the set's hits are not cached for the fingerprint of
+     * the image database.
+     * @throws TskException If the cache cannot be read.
+     */
+    bool find(const std::string &key, size_t conditionCount, std::vector<FileIdSet> &postedHits);
+
+    /**
+     * Caches the hits of an interesting files set, replacing any cached 
+     * before. The new hits are not yet posted.
+     *
+     * @throws TskException If the hits cannot be cached.
+     */
+    void store(const std::string &key, const std::vector<FileIdSet> &postedHits);
+
+    /**
+     * Finds whether the cached hits of an interesting files set have been 
+     * posted to the blackboard for the fingerprint of the image database.
+     *
+     * @param key The key of the set.
+     * @throws TskException If the cache cannot be read.
+     */
+    bool isPosted(const std::string &key);
+
+    /**
+     * Records that the cached hits of an interesting files set have been 
+     * posted to the blackboard.
+     *
+     * @param key The key of the set.
+     * @throws TskException If the record cannot be written.
+     */
+    void setPosted(const std::string &key);
+
+private:
+    ResultCache(const ResultCache &);
+    ResultCache &operator=(const ResultCache &);
+
+    SqliteConnection m_connection;
+    std::string m_fingerprint;
+};
+
+#endif
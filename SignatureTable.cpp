@@ -0,0 +1,99 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file SignatureTable.cpp
+ * Contains the implementation of a table of file content signatures.
+ */
+
+#include "SignatureTable.h"
+
+// System includes
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+
+SignatureTable::SignatureTable() : m_headerLength(0)
+{
+}
+
+size_t SignatureTable::add(const std::vector<unsigned char> &signature, size_t offset)
+{
+    Signature entry;
+    entry.bytes = signature;
+    entry.offset = offset;
+    m_signatures.push_back(entry);
+    const size_t id = m_signatures.size() - 1;
+
+    std::vector<std::vector<size_t> > &signaturesByFirstByte = m_signaturesByOffset[offset];
+    if (signaturesByFirstByte.empty())
+    {
+        signaturesByFirstByte.resize(256);
+    }
+    signaturesByFirstByte[signature[0]].push_back(id);
+
+    if (offset + signature.size() > m_headerLength)
+    {
+        m_headerLength = offset + signature.size();
+    }
+
+    return id;
+}
+
+void SignatureTable::clear()
+{
+    m_signatures.clear();
+    m_signaturesByOffset.clear();
+    m_headerLength = 0;
+}
+
+bool SignatureTable::match(const unsigned char *header, size_t headerLength, std::vector<bool> &matches) const
+{
+    matches.assign(m_signatures.size(), false);
+
+    bool matched = false;
+    for (std::map<size_t, std::vector<std::vector<size_t> > >::const_iterator offset = m_signaturesByOffset.begin(); offset != m_signaturesByOffset.end(); ++offset)
+    {
+        if (offset->first >= headerLength)
+        {
+            // The offsets are sorted, so no remaining signature fits in the header.
+            break;
+        }
+
+        const std::vector<size_t> &candidates = offset->second[header[offset->first]];
+        for (std::vector<size_t>::const_iterator id = candidates.begin(); id != candidates.end(); ++id)
+        {
+            const Signature &signature = m_signatures[*id];
+            if (signature.offset + signature.bytes.size() <= headerLength &&
+                memcmp(header + signature.offset, &signature.bytes[0], signature.bytes.size()) == 0)
+            {
+                matches[*id] = true;
+                matched = true;
+            }
+        }
+    }
+
+    return matched;
+}
+
+std::string SignatureTable::describe() const
+{
+    std::ostringstream description;
+    description << std::hex << std::setfill('0');
+    for (std::vector<Signature>::const_iterator signature = m_signatures.begin(); signature != m_signatures.end(); ++signature)
+    {
+        description << signature->offset << ":";
+        for (std::vector<unsigned char>::const_iterator byte = signature->bytes.begin(); byte != signature->bytes.end(); ++byte)
+        {
+            description << std::setw(2) << static_cast<unsigned int>(*byte);
+        }
+        description << ";";
+    }
+    return description.str();
+}
@@ -0,0 +1,93 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file SignatureTable.h
+ * Contains the interface of a table of file content signatures (magic
+ * bytes) that are matched against file headers.
+ */
+
+#ifndef _SIGNATURE_TABLE_H
+#define _SIGNATURE_TABLE_H
+
+// System includes
+#include <string>
+#include <vector>
+#include <map>
+#include <stddef.h>
+
+/**
+ * A signature table holds any number of signatures, each a sequence of
+ * bytes expected at a fixed offset from the start of a file. A file header
+ * is matched against all of the signatures at once: the signatures are
+ * indexed by offset and by first byte, so a header is only compared with the
+ * signatures whose first byte appears at the signature's offset.
+ */
+class SignatureTable
+{
+public:
+    SignatureTable();
+
+    /**
+     * Adds a signature to the table.
+     *
+     * @param signature The signature bytes, must not be empty.
+     * @param offset The offset of the signature from the start of a file.
+     * @return The id of the signature, used to report matches.
+     */
+    size_t add(const std::vector<unsigned char> &signature, size_t offset);
+
+    /**
+     * Removes all of the signatures from the table.
+     */
+    void clear();
+
+    size_t size() const { return m_signatures.size(); }
+
+    /**
+     * Gets the number of bytes from the start of a file needed to match all
+     * of the signatures in the table.
+     */
+    size_t getHeaderLength() const { return m_headerLength; }
+
+    /**
+     * Finds the signatures that match a file header.
+     *
+     * @param header The first bytes of a file.
+     * @param headerLength The number of bytes in the header, which may be 
+     * less than getHeaderLength() for small files.
+     * @param matches Resized to size() and set to true for each signature
+     * that matches the header.
+     * @return True if any signature matches the header.
+     */
+    bool match(const unsigned char *header, size_t headerLength, std::vector<bool> &matches) const;
+
+    /**
+     * Describes the signatures of the table in the order of their ids, so 
+     * that the results of matching headers against the table can be kept 
+     * and reused with a table of the same signatures.
+     */
+    std::string describe() const;
+
+private:
+    struct Signature
+    {
+        std::vector<unsigned char> bytes;
+        size_t offset;
+    };
+
+    std::vector<Signature> m_signatures;
+
+    /** For each distinct offset, the ids of the signatures at that offset indexed by first byte. */
+    std::map<size_t, std::vector<std::vector<size_t> > > m_signaturesByOffset;
+
+    size_t m_headerLength;
+};
+
+#endif
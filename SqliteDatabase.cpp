@@ -0,0 +1,100 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file SqliteDatabase.cpp
+ * Contains the implementation of the connections and statements the module
+ * uses to work with an SQLite image database directly, beside the 
+ * framework's own connection.
+ */
+
+#include "SqliteDatabase.h"
+
+// TSK Framework includes, including the SQLite API used by the SQLite image database.
+#include "TskModuleDev.h"
+#include "framework.h"
+
+// System includes
+#include <sstream>
+
+namespace
+{
+    // How long to wait for the framework's own connection to release the image database.
+    const int BUSY_TIMEOUT_MILLISECONDS = 30000;
+}
+
+SqliteConnection::SqliteConnection(const std::string &path, bool readOnly, bool create) : m_database(NULL)
+{
+    const int flags = readOnly ? SQLITE_OPEN_READONLY : create ? SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE : SQLITE_OPEN_READWRITE;
+    if (sqlite3_open_v2(path.c_str(), &m_database, flags, NULL) != SQLITE_OK)
+    {
+        std::ostringstream msg;
+        msg << "SqliteConnection::SqliteConnection : failed to open " << path << ": " << sqlite3_errmsg(m_database);
+        sqlite3_close(m_database);
+        throw TskException(msg.str());
+    }
+    sqlite3_busy_timeout(m_database, BUSY_TIMEOUT_MILLISECONDS);
+}
+
+SqliteConnection::~SqliteConnection()
+{
+    sqlite3_close(m_database);
+}
+
+void SqliteConnection::execute(const std::string &sql)
+{
+    if (sqlite3_exec(m_database, sql.c_str(), NULL, NULL, NULL) != SQLITE_OK)
+    {
+        throwError(sql);
+    }
+}
+
+void SqliteConnection::throwError(const std::string &sql) const
+{
+    std::ostringstream msg;
+    msg << "SqliteConnection : failed to execute " << sql << ": " << sqlite3_errmsg(m_database);
+    throw TskException(msg.str());
+}
+
+SqliteStatement::SqliteStatement(const SqliteConnection &connection, const std::string &sql) : 
+    m_connection(connection), m_sql(sql), m_statement(NULL)
+{
+    if (sqlite3_prepare_v2(connection.get(), sql.c_str(), -1, &m_statement, NULL) != SQLITE_OK)
+    {
+        connection.throwError(sql);
+    }
+}
+
+SqliteStatement::~SqliteStatement()
+{
+    sqlite3_finalize(m_statement);
+}
+
+bool SqliteStatement::step()
+{
+    const int result = sqlite3_step(m_statement);
+    if (result != SQLITE_ROW && result != SQLITE_DONE)
+    {
+        m_connection.throwError(m_sql);
+    }
+    return result == SQLITE_ROW;
+}
+
+void SqliteStatement::execute()
+{
+    step();
+    sqlite3_reset(m_statement);
+}
+
+int64_t SqliteStatement::queryInteger()
+{
+    const int64_t value = step() ? sqlite3_column_int64(m_statement, 0) : 0;
+    sqlite3_reset(m_statement);
+    return value;
+}
@@ -0,0 +1,119 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file SqliteDatabase.h
+ * Contains the interface of the connections and statements the module uses
+ * to work with an SQLite image database directly, beside the framework's own
+ * connection.
+ */
+
+#ifndef _SQLITE_DATABASE_H
+#define _SQLITE_DATABASE_H
+
+// System includes
+#include <string>
+#include <stdint.h>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+/**
+ * An open connection to an SQLite database, closed when it goes out of
+ * scope. The connection waits for the framework's own connection to release
+ * the database rather than failing when the database is locked.
+ */
+class SqliteConnection
+{
+public:
+    /**
+     * Opens a connection to a database.
+     *
+     * @param path The path of the database.
+     * @param readOnly Whether the connection only reads the database.
+     * @param create Whether to create the database if it does not exist, 
+     * rather than fail.
+     * @throws TskException If the database cannot be opened.
+     */
+    SqliteConnection(const std::string &path, bool readOnly, bool create = false);
+    ~SqliteConnection();
+
+    sqlite3 *get() const { return m_database; }
+
+    /**
+     * Runs SQL statements that return no rows.
+     *
+     * @throws TskException If a statement fails.
+     */
+    void execute(const std::string &sql);
+
+    /**
+     * Throws an exception describing the last error of the connection.
+     *
+     * @param sql The statement that failed.
+     */
+    void throwError(const std::string &sql) const;
+
+private:
+    SqliteConnection(const SqliteConnection &);
+    SqliteConnection &operator=(const SqliteConnection &);
+
+    sqlite3 *m_database;
+};
+
+/**
+ * A prepared SQLite statement, finalized when it goes out of scope.
+ */
+class SqliteStatement
+{
+public:
+    /**
+     * Prepares a statement.
+     *
+     * @throws TskException If the statement cannot be prepared.
+     */
+    SqliteStatement(const SqliteConnection &connection, const std::string &sql);
+    ~SqliteStatement();
+
+    sqlite3_stmt *get() const { return m_statement; }
+
+    /**
+     * Steps the statement to its next row.
+     *
+     * @return True if the statement returned a row, false if it is done.
+     * @throws TskException If the statement fails.
+     */
+    bool step();
+
+    /**
+     * Runs a statement that returns no rows and resets it so that it can be
+     * run again.
+     *
+     * @throws TskException If the statement fails.
+     */
+    void execute();
+
+    /**
+     * Runs a query and gets the integer in the first column of its first row.
+     *
+     * @return The integer, or 0 if the query returns no rows.
+     * @throws TskException If the query fails.
+     */
+    int64_t queryInteger();
+
+private:
+    SqliteStatement(const SqliteStatement &);
+    SqliteStatement &operator=(const SqliteStatement &);
+
+    const SqliteConnection &m_connection;
+    std::string m_sql;
+    sqlite3_stmt *m_statement;
+};
+
+#endif
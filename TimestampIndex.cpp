@@ -0,0 +1,89 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file TimestampIndex.cpp
+ * Contains the implementation of an in-memory index of a timestamp of the 
+ * files of an image.
+ */
+
+#include "TimestampIndex.h"
+
+// System includes
+#include <algorithm>
+
+TimestampIndex::TimestampIndex()
+{
+}
+
+void TimestampIndex::add(uint64_t fileId, int64_t timestamp)
+{
+    if (timestamp != 0)
+    {
+        m_byFileId.push_back(Entry(fileId, timestamp));
+    }
+}
+
+void TimestampIndex::build()
+{
+    // Files added in file id order are already sorted.
+    bool isSorted = true;
+    for (size_t i = 1; i < m_byFileId.size() && isSorted; ++i)
+    {
+        isSorted = m_byFileId[i - 1].fileId < m_byFileId[i].fileId;
+    }
+    if (!isSorted)
+    {
+        std::sort(m_byFileId.begin(), m_byFileId.end(), isOrderedByFileId);
+    }
+
+    m_byTimestamp = m_byFileId;
+    std::sort(m_byTimestamp.begin(), m_byTimestamp.end(), isOrderedByTimestamp);
+}
+
+void TimestampIndex::clear()
+{
+    m_byFileId.clear();
+    m_byTimestamp.clear();
+}
+
+void TimestampIndex::findNear(const FileIdSet &anchorFiles, int64_t seconds, FileIdSet &files) const
+{
+    files.clear();
+
+    // The anchors are visited in file id order, so each lookup starts where the last one ended.
+    std::vector<int64_t> anchorTimestamps;
+    std::vector<Entry>::const_iterator position = m_byFileId.begin();
+    for (FileIdSet::Iterator anchor(anchorFiles); !anchor.atEnd() && position != m_byFileId.end(); anchor.next())
+    {
+        position = std::lower_bound(position, m_byFileId.end(), anchor.get(), hasLowerFileId);
+        if (position != m_byFileId.end() && position->fileId == anchor.get())
+        {
+            anchorTimestamps.push_back(position->timestamp);
+        }
+    }
+    std::sort(anchorTimestamps.begin(), anchorTimestamps.end());
+
+    // The windows of the sorted anchors only move forward, so no file is visited twice, and a window that starts
+    // inside the last one continues from where the last one ended.
+    std::vector<Entry>::const_iterator file = m_byTimestamp.begin();
+    for (std::vector<int64_t>::const_iterator anchorTimestamp = anchorTimestamps.begin(); anchorTimestamp != anchorTimestamps.end(); ++anchorTimestamp)
+    {
+        file = std::lower_bound(file, m_byTimestamp.end(), *anchorTimestamp - seconds, hasLowerTimestamp);
+        for (; file != m_byTimestamp.end() && file->timestamp <= *anchorTimestamp + seconds; ++file)
+        {
+            files.add(file->fileId);
+        }
+    }
+}
+
+uint64_t TimestampIndex::getBytes() const
+{
+    return (m_byFileId.capacity() + m_byTimestamp.capacity()) * sizeof(Entry);
+}
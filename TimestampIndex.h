@@ -0,0 +1,95 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file TimestampIndex.h
+ * Contains the interface of an in-memory index of a timestamp of the files
+ * of an image.
+ */
+
+#ifndef _TIMESTAMP_INDEX_H
+#define _TIMESTAMP_INDEX_H
+
+#include "FileIdSet.h"
+
+// System includes
+#include <vector>
+#include <stdint.h>
+
+/**
+ * A timestamp index holds one timestamp, such as the creation time, of
+ * every file in an image, both in file id order and in timestamp order, so
+ * that the files whose timestamps are close to those of a set of anchor
+ * files can be found without querying the image database once per anchor.
+ * The timestamps of the anchors are looked up in file id order, and the 
+ * windows around them are then resolved in timestamp order with a binary
+ * search for each window and a walk that never goes back.
+ *
+ * Files without the timestamp, whose timestamp is 0, are not in the index.
+ */
+class TimestampIndex
+{
+public:
+    TimestampIndex();
+
+    /**
+     * Adds a file to the index. Files are added fastest in file id order.
+     *
+     * @param fileId The file id of the file.
+     * @param timestamp The timestamp of the file, in seconds.
+     */
+    void add(uint64_t fileId, int64_t timestamp);
+
+    /**
+     * Sorts the files added to the index. Must be called after the files 
+     * are added.
+     */
+    void build();
+
+    /**
+     * Removes all of the files from the index.
+     */
+    void clear();
+
+    size_t size() const { return m_byFileId.size(); }
+
+    /**
+     * Finds the files whose timestamps are within a number of seconds of 
+     * the timestamp of any of a set of anchor files. The anchor files are 
+     * among the files found.
+     *
+     * @param anchorFiles The anchor files.
+     * @param seconds The number of seconds before and after the timestamp of
+     * each anchor that the window around it spans.
+     * @param files Receives the files found.
+     */
+    void findNear(const FileIdSet &anchorFiles, int64_t seconds, FileIdSet &files) const;
+
+    /** Gets the number of bytes of memory held by the index. */
+    uint64_t getBytes() const;
+
+private:
+    struct Entry
+    {
+        Entry(uint64_t fileId, int64_t timestamp) : fileId(fileId), timestamp(timestamp) {}
+
+        uint64_t fileId;
+        int64_t timestamp;
+    };
+
+    static bool hasLowerFileId(const Entry &entry, uint64_t fileId) { return entry.fileId < fileId; }
+    static bool hasLowerTimestamp(const Entry &entry, int64_t timestamp) { return entry.timestamp < timestamp; }
+    static bool isOrderedByFileId(const Entry &a, const Entry &b) { return a.fileId < b.fileId; }
+    static bool isOrderedByTimestamp(const Entry &a, const Entry &b) { return a.timestamp < b.timestamp || (a.timestamp == b.timestamp && a.fileId < b.fileId); }
+
+    std::vector<Entry> m_byFileId;
+    std::vector<Entry> m_byTimestamp;
+};
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file FileIdSetChecker.cpp
+ * Contains a checker that builds random file id sets, unites, subtracts and
+ * intersects them, and compares every result with the same operations on a
+ * std::set. The sets are drawn from sparse, dense and multi-chunk ranges of
+ * file ids, so that chunks are converted between their array and bitmap
+ * forms in both directions.
+ */
+
+#include "FileIdSet.h"
+
+// System includes
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <iterator>
+#include <cstdlib>
+#include <ctime>
+
+namespace
+{
+    // The number of file ids in a chunk, and the number above which a chunk is stored as a bitmap.
+    const uint64_t CHUNK_SIZE = 65536;
+    const uint64_t MAX_ARRAY_SIZE = 4096;
+
+    typedef std::set<uint64_t> ReferenceSet;
+
+    uint64_t random(uint64_t limit)
+    {
+        const uint64_t value = (static_cast<uint64_t>(rand()) << 31) ^ static_cast<uint64_t>(rand());
+        return value % limit;
+    }
+
+    /**
+     * Adds random file ids to a file id set and its reference set. The ids
+     * are drawn from a few chunks around a base, with a density that
+     * leaves the chunks on either side of the array limit.
+     */
+    void addRandomFileIds(uint64_t base, FileIdSet &set, ReferenceSet &reference)
+    {
+        const uint64_t FILE_ID_COUNTS[] = { 0, 1, 100, MAX_ARRAY_SIZE - 1, MAX_ARRAY_SIZE + 1, 3 * MAX_ARRAY_SIZE, CHUNK_SIZE / 2 };
+        const uint64_t chunkCount = 1 + random(3);
+        for (uint64_t chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            const uint64_t first = base + (random(4) * CHUNK_SIZE);
+            const uint64_t count = FILE_ID_COUNTS[random(sizeof(FILE_ID_COUNTS) / sizeof(FILE_ID_COUNTS[0]))];
+            const bool isRange = random(3) == 0;
+            const uint64_t start = isRange ? random(CHUNK_SIZE - count + 1) : 0;
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                const uint64_t fileId = first + (isRange ? start + i : random(CHUNK_SIZE));
+                set.add(fileId);
+                reference.insert(fileId);
+            }
+        }
+    }
+
+    /**
+     * Compares a file id set with its reference set through size(),
+     * contains() and the iterator.
+     *
+     * @return True if they hold the same file ids.
+     */
+    bool isSame(const FileIdSet &set, const ReferenceSet &reference, const std::string &operation)
+    {
+        std::vector<uint64_t> fileIds;
+        for (FileIdSet::Iterator fileId(set); !fileId.atEnd(); fileId.next())
+        {
+            fileIds.push_back(fileId.get());
+        }
+
+        bool isSame = set.size() == reference.size() && set.empty() == reference.empty() && fileIds.size() == reference.size() &&
+            std::equal(fileIds.begin(), fileIds.end(), reference.begin());
+        for (ReferenceSet::const_iterator fileId = reference.begin(); isSame && fileId != reference.end(); ++fileId)
+        {
+            isSame = set.contains(*fileId) && !(reference.count(*fileId + 1) == 0 && set.contains(*fileId + 1));
+        }
+
+        if (!isSame)
+        {
+            std::cout << operation << ": file id set has " << set.size() << " ids, iterates " << fileIds.size() << ", std::set has "
+                << reference.size() << std::endl;
+        }
+        return isSame;
+    }
+
+    void usage()
+    {
+        std::cerr << "usage: FileIdSetChecker [-rounds N] [-seed N]" << std::endl;
+        exit(2);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t roundCount = 200;
+    unsigned int seed = static_cast<unsigned int>(time(NULL));
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string option = argv[i];
+        if (i + 1 >= argc)
+        {
+            usage();
+        }
+        if (option == "-rounds")
+        {
+            roundCount = strtoul(argv[++i], NULL, 10);
+        }
+        else if (option == "-seed")
+        {
+            seed = static_cast<unsigned int>(strtoul(argv[++i], NULL, 10));
+        }
+        else
+        {
+            usage();
+        }
+    }
+    srand(seed);
+    std::cout << "seed " << seed << std::endl;
+
+    size_t failureCount = 0;
+    for (size_t round = 0; round < roundCount; ++round)
+    {
+        // The two sets share some chunks and not others, and are sometimes far apart.
+        const uint64_t base = random(2) == 0 ? 0 : random(static_cast<uint64_t>(1) << 40);
+        FileIdSet first;
+        FileIdSet second;
+        ReferenceSet firstReference;
+        ReferenceSet secondReference;
+        addRandomFileIds(base, first, firstReference);
+        addRandomFileIds(random(4) == 0 ? base + 10 * CHUNK_SIZE : base, second, secondReference);
+        failureCount += isSame(first, firstReference, "add") ? 0 : 1;
+        failureCount += isSame(second, secondReference, "add") ? 0 : 1;
+
+        ReferenceSet expected;
+        FileIdSet united = first;
+        united.unite(second);
+        std::set_union(firstReference.begin(), firstReference.end(), secondReference.begin(), secondReference.end(),
+            std::inserter(expected, expected.end()));
+        failureCount += isSame(united, expected, "unite") ? 0 : 1;
+
+        expected.clear();
+        FileIdSet subtracted = first;
+        subtracted.subtract(second);
+        std::set_difference(firstReference.begin(), firstReference.end(), secondReference.begin(), secondReference.end(),
+            std::inserter(expected, expected.end()));
+        failureCount += isSame(subtracted, expected, "subtract") ? 0 : 1;
+
+        expected.clear();
+        FileIdSet intersected = first;
+        intersected.intersect(second);
+        std::set_intersection(firstReference.begin(), firstReference.end(), secondReference.begin(), secondReference.end(),
+            std::inserter(expected, expected.end()));
+        failureCount += isSame(intersected, expected, "intersect") ? 0 : 1;
+
+        // A set that has shrunk below the array limit must still grow correctly.
+        expected.clear();
+        std::set_difference(firstReference.begin(), firstReference.end(), secondReference.begin(), secondReference.end(),
+            std::inserter(expected, expected.end()));
+        addRandomFileIds(base, subtracted, expected);
+        failureCount += isSame(subtracted, expected, "add after subtract") ? 0 : 1;
+
+        first.clear();
+        failureCount += isSame(first, ReferenceSet(), "clear") ? 0 : 1;
+    }
+
+    std::cout << roundCount << " rounds, " << failureCount << " failures" << std::endl;
+    return failureCount == 0 ? 0 : 1;
+}
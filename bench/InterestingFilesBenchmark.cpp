@@ -0,0 +1,307 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file InterestingFilesBenchmark.cpp
+ * Contains a benchmark that runs the interesting files module against a
+ * synthetic image database and reports its throughput and memory use for
+ * each of a list of configuration files.
+ */
+
+#include "SyntheticImageGenerator.h"
+
+// TSK Framework includes
+#include "TskModuleDev.h"
+#include "framework.h"
+
+// Poco includes
+#include "Poco/Path.h"
+#include "Poco/File.h"
+#include "Poco/Timestamp.h"
+#include "Poco/NumberParser.h"
+
+// System includes
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <sqlite3.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// The module API, linked into the benchmark.
+extern "C"
+{
+    TskModule::Status initialize(const char *arguments);
+    TskModule::Status report();
+    TskModule::Status finalize();
+}
+
+namespace
+{
+    const std::string IMAGE_DATABASE_FILE_NAME = "image.db";
+
+    void printUsage()
+    {
+        std::cerr << "Usage: InterestingFilesBenchmark [options] configuration_file..." << std::endl
+            << "Runs the interesting files module against a synthetic image database once per" << std::endl
+            << "configuration file and prints files/s, hits/s and peak RSS as tab separated values." << std::endl
+            << "Options:" << std::endl
+            << "  -files N                Number of files to generate (default 1000000, at most " << SyntheticImageGenerator::MAX_FILE_COUNT << ")" << std::endl
+            << "  -filesPerDirectory N    Average number of files per directory (default 15)" << std::endl
+            << "  -maxDepth N             Maximum directory depth (default 12)" << std::endl
+            << "  -seed N                 Random number generator seed (default 1)" << std::endl
+            << "  -output PATH            Output folder (default bench_output)" << std::endl;
+    }
+
+    /**
+     * Sets up the framework services that the module uses, for an image
+     * database in the given folder.
+     */
+    void setUpServices(const std::string &outputPath, TskImgDBSqlite &imgDB)
+    {
+        static Log log;
+        log.open(Poco::Path(Poco::Path::forDirectory(outputPath), "benchmark.log").toString().c_str());
+        TskServices::Instance().setLog(log);
+
+        static TskSystemPropertiesImpl systemProperties;
+        systemProperties.initialize();
+        TskServices::Instance().setSystemProperties(systemProperties);
+        SetSystemProperty(TskSystemProperties::OUT_DIR, outputPath);
+
+        TskServices::Instance().setImgDB(imgDB);
+        TskServices::Instance().setBlackboard((TskBlackboard &)TskDBBlackboard::instance());
+        TskServices::Instance().setFileManager(TskFileManagerImpl::instance());
+    }
+
+    /**
+     * Creates an image database with the framework schema and fills its files
+     * table with a synthetic file system.
+     */
+    void generateImageDatabase(const std::string &templatePath, const SyntheticImageGenerator::Options &options)
+    {
+        Poco::File(templatePath).createDirectories();
+        Poco::File imageDatabaseFile(Poco::Path(Poco::Path::forDirectory(templatePath), IMAGE_DATABASE_FILE_NAME).toString());
+        if (imageDatabaseFile.exists())
+        {
+            imageDatabaseFile.remove();
+        }
+
+        {
+            TskImgDBSqlite imgDB(templatePath.c_str());
+            setUpServices(templatePath, imgDB);
+            if (imgDB.initialize() != 0)
+            {
+                throw TskException("generateImageDatabase : failed to create image database in " + templatePath);
+            }
+        }
+
+        Poco::Timestamp start;
+        SyntheticImageGenerator generator(options);
+        generator.generate(imageDatabaseFile.path());
+        std::cerr << "Generated " << options.fileCount << " files in " << generator.getDirectoryCount() << " directories in "
+            << start.elapsed() / 1000000.0 << " s" << std::endl;
+    }
+
+    /**
+     * Counts the interesting file hits posted to the blackboard.
+     */
+    uint64_t countHits(const std::string &imageDatabasePath)
+    {
+        sqlite3 *database = NULL;
+        uint64_t hitCount = 0;
+        if (sqlite3_open(imageDatabasePath.c_str(), &database) == SQLITE_OK)
+        {
+            std::ostringstream query;
+            query << "SELECT COUNT(*) FROM blackboard_artifacts WHERE artifact_type_id = " << TSK_INTERESTING_FILE_HIT;
+            sqlite3_stmt *statement = NULL;
+            if (sqlite3_prepare_v2(database, query.str().c_str(), -1, &statement, NULL) == SQLITE_OK && sqlite3_step(statement) == SQLITE_ROW)
+            {
+                hitCount = sqlite3_column_int64(statement, 0);
+            }
+            sqlite3_finalize(statement);
+        }
+        sqlite3_close(database);
+        return hitCount;
+    }
+
+    /**
+     * Runs the module with one configuration file against a copy of the
+     * generated image database, and prints the results. Runs in a child
+     * process so that the peak RSS is that of this run alone.
+     *
+     * @return The process exit code.
+     */
+    int runConfiguration(const std::string &configurationPath, const std::string &templatePath, const std::string &runPath, uint64_t fileCount)
+    {
+        try
+        {
+            // Start from a copy of the generated image database, without the hits of previous runs.
+            Poco::File(runPath).createDirectories();
+            Poco::File imageDatabaseFile(Poco::Path(Poco::Path::forDirectory(runPath), IMAGE_DATABASE_FILE_NAME).toString());
+            if (imageDatabaseFile.exists())
+            {
+                imageDatabaseFile.remove();
+            }
+            Poco::File(Poco::Path(Poco::Path::forDirectory(templatePath), IMAGE_DATABASE_FILE_NAME).toString()).copyTo(runPath);
+
+            TskImgDBSqlite imgDB(runPath.c_str());
+            setUpServices(runPath, imgDB);
+            if (imgDB.open() != 0)
+            {
+                throw TskException("runConfiguration : failed to open image database in " + runPath);
+            }
+
+            Poco::Timestamp initializeStart;
+            if (initialize(configurationPath.c_str()) != TskModule::OK)
+            {
+                throw TskException("runConfiguration : module initialization failed, see benchmark.log in " + runPath);
+            }
+            const double initializeSeconds = initializeStart.elapsed() / 1000000.0;
+
+            Poco::Timestamp reportStart;
+            const TskModule::Status reportStatus = report();
+            const double reportSeconds = reportStart.elapsed() / 1000000.0;
+            finalize();
+            if (reportStatus != TskModule::OK)
+            {
+                throw TskException("runConfiguration : module report failed, see benchmark.log in " + runPath);
+            }
+
+            const uint64_t hitCount = countHits(imageDatabaseFile.path());
+
+            struct rusage usage;
+            getrusage(RUSAGE_SELF, &usage);
+
+            std::cout << configurationPath << "\t" << fileCount << "\t" << hitCount << "\t" << initializeSeconds << "\t" << reportSeconds
+                << "\t" << (reportSeconds > 0.0 ? fileCount / reportSeconds : 0.0) << "\t" << (reportSeconds > 0.0 ? hitCount / reportSeconds : 0.0)
+                << "\t" << usage.ru_maxrss << std::endl;
+            return EXIT_SUCCESS;
+        }
+        catch (TskException &ex)
+        {
+            std::cerr << configurationPath << ": " << ex.message() << std::endl;
+        }
+        catch (Poco::Exception &ex)
+        {
+            std::cerr << configurationPath << ": " << ex.displayText() << std::endl;
+        }
+        catch (std::exception &ex)
+        {
+            std::cerr << configurationPath << ": " << ex.what() << std::endl;
+        }
+        return EXIT_FAILURE;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    SyntheticImageGenerator::Options options;
+    std::string outputPath = "bench_output";
+    std::vector<std::string> configurationPaths;
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument(argv[i]);
+            if (argument[0] != '-')
+            {
+                configurationPaths.push_back(Poco::Path(argument).absolute().toString());
+            }
+            else if (i + 1 >= argc)
+            {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+            else if (argument == "-files")
+            {
+                options.fileCount = Poco::NumberParser::parseUnsigned64(argv[++i]);
+            }
+            else if (argument == "-filesPerDirectory")
+            {
+                options.filesPerDirectory = Poco::NumberParser::parseUnsigned64(argv[++i]);
+            }
+            else if (argument == "-maxDepth")
+            {
+                options.maxDepth = Poco::NumberParser::parseUnsigned(argv[++i]);
+            }
+            else if (argument == "-seed")
+            {
+                options.seed = Poco::NumberParser::parseUnsigned64(argv[++i]);
+            }
+            else if (argument == "-output")
+            {
+                outputPath = argv[++i];
+            }
+            else
+            {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    catch (Poco::Exception &ex)
+    {
+        std::cerr << ex.displayText() << std::endl;
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    if (configurationPaths.empty())
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    outputPath = Poco::Path(Poco::Path::forDirectory(outputPath)).absolute().toString();
+    Poco::Path templateFolderPath(Poco::Path::forDirectory(outputPath));
+    templateFolderPath.pushDirectory("template");
+    const std::string templatePath = templateFolderPath.toString();
+    try
+    {
+        generateImageDatabase(templatePath, options);
+    }
+    catch (TskException &ex)
+    {
+        std::cerr << ex.message() << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch (Poco::Exception &ex)
+    {
+        std::cerr << ex.displayText() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "configuration\tfiles\thits\tinitialize_seconds\treport_seconds\tfiles_per_second\thits_per_second\tpeak_rss_kb" << std::endl;
+    int exitCode = EXIT_SUCCESS;
+    for (size_t i = 0; i < configurationPaths.size(); ++i)
+    {
+        std::ostringstream runName;
+        runName << "run_" << i + 1;
+        Poco::Path runFolderPath(Poco::Path::forDirectory(outputPath));
+        runFolderPath.pushDirectory(runName.str());
+        const std::string runPath = runFolderPath.toString();
+
+        const pid_t child = fork();
+        if (child == 0)
+        {
+            _exit(runConfiguration(configurationPaths[i], templatePath, runPath, options.fileCount));
+        }
+
+        int childStatus = 0;
+        if (child < 0 || waitpid(child, &childStatus, 0) != child || !WIFEXITED(childStatus) || WEXITSTATUS(childStatus) != EXIT_SUCCESS)
+        {
+            exitCode = EXIT_FAILURE;
+        }
+    }
+
+    return exitCode;
+}
@@ -0,0 +1,487 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file MatcherMicrobenchmark.cpp
+ * Contains a microbenchmark that times, for each shape of pattern that the
+ * module compiles from file name and extension conditions, the SQL LIKE
+ * query the module pushes down to the image database against the native
+ * matcher that evaluates the same pattern in the module, over the same
+ * synthetic corpus of file records.
+ */
+
+#include "SyntheticImageGenerator.h"
+#include "Glob.h"
+#include "DirectoryTree.h"
+#include "PathFilter.h"
+
+// TSK Framework includes
+#include "TskModuleDev.h"
+
+// Poco includes
+#include "Poco/Path.h"
+#include "Poco/File.h"
+#include "Poco/String.h"
+#include "Poco/Timestamp.h"
+#include "Poco/NumberParser.h"
+
+// System includes
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <sqlite3.h>
+
+namespace
+{
+    // The files table of the framework's SQLite image database.
+    const char *FILES_TABLE_SCHEMA = "CREATE TABLE files (file_id INTEGER PRIMARY KEY, type_id INTEGER, name TEXT, par_file_id INTEGER, "
+        "dir_type INTEGER, meta_type INTEGER, dir_flags INTEGER, meta_flags INTEGER, size INTEGER, ctime INTEGER, crtime INTEGER, "
+        "atime INTEGER, mtime INTEGER, mode INTEGER, uid INTEGER, gid INTEGER, status INTEGER, full_path TEXT)";
+
+    /** The kinds of condition the module compiles patterns from. */
+    enum PatternKind { NAME_PATTERN, EXTENSION_PATTERN, PATH_FILTER_PATTERN, TYPE_FILTER_PATTERN };
+
+    /** A pattern of a given shape, as it would appear in a configuration file. */
+    struct PatternShape
+    {
+        const char *shape;
+        PatternKind kind;
+        const char *pattern;
+    };
+
+    const PatternShape PATTERN_SHAPES[] =
+    {
+        { "exact_name", NAME_PATTERN, "readme.txt" },
+        { "leading_glob", NAME_PATTERN, "*0.dll" },
+        { "trailing_glob", NAME_PATTERN, "setup*" },
+        { "infix_glob", NAME_PATTERN, "*word*" },
+        { "multiple_glob", NAME_PATTERN, "api*core*.dll" },
+        { "suffix_extension", EXTENSION_PATTERN, ".txt" },
+        { "glob_extension", EXTENSION_PATTERN, ".htm*" },
+        { "path_filter", PATH_FILTER_PATTERN, "temp/cache" },
+        { "type_filter", TYPE_FILTER_PATTERN, "dir" }
+    };
+
+    /** A file record of the corpus, with the values the native matchers use already folded. */
+    struct CorpusFile
+    {
+        uint64_t fileId;
+        uint64_t parentFileId;
+        int metaType;
+        std::string name;
+        std::string fullPath;
+        std::string foldedName;
+        std::string foldedPath;
+    };
+
+    /** The times taken by the repetitions of one measurement. */
+    struct Timing
+    {
+        double minSeconds;
+        double medianSeconds;
+    };
+
+    void printUsage()
+    {
+        std::cerr << "Usage: MatcherMicrobenchmark [options]" << std::endl
+            << "Times the SQL LIKE form of each pattern shape against the native matcher over the" << std::endl
+            << "same corpus and prints the results as JSON lines." << std::endl
+            << "Options:" << std::endl
+            << "  -files N                Number of files in the corpus (default 1000000)" << std::endl
+            << "  -filesPerDirectory N    Average number of files per directory (default 15)" << std::endl
+            << "  -maxDepth N             Maximum directory depth (default 12)" << std::endl
+            << "  -seed N                 Random number generator seed (default 1)" << std::endl
+            << "  -repeat N               Number of times each measurement is repeated (default 5)" << std::endl
+            << "  -output PATH            Folder for the corpus database (default bench_output)" << std::endl;
+    }
+
+    void throwSqliteError(sqlite3 *database, const std::string &action)
+    {
+        std::ostringstream msg;
+        msg << "MatcherMicrobenchmark : failed to " << action << ": " << sqlite3_errmsg(database);
+        throw TskException(msg.str());
+    }
+
+    std::string quote(const std::string &s)
+    {
+        std::string quoted("'");
+        for (std::string::const_iterator c = s.begin(); c != s.end(); ++c)
+        {
+            quoted += *c;
+            if (*c == '\'')
+            {
+                quoted += '\'';
+            }
+        }
+        return quoted + "'";
+    }
+
+    /**
+     * Builds the SQL WHERE clause expression that the module compiles from a
+     * pattern, as compileFileNameSearchCondition(),
+     * compileExtensionSearchCondition() and parsePathOrTypeFilterOption() do.
+     */
+    std::string getSqlCondition(const PatternShape &shape)
+    {
+        std::string pattern(shape.pattern);
+        std::ostringstream condition;
+        switch (shape.kind)
+        {
+        case NAME_PATTERN:
+            if (hasGlobWildcards(pattern))
+            {
+                convertGlobWildcardsToSQLWildcards(pattern);
+                condition << "UPPER(name) LIKE UPPER(" << quote(pattern) << ") ESCAPE '#'";
+            }
+            else
+            {
+                condition << "UPPER(name) = UPPER(" << quote(pattern) << ")";
+            }
+            break;
+        case EXTENSION_PATTERN:
+            // A pattern with wildcards is matched against the extension from the last '.', as the module matches it.
+            if (hasGlobWildcards(pattern))
+            {
+                convertGlobWildcardsToSQLWildcards(pattern);
+                condition << "UPPER(SUBSTR(name, LENGTH(RTRIM(name, REPLACE(name, '.', ''))))) LIKE UPPER(" << quote(pattern) << ") ESCAPE '#'";
+            }
+            else
+            {
+                convertGlobWildcardsToSQLWildcards(pattern);
+                condition << "UPPER(name) LIKE UPPER(" << quote("%" + pattern) << ") ESCAPE '#'";
+            }
+            break;
+        case PATH_FILTER_PATTERN:
+            convertGlobWildcardsToSQLWildcards(pattern);
+            condition << "UPPER(full_path) LIKE UPPER('%" << pattern << "%') ESCAPE '#'";
+            break;
+        case TYPE_FILTER_PATTERN:
+            condition << "meta_type = " << TSK_FS_META_TYPE_DIR;
+            break;
+        }
+        return condition.str();
+    }
+
+    Timing getTiming(std::vector<double> &seconds)
+    {
+        std::sort(seconds.begin(), seconds.end());
+        Timing timing;
+        timing.minSeconds = seconds.front();
+        timing.medianSeconds = seconds[seconds.size() / 2];
+        return timing;
+    }
+
+    void printResult(const std::string &shape, const std::string &pattern, const std::string &method, uint64_t rows, uint64_t matches,
+        const Timing &timing, bool hasExpectedMatches, uint64_t expectedMatches)
+    {
+        std::string escapedPattern;
+        for (std::string::const_iterator c = pattern.begin(); c != pattern.end(); ++c)
+        {
+            if (*c == '"' || *c == '\\')
+            {
+                escapedPattern += '\\';
+            }
+            escapedPattern += *c;
+        }
+
+        std::cout << "{\"shape\": \"" << shape << "\", \"pattern\": \"" << escapedPattern << "\", \"method\": \"" << method
+            << "\", \"rows\": " << rows << ", \"matches\": " << matches << ", \"min_seconds\": " << timing.minSeconds
+            << ", \"median_seconds\": " << timing.medianSeconds << ", \"ns_per_row\": " << (rows != 0 ? timing.minSeconds * 1e9 / rows : 0.0);
+        if (hasExpectedMatches)
+        {
+            std::cout << ", \"agrees_with_sql\": " << (matches == expectedMatches ? "true" : "false");
+        }
+        std::cout << "}" << std::endl;
+    }
+
+    /**
+     * Times a query the way the module runs it, reading the file id of every
+     * row the query selects.
+     */
+    Timing timeQuery(sqlite3 *database, const std::string &condition, unsigned int repeatCount, uint64_t &matches)
+    {
+        const std::string query = "SELECT file_id FROM files WHERE " + condition + " ORDER BY file_id";
+        std::vector<double> seconds;
+        for (unsigned int i = 0; i < repeatCount; ++i)
+        {
+            Poco::Timestamp start;
+            sqlite3_stmt *statement = NULL;
+            if (sqlite3_prepare_v2(database, query.c_str(), -1, &statement, NULL) != SQLITE_OK)
+            {
+                throwSqliteError(database, "prepare " + query);
+            }
+
+            matches = 0;
+            uint64_t fileIdSum = 0;
+            while (sqlite3_step(statement) == SQLITE_ROW)
+            {
+                fileIdSum += sqlite3_column_int64(statement, 0);
+                ++matches;
+            }
+            sqlite3_finalize(statement);
+            seconds.push_back(start.elapsed() / 1000000.0);
+        }
+        return getTiming(seconds);
+    }
+
+    /**
+     * Times the native matcher for a pattern over the corpus, using the same
+     * matching functions as the module's scan conditions.
+     */
+    Timing timeNativeMatcher(const std::vector<CorpusFile> &corpus, const PatternShape &shape, unsigned int repeatCount, uint64_t &matches)
+    {
+        const std::string foldedPattern = Poco::toUpper(std::string(shape.pattern));
+        const std::string pathPattern = "*" + foldedPattern + "*";
+
+        std::vector<double> seconds;
+        for (unsigned int i = 0; i < repeatCount; ++i)
+        {
+            Poco::Timestamp start;
+            matches = 0;
+            for (std::vector<CorpusFile>::const_iterator file = corpus.begin(); file != corpus.end(); ++file)
+            {
+                bool isMatch = false;
+                switch (shape.kind)
+                {
+                case NAME_PATTERN:
+                    isMatch = matchesGlob(foldedPattern, file->foldedName);
+                    break;
+                case EXTENSION_PATTERN:
+                    {
+                        const size_t lastDot = file->foldedName.rfind('.');
+                        isMatch = lastDot != std::string::npos && matchesGlob(foldedPattern, file->foldedName.substr(lastDot));
+                    }
+                    break;
+                case PATH_FILTER_PATTERN:
+                    isMatch = matchesGlob(pathPattern, file->foldedPath);
+                    break;
+                case TYPE_FILTER_PATTERN:
+                    isMatch = file->metaType == TSK_FS_META_TYPE_DIR;
+                    break;
+                }
+                matches += isMatch ? 1 : 0;
+            }
+            seconds.push_back(start.elapsed() / 1000000.0);
+        }
+        return getTiming(seconds);
+    }
+
+    /**
+     * Times a path filter evaluated per directory with the directory tree, as
+     * the module evaluates path filters.
+     */
+    Timing timePathIndex(const std::vector<CorpusFile> &corpus, const DirectoryTree &directories, const PatternShape &shape, unsigned int repeatCount, uint64_t &matches)
+    {
+        std::vector<double> seconds;
+        for (unsigned int i = 0; i < repeatCount; ++i)
+        {
+            Poco::Timestamp start;
+            PathFilter pathFilter(Poco::toUpper(std::string(shape.pattern)));
+            matches = 0;
+            for (std::vector<CorpusFile>::const_iterator file = corpus.begin(); file != corpus.end(); ++file)
+            {
+                const size_t parent = directories.find(file->parentFileId);
+                const bool isMatch = parent != DirectoryTree::NO_DIRECTORY ? pathFilter.matches(directories, parent, file->foldedName) : pathFilter.matchesPath(file->foldedPath);
+                matches += isMatch ? 1 : 0;
+            }
+            seconds.push_back(start.elapsed() / 1000000.0);
+        }
+        return getTiming(seconds);
+    }
+
+    void loadCorpus(sqlite3 *database, std::vector<CorpusFile> &corpus)
+    {
+        sqlite3_stmt *statement = NULL;
+        if (sqlite3_prepare_v2(database, "SELECT file_id, par_file_id, meta_type, name, full_path FROM files ORDER BY file_id", -1, &statement, NULL) != SQLITE_OK)
+        {
+            throwSqliteError(database, "prepare corpus query");
+        }
+
+        while (sqlite3_step(statement) == SQLITE_ROW)
+        {
+            CorpusFile file;
+            file.fileId = sqlite3_column_int64(statement, 0);
+            file.parentFileId = sqlite3_column_int64(statement, 1);
+            file.metaType = sqlite3_column_int(statement, 2);
+            file.name = reinterpret_cast<const char *>(sqlite3_column_text(statement, 3));
+            file.fullPath = reinterpret_cast<const char *>(sqlite3_column_text(statement, 4));
+            corpus.push_back(file);
+        }
+        sqlite3_finalize(statement);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    SyntheticImageGenerator::Options options;
+    unsigned int repeatCount = 5;
+    std::string outputPath = "bench_output";
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument(argv[i]);
+            if (i + 1 >= argc)
+            {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+            else if (argument == "-files")
+            {
+                options.fileCount = Poco::NumberParser::parseUnsigned64(argv[++i]);
+            }
+            else if (argument == "-filesPerDirectory")
+            {
+                options.filesPerDirectory = Poco::NumberParser::parseUnsigned64(argv[++i]);
+            }
+            else if (argument == "-maxDepth")
+            {
+                options.maxDepth = Poco::NumberParser::parseUnsigned(argv[++i]);
+            }
+            else if (argument == "-seed")
+            {
+                options.seed = Poco::NumberParser::parseUnsigned64(argv[++i]);
+            }
+            else if (argument == "-repeat")
+            {
+                repeatCount = std::max(1u, Poco::NumberParser::parseUnsigned(argv[++i]));
+            }
+            else if (argument == "-output")
+            {
+                outputPath = argv[++i];
+            }
+            else
+            {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    catch (Poco::Exception &ex)
+    {
+        std::cerr << ex.displayText() << std::endl;
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    sqlite3 *database = NULL;
+    try
+    {
+        Poco::File(outputPath).createDirectories();
+        Poco::File corpusFile(Poco::Path(Poco::Path::forDirectory(outputPath), "corpus.db").toString());
+        if (corpusFile.exists())
+        {
+            corpusFile.remove();
+        }
+
+        if (sqlite3_open(corpusFile.path().c_str(), &database) != SQLITE_OK)
+        {
+            throwSqliteError(database, "open " + corpusFile.path());
+        }
+        if (sqlite3_exec(database, FILES_TABLE_SCHEMA, NULL, NULL, NULL) != SQLITE_OK)
+        {
+            throwSqliteError(database, "create files table");
+        }
+        sqlite3_close(database);
+        database = NULL;
+
+        SyntheticImageGenerator generator(options);
+        generator.generate(corpusFile.path());
+
+        if (sqlite3_open(corpusFile.path().c_str(), &database) != SQLITE_OK)
+        {
+            throwSqliteError(database, "open " + corpusFile.path());
+        }
+
+        std::vector<CorpusFile> corpus;
+        loadCorpus(database, corpus);
+        const uint64_t rowCount = corpus.size();
+
+        // The module folds each name and path once per file, no matter how many conditions use them.
+        std::vector<double> seconds;
+        for (unsigned int i = 0; i < repeatCount; ++i)
+        {
+            Poco::Timestamp start;
+            for (std::vector<CorpusFile>::iterator file = corpus.begin(); file != corpus.end(); ++file)
+            {
+                file->foldedName = Poco::toUpper(file->name);
+            }
+            seconds.push_back(start.elapsed() / 1000000.0);
+        }
+        printResult("fold", "name", "native", rowCount, 0, getTiming(seconds), false, 0);
+
+        seconds.clear();
+        for (unsigned int i = 0; i < repeatCount; ++i)
+        {
+            Poco::Timestamp start;
+            for (std::vector<CorpusFile>::iterator file = corpus.begin(); file != corpus.end(); ++file)
+            {
+                file->foldedPath = Poco::toUpper(file->fullPath);
+            }
+            seconds.push_back(start.elapsed() / 1000000.0);
+        }
+        printResult("fold", "full_path", "native", rowCount, 0, getTiming(seconds), false, 0);
+
+        DirectoryTree directories;
+        seconds.clear();
+        for (unsigned int i = 0; i < repeatCount; ++i)
+        {
+            Poco::Timestamp start;
+            directories.clear();
+            for (std::vector<CorpusFile>::const_iterator file = corpus.begin(); file != corpus.end(); ++file)
+            {
+                if (file->metaType == TSK_FS_META_TYPE_DIR)
+                {
+                    directories.add(file->fileId, file->parentFileId, file->foldedName);
+                }
+            }
+            directories.build();
+            seconds.push_back(start.elapsed() / 1000000.0);
+        }
+        printResult("directory_tree", "", "native", directories.size(), 0, getTiming(seconds), false, 0);
+
+        for (size_t i = 0; i < sizeof(PATTERN_SHAPES) / sizeof(PATTERN_SHAPES[0]); ++i)
+        {
+            const PatternShape &shape = PATTERN_SHAPES[i];
+
+            uint64_t sqlMatches = 0;
+            const Timing sqlTiming = timeQuery(database, getSqlCondition(shape), repeatCount, sqlMatches);
+            printResult(shape.shape, shape.pattern, "sql", rowCount, sqlMatches, sqlTiming, false, 0);
+
+            uint64_t nativeMatches = 0;
+            const Timing nativeTiming = timeNativeMatcher(corpus, shape, repeatCount, nativeMatches);
+            printResult(shape.shape, shape.pattern, "native", rowCount, nativeMatches, nativeTiming, true, sqlMatches);
+
+            if (shape.kind == PATH_FILTER_PATTERN)
+            {
+                uint64_t indexMatches = 0;
+                const Timing indexTiming = timePathIndex(corpus, directories, shape, repeatCount, indexMatches);
+                printResult(shape.shape, shape.pattern, "native_path_index", rowCount, indexMatches, indexTiming, true, sqlMatches);
+            }
+        }
+    }
+    catch (TskException &ex)
+    {
+        std::cerr << ex.message() << std::endl;
+        sqlite3_close(database);
+        return EXIT_FAILURE;
+    }
+    catch (Poco::Exception &ex)
+    {
+        std::cerr << ex.displayText() << std::endl;
+        sqlite3_close(database);
+        return EXIT_FAILURE;
+    }
+
+    sqlite3_close(database);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,224 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file RegexSetChecker.cpp
+ * Contains a checker that matches random regular expressions against random
+ * strings with the module's regex set and with std::regex, and reports any
+ * string on which they disagree. It also checks that expressions that are
+ * too large are rejected before they are expanded. It needs C++11 for
+ * std::regex; the module itself does not.
+ */
+
+#include "RegexSet.h"
+
+// TSK Framework includes
+#include "TskModuleDev.h"
+
+// System includes
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <regex>
+#include <cstdlib>
+#include <ctime>
+
+namespace
+{
+    // The bytes strings are made of, already folded to upper case as the regex set expects.
+    const char TEXT_BYTES[] = "ABC01 -_.";
+
+    // The regex sets are small so that the DFA state cache is exercised along with the automaton.
+    const size_t EXPRESSIONS_PER_SET = 8;
+    const size_t STRINGS_PER_SET = 300;
+
+    // Expressions whose counted repetitions would expand to far more NFA states than the limit.
+    const char *TOO_LARGE_EXPRESSIONS[] =
+    {
+        "((a{1000}){1000}){20}",
+        "((a{1000}){1000}){1000}",
+        "(a{100}b{100}){100}",
+        "((a|b){100}){100}"
+    };
+
+    size_t random(size_t limit)
+    {
+        return static_cast<size_t>(rand()) % limit;
+    }
+
+    std::string randomAtom(int depth);
+
+    std::string randomAlternation(int depth)
+    {
+        std::string expression;
+        const size_t alternativeCount = 1 + random(depth > 0 ? 3 : 1);
+        for (size_t i = 0; i < alternativeCount; ++i)
+        {
+            if (i != 0)
+            {
+                expression += '|';
+            }
+            const size_t atomCount = random(4);
+            for (size_t j = 0; j < atomCount; ++j)
+            {
+                // Groups are only repeated a bounded number of times, since std::regex backtracks and takes exponential
+                // time over nested unbounded repetitions.
+                const std::string atom = randomAtom(depth - 1);
+                const bool isGroup = atom[0] == '(';
+                expression += atom;
+                switch (random(8))
+                {
+                case 0:
+                    expression += isGroup ? '?' : '*';
+                    break;
+                case 1:
+                    expression += isGroup ? '?' : '+';
+                    break;
+                case 2:
+                    expression += '?';
+                    break;
+                case 3:
+                    {
+                        const size_t minimum = random(3);
+                        std::ostringstream count;
+                        count << '{' << minimum;
+                        if (random(2) == 0)
+                        {
+                            count << ',';
+                            if (isGroup || random(2) == 0)
+                            {
+                                count << minimum + random(3);
+                            }
+                        }
+                        count << '}';
+                        expression += count.str();
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+        return expression;
+    }
+
+    std::string randomAtom(int depth)
+    {
+        const char *ATOMS[] = { "a", "B", "c", "0", "1", " ", "-", ".", "\\.", "\\d", "[ab]", "[^a]", "[0-1c]", "[a-c_]" };
+        if (depth > 0 && random(4) == 0)
+        {
+            return (random(2) == 0 ? "(" : "(?:") + randomAlternation(depth) + ")";
+        }
+        return ATOMS[random(sizeof(ATOMS) / sizeof(ATOMS[0]))];
+    }
+
+    std::string randomExpression()
+    {
+        // Anchors may only appear at the ends of an expression.
+        const std::string expression = "(" + randomAlternation(3) + ")";
+        return (random(4) == 0 ? "^" : "") + expression + (random(4) == 0 ? "$" : "");
+    }
+
+    std::string randomText()
+    {
+        std::string text;
+        const size_t length = random(16);
+        for (size_t i = 0; i < length; ++i)
+        {
+            text += TEXT_BYTES[random(sizeof(TEXT_BYTES) - 1)];
+        }
+        return text;
+    }
+
+    void usage()
+    {
+        std::cerr << "usage: RegexSetChecker [-sets N] [-seed N]" << std::endl;
+        exit(2);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t setCount = 1000;
+    unsigned int seed = static_cast<unsigned int>(time(NULL));
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string option = argv[i];
+        if (i + 1 >= argc)
+        {
+            usage();
+        }
+        if (option == "-sets")
+        {
+            setCount = strtoul(argv[++i], NULL, 10);
+        }
+        else if (option == "-seed")
+        {
+            seed = static_cast<unsigned int>(strtoul(argv[++i], NULL, 10));
+        }
+        else
+        {
+            usage();
+        }
+    }
+    srand(seed);
+    std::cout << "seed " << seed << std::endl;
+
+    size_t failureCount = 0;
+    for (size_t i = 0; i < sizeof(TOO_LARGE_EXPRESSIONS) / sizeof(TOO_LARGE_EXPRESSIONS[0]); ++i)
+    {
+        RegexSet regexSet;
+        try
+        {
+            regexSet.add(TOO_LARGE_EXPRESSIONS[i]);
+            std::cout << "accepted too large expression '" << TOO_LARGE_EXPRESSIONS[i] << "'" << std::endl;
+            ++failureCount;
+        }
+        catch (TskException &)
+        {
+        }
+    }
+
+    size_t comparisonCount = 0;
+    for (size_t i = 0; i < setCount; ++i)
+    {
+        RegexSet regexSet;
+        std::vector<std::string> expressions;
+        std::vector<std::regex> references;
+        for (size_t j = 0; j < EXPRESSIONS_PER_SET; ++j)
+        {
+            expressions.push_back(randomExpression());
+            regexSet.add(expressions.back());
+            references.push_back(std::regex(expressions.back(), std::regex::ECMAScript | std::regex::icase));
+        }
+        regexSet.compile();
+
+        std::vector<bool> matches;
+        for (size_t j = 0; j < STRINGS_PER_SET; ++j)
+        {
+            const std::string text = randomText();
+            regexSet.match(text, matches);
+            for (size_t k = 0; k < expressions.size(); ++k)
+            {
+                ++comparisonCount;
+                const bool expected = std::regex_search(text, references[k]);
+                if (matches[k] != expected)
+                {
+                    std::cout << "'" << expressions[k] << "' on '" << text << "': regex set " << matches[k]
+                        << ", std::regex " << expected << std::endl;
+                    ++failureCount;
+                }
+            }
+        }
+    }
+
+    std::cout << comparisonCount << " comparisons, " << failureCount << " failures" << std::endl;
+    return failureCount == 0 ? 0 : 1;
+}
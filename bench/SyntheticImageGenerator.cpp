@@ -0,0 +1,322 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file SyntheticImageGenerator.cpp
+ * Contains the implementation of a generator of synthetic image databases.
+ */
+
+#include "SyntheticImageGenerator.h"
+
+// TSK Framework includes
+#include "TskModuleDev.h"
+#include "framework.h"
+
+// System includes
+#include <sstream>
+#include <cmath>
+#include <sqlite3.h>
+
+namespace
+{
+    // Folder names, and how often they occur relative to each other.
+    const char *DIRECTORY_NAMES[] = { "Windows", "System32", "Program Files", "Users", "Documents and Settings", "AppData",
+        "Local", "Roaming", "Temp", "Microsoft", "Application Data", "Cache", "Temporary Internet Files", "Content.IE5",
+        "My Documents", "Downloads", "Desktop", "drivers", "en-US", "WinSxS", "Fonts", "inf", "Logs", "Prefetch",
+        "installer", "installs", "DIR1", "DIR2", "Google", "Mozilla", "Adobe", "Common Files", "ProgramData", "Recent",
+        "Cookies", "Assembly", "Packages" };
+    const unsigned int DIRECTORY_NAME_WEIGHTS[] = { 2, 2, 3, 2, 1, 4, 4, 4, 6, 8, 2, 6, 2, 3,
+        3, 3, 3, 2, 3, 10, 2, 3, 4, 1,
+        1, 1, 1, 1, 3, 3, 3, 3, 2, 2,
+        3, 4, 6 };
+
+    // File name stems, and how often they occur relative to each other.
+    const char *FILE_NAME_STEMS[] = { "setup", "readme", "install", "data", "index", "IMG_", "document", "report", "invoice",
+        "update", "config", "thumb", "cache", "file", "password", "user", "msvcr", "kernel", "api-ms-win-core", "~WRL",
+        "settings", "license", "changelog", "backup" };
+    const unsigned int FILE_NAME_STEM_WEIGHTS[] = { 4, 3, 3, 10, 6, 8, 5, 3, 2,
+        5, 6, 6, 10, 4, 1, 4, 3, 3, 8, 4,
+        4, 3, 2, 2 };
+
+    // File extensions, and how often they occur relative to each other.
+    const char *FILE_EXTENSIONS[] = { ".dll", ".exe", ".txt", ".jpg", ".png", ".htm", ".html", ".xml", ".log", ".dat", ".doc",
+        ".docx", ".pdf", ".zip", ".bak", ".lnk", ".ini", ".tmp", ".sys", ".mui", ".cab", ".js", ".css", ".gif", "" };
+    const unsigned int FILE_EXTENSION_WEIGHTS[] = { 18, 6, 8, 10, 6, 4, 3, 6, 5, 6, 2,
+        2, 2, 1, 1, 3, 3, 4, 2, 6, 1, 5, 3, 4, 5 };
+
+    // File times are spread over 2005 to 2012.
+    const int64_t FIRST_FILE_TIME = 1104537600;
+    const int64_t FILE_TIME_RANGE = 8 * 365 * 24 * 3600;
+
+    // The largest file size generated, 4 GB.
+    const double MAX_FILE_SIZE_LOG = std::log(4294967296.0);
+
+    // The root directory always has this many child directories to begin with.
+    const unsigned int ROOT_DIRECTORY_CHILD_COUNT = 8;
+
+    // The most child directories a top level directory has, and the most any
+    // other directory has. Below the top level directories have one child 
+    // directory on average, so most directories are a few levels deep but 
+    // some branches reach the maximum depth.
+    const unsigned int MAX_TOP_LEVEL_CHILD_DIRECTORY_COUNT = 6;
+    const unsigned int MAX_CHILD_DIRECTORY_COUNT = 2;
+
+    template <size_t N, typename T> size_t countOf(T (&)[N])
+    {
+        return N;
+    }
+
+    /** A directory whose contents are being generated. */
+    struct DirectoryFrame
+    {
+        uint64_t fileId;
+        std::string path;
+        unsigned int depth;
+        uint64_t remainingFileCount;
+        unsigned int remainingChildCount;
+    };
+
+    void throwSqliteError(sqlite3 *database, const std::string &action)
+    {
+        std::ostringstream msg;
+        msg << "SyntheticImageGenerator::generate : failed to " << action << ": " << sqlite3_errmsg(database);
+        throw TskException(msg.str());
+    }
+}
+
+const uint64_t SyntheticImageGenerator::MAX_FILE_COUNT = 50000000;
+
+SyntheticImageGenerator::Options::Options() : fileCount(1000000), filesPerDirectory(15), maxDepth(12), seed(1)
+{
+}
+
+SyntheticImageGenerator::SyntheticImageGenerator(const Options &options) :
+    m_options(options), m_randomState(options.seed != 0 ? options.seed : 1), m_directoryCount(0)
+{
+    if (m_options.fileCount > MAX_FILE_COUNT)
+    {
+        std::ostringstream msg;
+        msg << "SyntheticImageGenerator::SyntheticImageGenerator : file count " << m_options.fileCount << " exceeds the maximum of " << MAX_FILE_COUNT;
+        throw TskException(msg.str());
+    }
+
+    if (m_options.filesPerDirectory == 0)
+    {
+        m_options.filesPerDirectory = 1;
+    }
+
+    // Files are only generated below the root directory.
+    if (m_options.maxDepth == 0)
+    {
+        m_options.maxDepth = 1;
+    }
+}
+
+uint64_t SyntheticImageGenerator::nextRandom()
+{
+    // xorshift64*, so that generated file systems are the same on every platform.
+    m_randomState ^= m_randomState >> 12;
+    m_randomState ^= m_randomState << 25;
+    m_randomState ^= m_randomState >> 27;
+    return m_randomState * 2685821657736338717ULL;
+}
+
+double SyntheticImageGenerator::nextUniform()
+{
+    return (nextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+size_t SyntheticImageGenerator::pickWeighted(const unsigned int *weights, size_t count)
+{
+    unsigned int totalWeight = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        totalWeight += weights[i];
+    }
+
+    unsigned int pick = static_cast<unsigned int>(nextRandom() % totalWeight);
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (pick < weights[i])
+        {
+            return i;
+        }
+        pick -= weights[i];
+    }
+    return count - 1;
+}
+
+std::string SyntheticImageGenerator::makeDirectoryName()
+{
+    std::ostringstream name;
+    name << DIRECTORY_NAMES[pickWeighted(DIRECTORY_NAME_WEIGHTS, countOf(DIRECTORY_NAME_WEIGHTS))];
+
+    // Many real folder names are made unique with numbers (e.g. WinSxS components, browser caches).
+    if (nextRandom() % 10 < 3)
+    {
+        name << "_" << std::hex << (nextRandom() & 0xffffff);
+    }
+    return name.str();
+}
+
+std::string SyntheticImageGenerator::makeFileName()
+{
+    std::ostringstream name;
+    name << FILE_NAME_STEMS[pickWeighted(FILE_NAME_STEM_WEIGHTS, countOf(FILE_NAME_STEM_WEIGHTS))];
+    if (nextRandom() % 2 == 0)
+    {
+        name << (nextRandom() % 100000);
+    }
+    name << FILE_EXTENSIONS[pickWeighted(FILE_EXTENSION_WEIGHTS, countOf(FILE_EXTENSION_WEIGHTS))];
+    return name.str();
+}
+
+int64_t SyntheticImageGenerator::makeFileSize()
+{
+    // File sizes are roughly log-uniform, so small files are common and large files are rare.
+    return static_cast<int64_t>(std::exp(nextUniform() * MAX_FILE_SIZE_LOG));
+}
+
+void SyntheticImageGenerator::generate(const std::string &imageDatabasePath)
+{
+    sqlite3 *database = NULL;
+    if (sqlite3_open(imageDatabasePath.c_str(), &database) != SQLITE_OK)
+    {
+        throwSqliteError(database, "open " + imageDatabasePath);
+    }
+
+    sqlite3_stmt *insertStatement = NULL;
+    try
+    {
+        if (sqlite3_exec(database, "PRAGMA synchronous = OFF; PRAGMA journal_mode = OFF; BEGIN TRANSACTION", NULL, NULL, NULL) != SQLITE_OK)
+        {
+            throwSqliteError(database, "begin transaction");
+        }
+
+        if (sqlite3_prepare_v2(database, "INSERT INTO files (file_id, type_id, name, par_file_id, dir_type, meta_type, dir_flags, meta_flags, "
+            "size, ctime, crtime, atime, mtime, mode, uid, gid, status, full_path) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, 0, 0, 0, ?, ?)",
+            -1, &insertStatement, NULL) != SQLITE_OK)
+        {
+            throwSqliteError(database, "prepare insert statement");
+        }
+
+        const uint64_t targetDirectoryCount = m_options.fileCount / m_options.filesPerDirectory + 1;
+        uint64_t fileCount = 0;
+        uint64_t nextFileId = 1;
+        m_directoryCount = 0;
+
+        std::vector<DirectoryFrame> directories;
+        DirectoryFrame root;
+        root.fileId = nextFileId;
+        root.depth = 0;
+        root.remainingFileCount = 0;
+        root.remainingChildCount = ROOT_DIRECTORY_CHILD_COUNT;
+        directories.push_back(root);
+
+        // The files are generated depth first, as a file system walk would add them, so that the files of a
+        // directory have nearby file ids.
+        bool isRootAdded = false;
+        while (fileCount < m_options.fileCount)
+        {
+            if (directories.empty())
+            {
+                // The tree ran out of places to put files, so grow it from the root again.
+                root.remainingChildCount = ROOT_DIRECTORY_CHILD_COUNT;
+                directories.push_back(root);
+            }
+
+            DirectoryFrame &directory = directories.back();
+            std::string name;
+            uint64_t parentFileId = directory.fileId;
+            bool isDirectory = false;
+            if (!isRootAdded)
+            {
+                isRootAdded = true;
+                isDirectory = true;
+            }
+            else if (directory.remainingFileCount > 0)
+            {
+                name = makeFileName();
+                --directory.remainingFileCount;
+                ++fileCount;
+            }
+            else if (directory.remainingChildCount > 0 && directory.depth < m_options.maxDepth &&
+                (m_directoryCount < targetDirectoryCount || directory.depth == 0))
+            {
+                name = makeDirectoryName();
+                --directory.remainingChildCount;
+                isDirectory = true;
+            }
+            else
+            {
+                directories.pop_back();
+                continue;
+            }
+
+            const uint64_t fileId = nextFileId++;
+            const std::string path = isDirectory && fileId == root.fileId ? "/" : directory.path + "/" + name;
+            const int64_t fileTime = FIRST_FILE_TIME + static_cast<int64_t>(nextRandom() % FILE_TIME_RANGE);
+
+            sqlite3_reset(insertStatement);
+            sqlite3_bind_int64(insertStatement, 1, fileId);
+            sqlite3_bind_int(insertStatement, 2, TskImgDB::IMGDB_FILES_TYPE_FS);
+            sqlite3_bind_text(insertStatement, 3, name.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(insertStatement, 4, parentFileId);
+            sqlite3_bind_int(insertStatement, 5, isDirectory ? TSK_FS_NAME_TYPE_DIR : TSK_FS_NAME_TYPE_REG);
+            sqlite3_bind_int(insertStatement, 6, isDirectory ? TSK_FS_META_TYPE_DIR : TSK_FS_META_TYPE_REG);
+            sqlite3_bind_int(insertStatement, 7, TSK_FS_NAME_FLAG_ALLOC);
+            sqlite3_bind_int(insertStatement, 8, TSK_FS_META_FLAG_ALLOC);
+            sqlite3_bind_int64(insertStatement, 9, isDirectory ? 56 : makeFileSize());
+            sqlite3_bind_int64(insertStatement, 10, fileTime);
+            sqlite3_bind_int64(insertStatement, 11, fileTime);
+            sqlite3_bind_int64(insertStatement, 12, fileTime);
+            sqlite3_bind_int64(insertStatement, 13, fileTime);
+            sqlite3_bind_int(insertStatement, 14, TskImgDB::IMGDB_FILES_STATUS_ANALYSIS_COMPLETE);
+            sqlite3_bind_text(insertStatement, 15, path.c_str(), -1, SQLITE_TRANSIENT);
+            if (sqlite3_step(insertStatement) != SQLITE_DONE)
+            {
+                throwSqliteError(database, "insert file");
+            }
+
+            if (isDirectory)
+            {
+                ++m_directoryCount;
+                if (fileId == root.fileId)
+                {
+                    continue;
+                }
+
+                DirectoryFrame child;
+                child.fileId = fileId;
+                child.path = path;
+                child.depth = directory.depth + 1;
+                child.remainingFileCount = nextRandom() % (2 * m_options.filesPerDirectory + 1);
+                child.remainingChildCount = static_cast<unsigned int>(nextRandom() % 
+                    ((child.depth == 1 ? MAX_TOP_LEVEL_CHILD_DIRECTORY_COUNT : MAX_CHILD_DIRECTORY_COUNT) + 1));
+                directories.push_back(child);
+            }
+        }
+
+        sqlite3_finalize(insertStatement);
+        insertStatement = NULL;
+
+        if (sqlite3_exec(database, "COMMIT", NULL, NULL, NULL) != SQLITE_OK)
+        {
+            throwSqliteError(database, "commit transaction");
+        }
+    }
+    catch (...)
+    {
+        sqlite3_finalize(insertStatement);
+        sqlite3_close(database);
+        throw;
+    }
+
+    sqlite3_close(database);
+}
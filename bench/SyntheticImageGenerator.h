@@ -0,0 +1,76 @@
+/*
+ * The Sleuth Kit
+ *
+ * Contact: Brian Carrier [carrier <at> sleuthkit [dot] org]
+ * Copyright (c) 2010-2012 Basis Technology Corporation. All Rights
+ * reserved.
+ *
+ * This software is distributed under the Common Public License 1.0
+ */
+
+/** \file SyntheticImageGenerator.h
+ * Contains the interface of a generator of synthetic image databases used to
+ * benchmark the interesting files module.
+ */
+
+#ifndef _SYNTHETIC_IMAGE_GENERATOR_H
+#define _SYNTHETIC_IMAGE_GENERATOR_H
+
+// System includes
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * A synthetic image generator fills the files table of an SQLite image
+ * database with a file system that resembles a real one: a directory tree
+ * of a configurable depth with common folder names, and files whose names,
+ * extensions and sizes follow skewed distributions like those of Windows
+ * installations. A small fraction of the files have names that the sample
+ * configuration file looks for, so that benchmarks produce hits.
+ *
+ * The generator is deterministic: the same options and seed always produce
+ * the same file system.
+ */
+class SyntheticImageGenerator
+{
+public:
+    /** The largest number of files that may be generated. */
+    static const uint64_t MAX_FILE_COUNT;
+
+    struct Options
+    {
+        Options();
+        uint64_t fileCount;
+        uint64_t filesPerDirectory;
+        unsigned int maxDepth;
+        uint64_t seed;
+    };
+
+    explicit SyntheticImageGenerator(const Options &options);
+
+    /**
+     * Adds the generated files to an image database whose schema has
+     * already been created by the framework.
+     *
+     * @param imageDatabasePath The path of the SQLite image database.
+     * @throws TskException If the database cannot be written.
+     */
+    void generate(const std::string &imageDatabasePath);
+
+    uint64_t getDirectoryCount() const { return m_directoryCount; }
+
+private:
+    uint64_t nextRandom();
+    double nextUniform();
+    size_t pickWeighted(const unsigned int *weights, size_t count);
+    std::string makeDirectoryName();
+    std::string makeFileName();
+    int64_t makeFileSize();
+
+    Options m_options;
+    uint64_t m_randomState;
+    uint64_t m_directoryCount;
+};
+
+#endif